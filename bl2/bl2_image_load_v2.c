@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -15,6 +15,28 @@
 #include <platform_def.h>
 #include <stdint.h>
 
+/*******************************************************************************
+ * Return the id of the image loaded after the given node, or INVALID_IMAGE_ID
+ * if there is none or if it cannot be fetched until the platform setup has
+ * been done.
+ ******************************************************************************/
+static unsigned int next_image_to_load(const bl_load_info_node_t *node_info,
+				       int plat_setup_done)
+{
+	const bl_load_info_node_t *next;
+
+	for (next = node_info->next_load_info; next != NULL;
+	     next = next->next_load_info) {
+		if ((next->image_info->h.attr & IMAGE_ATTRIB_PLAT_SETUP) &&
+		    !plat_setup_done)
+			return INVALID_IMAGE_ID;
+
+		if (!(next->image_info->h.attr & IMAGE_ATTRIB_SKIP_LOADING))
+			return next->image_id;
+	}
+
+	return INVALID_IMAGE_ID;
+}
 
 /*******************************************************************************
  * This function loads SCP_BL2/BL3x images and returns the ep_info for
@@ -56,8 +78,10 @@ entry_point_info_t *bl2_load_images(void)
 
 		if (!(bl2_node_info->image_info->h.attr & IMAGE_ATTRIB_SKIP_LOADING)) {
 			INFO("BL2: Loading image id %d\n", bl2_node_info->image_id);
-			err = load_auth_image(bl2_node_info->image_id,
-				bl2_node_info->image_info);
+			err = load_auth_image_pipelined(bl2_node_info->image_id,
+				bl2_node_info->image_info,
+				next_image_to_load(bl2_node_info,
+						   plat_setup_done));
 			if (err) {
 				ERROR("BL2: Failed to load image (%i)\n", err);
 				plat_error_handler(err);
@@ -22,6 +22,9 @@
 void bl2_main(void)
 {
 	entry_point_info_t *next_bl_ep_info;
+#if TRUSTED_BOARD_BOOT && AUTH_IMAGE_CACHE
+	unsigned int auth_cache_hits, auth_cache_misses;
+#endif
 
 	NOTICE("BL2: %s\n", version_string);
 	NOTICE("BL2: %s\n", build_message);
@@ -37,6 +40,12 @@ void bl2_main(void)
 	/* Load the subsequent bootloader images. */
 	next_bl_ep_info = bl2_load_images();
 
+#if TRUSTED_BOARD_BOOT && AUTH_IMAGE_CACHE
+	auth_mod_get_cache_stats(&auth_cache_hits, &auth_cache_misses);
+	INFO("BL2: %u certificate authentications avoided, %u performed\n",
+	     auth_cache_hits, auth_cache_misses);
+#endif
+
 #ifdef AARCH32
 	/*
 	 * For AArch32 state BL1 and BL2 share the MMU setup.
@@ -17,10 +17,26 @@ BL31_SOURCES		+=	bl31/bl31_main.c				\
 				services/std_svc/std_svc_setup.c		\
 				${PSCI_LIB_SOURCES}
 
+ifeq (${ENABLE_CONSOLE_BUFFER}, 1)
+BL31_SOURCES		+=	drivers/console/console_buffer.c
+endif
+
 ifeq (${ENABLE_PMF}, 1)
 BL31_SOURCES		+=	lib/pmf/pmf_main.c
 endif
 
+ifeq (${CTX_LAZY_FPREGS}, 1)
+BL31_SOURCES		+=	lib/el3_runtime/aarch64/lazy_fpregs.c
+endif
+
+ifeq (${ENABLE_RUNTIME_TRACE}, 1)
+BL31_SOURCES		+=	lib/runtime_trace/runtime_trace.c
+endif
+
+ifeq (${ENABLE_SMC_LATENCY_HIST}, 1)
+BL31_SOURCES		+=	bl31/smc_latency.c
+endif
+
 BL31_LINKERFILE		:=	bl31/bl31.ld.S
 
 # Flag used to indicate if Crash reporting via console should be included
@@ -16,6 +16,7 @@
 #include <pmf.h>
 #include <runtime_instr.h>
 #include <runtime_svc.h>
+#include <runtime_trace.h>
 #include <string.h>
 
 #if ENABLE_RUNTIME_INSTRUMENTATION
@@ -79,6 +80,11 @@ void bl31_main(void)
 	/* Initialise helper libraries */
 	bl31_lib_init();
 
+#if ENABLE_RUNTIME_TRACE
+	/* Initialise the runtime trace buffer */
+	runtime_trace_init();
+#endif
+
 	/* Initialize the runtime services e.g. psci. */
 	INFO("BL31: Initializing runtime services\n");
 	runtime_svc_init();
@@ -113,6 +119,11 @@ void bl31_main(void)
 	 * from BL31
 	 */
 	bl31_plat_runtime_setup();
+
+#if ENABLE_CONSOLE_BUFFER
+	/* Buffer the runtime console output from now on */
+	console_buffer_start();
+#endif
 }
 
 /*******************************************************************************
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <pmf.h>
+#include <runtime_svc.h>
+#include <smc_latency.h>
+#include <utils_def.h>
+
+/*******************************************************************************
+ * Per cpu histograms of the time spent in EL3 handling SMCs, one for each
+ * runtime service descriptor. The time is measured with the system counter
+ * from the dispatch of the SMC to the return of its handler. SMCs which do not
+ * return to the caller, such as CPU_OFF, are not recorded.
+ *
+ * A cpu only ever updates its own histograms, which are cache line aligned, so
+ * the updates need neither locks nor cache maintenance. Other cpus read them
+ * through the PMF_SMC_GET_TIMESTAMP SMCs, using the PMF_SMC_LAT_SVC_ID service
+ * id and the timestamp id layout described in smc_latency.h. The
+ * PMF_CACHE_MAINT flag of these SMCs is ignored: the histograms are only
+ * accessed with the caches enabled, and invalidating a line could discard
+ * counts not yet written back.
+ ******************************************************************************/
+typedef struct smc_lat_hist {
+	uint32_t count[SMC_LAT_MAX_SVCS][SMC_LAT_NUM_BUCKETS];
+} __aligned(CACHE_WRITEBACK_GRANULE) smc_lat_hist_t;
+
+static smc_lat_hist_t smc_lat_hist[PLATFORM_CORE_COUNT];
+
+/* Return the histogram bucket of a latency of `ticks` */
+static unsigned int smc_lat_bucket(unsigned long long ticks)
+{
+	unsigned int bucket;
+
+	if (ticks < 2)
+		return 0;
+
+	bucket = 63 - __builtin_clzll(ticks);
+
+	return MIN(bucket, SMC_LAT_NUM_BUCKETS - 1U);
+}
+
+/* Return the index of the runtime service descriptor owning a unique oen */
+static unsigned int smc_lat_svc_index(unsigned int unique_oen)
+{
+	assert(unique_oen < MAX_RT_SVCS);
+
+	return rt_svc_descs_indices[unique_oen];
+}
+
+/*******************************************************************************
+ * Called from the SMC handler on the runtime stack once the handler of an SMC
+ * with function id `smc_fid` has returned. `start` is the value of the system
+ * counter when the SMC was dispatched.
+ ******************************************************************************/
+void smc_latency_record(uint32_t smc_fid, unsigned long long start)
+{
+	unsigned long long ticks = read_cntpct_el0() - start;
+	unsigned int idx;
+
+	idx = smc_lat_svc_index(get_unique_oen_from_smc_fid(smc_fid));
+	if (idx >= SMC_LAT_MAX_SVCS)
+		return;
+
+	smc_lat_hist[plat_my_core_pos()].count[idx][smc_lat_bucket(ticks)]++;
+}
+
+/*******************************************************************************
+ * PMF handler returning the number of SMCs of the unique oen and bucket
+ * encoded in `tid` which have been handled by the cpu `mpidr`.
+ ******************************************************************************/
+static unsigned long long smc_latency_get(unsigned int tid, u_register_t mpidr,
+					  unsigned int flags)
+{
+	unsigned int bucket, unique_oen, idx;
+	int cpu_idx;
+
+	/* The timestamp id and the mpidr are given by the caller of the SMC */
+	cpu_idx = plat_core_pos_by_mpidr(mpidr);
+	if (cpu_idx < 0)
+		return 0;
+
+	unique_oen = tid & PMF_TID_MASK;
+	bucket = (tid & SMC_LAT_TID_BUCKET_MASK) >> SMC_LAT_TID_BUCKET_SHIFT;
+	if ((unique_oen >= MAX_RT_SVCS) || (bucket >= SMC_LAT_NUM_BUCKETS))
+		return 0;
+
+	idx = smc_lat_svc_index(unique_oen);
+	if (idx >= SMC_LAT_MAX_SVCS)
+		return 0;
+
+	return smc_lat_hist[cpu_idx].count[idx][bucket];
+}
+
+PMF_REGISTER_SERVICE_SMC_OWN(smc_lat_svc, PMF_ARM_TIF_IMPL_ID,
+	PMF_SMC_LAT_SVC_ID, MAX_RT_SVCS, NULL, smc_latency_get)
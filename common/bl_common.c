@@ -154,6 +154,53 @@ static void dump_load_info(uintptr_t image_load_addr,
 }
 #endif /* LOAD_IMAGE_V2 */
 
+#if TRUSTED_BOARD_BOOT && STREAM_IMAGE_HASH
+/*
+ * Size of the chunks in which an image is read when its hash is calculated
+ * while it is loaded. Each chunk is hashed right after it has been read, while
+ * it is still in the data cache.
+ */
+#define IMAGE_HASH_CHUNK_SIZE	U(0x4000)
+#endif
+
+/*******************************************************************************
+ * Read an image into memory. If the authentication module is calculating the
+ * hash of this image while it is loaded, read it in chunks and pass each
+ * chunk to the authentication module. With a platform hash engine, a chunk is
+ * hashed while the next one is read.
+ ******************************************************************************/
+static int read_image(unsigned int image_id, uintptr_t image_handle,
+		      uintptr_t image_base, size_t image_size,
+		      size_t *bytes_read)
+{
+#if TRUSTED_BOARD_BOOT && STREAM_IMAGE_HASH
+	size_t chunk_size, chunk_read;
+	int io_result;
+
+	if (auth_mod_hash_stream_active(image_id) != 0) {
+		*bytes_read = 0;
+		while (*bytes_read < image_size) {
+			chunk_size = MIN(image_size - *bytes_read,
+					 (size_t)IMAGE_HASH_CHUNK_SIZE);
+			io_result = io_read(image_handle,
+					    image_base + *bytes_read,
+					    chunk_size, &chunk_read);
+			if ((io_result != 0) || (chunk_read == 0)) {
+				return io_result;
+			}
+
+			auth_mod_hash_stream_update(
+				(void *)(image_base + *bytes_read), chunk_read);
+			*bytes_read += chunk_read;
+		}
+
+		return 0;
+	}
+#endif /* TRUSTED_BOARD_BOOT && STREAM_IMAGE_HASH */
+
+	return io_read(image_handle, image_base, image_size, bytes_read);
+}
+
 /* Generic function to return the size of an image */
 size_t image_size(unsigned int image_id)
 {
@@ -260,7 +307,8 @@ int load_image(unsigned int image_id, image_info_t *image_data)
 
 	/* We have enough space so load the image now */
 	/* TODO: Consider whether to try to recover/retry a partially successful read */
-	io_result = io_read(image_handle, image_base, image_size, &bytes_read);
+	io_result = read_image(image_id, image_handle, image_base, image_size,
+			       &bytes_read);
 	if ((io_result != 0) || (bytes_read < image_size)) {
 		WARN("Failed to load image id=%u (%i)\n", image_id, io_result);
 		goto exit;
@@ -291,11 +339,48 @@ exit:
 	return io_result;
 }
 
+#if ENABLE_IMAGE_LOAD_TIMING
+/*******************************************************************************
+ * System counter values taken while an image is loaded and authenticated, and
+ * the function which prints the time taken by each step in microseconds.
+ ******************************************************************************/
+typedef struct image_timing {
+	unsigned long long start;
+	unsigned long long loaded;
+	unsigned long long prefetched;
+	unsigned long long authenticated;
+} image_timing_t;
+
+#define IMAGE_TIMESTAMP(_timing, _step)	((_timing)._step = read_cntpct_el0())
+
+static unsigned long long ticks_to_us(unsigned long long ticks)
+{
+	unsigned int freq = read_cntfrq_el0();
+
+	return (freq != 0U) ? ((ticks * 1000000ULL) / freq) : 0ULL;
+}
+
+static void print_image_timing(unsigned int image_id,
+			       const image_timing_t *timing)
+{
+	NOTICE("Image id=%u: load %lluus, prefetch %lluus, auth %lluus\n",
+	       image_id, ticks_to_us(timing->loaded - timing->start),
+	       ticks_to_us(timing->prefetched - timing->loaded),
+	       ticks_to_us(timing->authenticated - timing->prefetched));
+}
+#else
+#define IMAGE_TIMESTAMP(_timing, _step)
+#endif /* ENABLE_IMAGE_LOAD_TIMING */
+
 static int load_auth_image_internal(unsigned int image_id,
 				    image_info_t *image_data,
-				    int is_parent_image)
+				    int is_parent_image,
+				    unsigned int next_image_id)
 {
 	int rc;
+#if ENABLE_IMAGE_LOAD_TIMING
+	image_timing_t timing;
+#endif
 
 #if TRUSTED_BOARD_BOOT
 	unsigned int parent_id;
@@ -303,18 +388,36 @@ static int load_auth_image_internal(unsigned int image_id,
 	/* Use recursion to authenticate parent images */
 	rc = auth_mod_get_parent_id(image_id, &parent_id);
 	if (rc == 0) {
-		rc = load_auth_image_internal(parent_id, image_data, 1);
+		rc = load_auth_image_internal(parent_id, image_data, 1,
+					      INVALID_IMAGE_ID);
 		if (rc != 0) {
 			return rc;
 		}
 	}
 #endif /* TRUSTED_BOARD_BOOT */
 
+	IMAGE_TIMESTAMP(timing, start);
+
+#if TRUSTED_BOARD_BOOT && STREAM_IMAGE_HASH
+	/* Hash the image while it is loaded, if its authentication allows */
+	(void)auth_mod_hash_stream_start(image_id);
+#endif
+
 	/* Load the image */
 	rc = load_image(image_id, image_data);
 	if (rc != 0) {
 		return rc;
 	}
+	IMAGE_TIMESTAMP(timing, loaded);
+
+	/*
+	 * The image is in memory. Let the platform start fetching the next
+	 * image while this one is authenticated.
+	 */
+	if (next_image_id != INVALID_IMAGE_ID) {
+		plat_prefetch_image(next_image_id);
+	}
+	IMAGE_TIMESTAMP(timing, prefetched);
 
 #if TRUSTED_BOARD_BOOT
 	/* Authenticate it */
@@ -342,6 +445,11 @@ static int load_auth_image_internal(unsigned int image_id,
 	}
 #endif /* TRUSTED_BOARD_BOOT */
 
+	IMAGE_TIMESTAMP(timing, authenticated);
+#if ENABLE_IMAGE_LOAD_TIMING
+	print_image_timing(image_id, &timing);
+#endif
+
 	return 0;
 }
 
@@ -354,7 +462,21 @@ static int load_auth_image_internal(unsigned int image_id,
  ******************************************************************************/
 int load_auth_image(unsigned int image_id, image_info_t *image_data)
 {
-	return load_auth_image_internal(image_id, image_data, 0);
+	return load_auth_image_internal(image_id, image_data, 0,
+					INVALID_IMAGE_ID);
+}
+
+/*******************************************************************************
+ * Same as 'load_auth_image()', but once the image has been read and before it
+ * is authenticated, call 'plat_prefetch_image()' for the image to be loaded
+ * next. A platform whose storage can transfer data in the background can use
+ * this to fetch the next image while the current one is being verified.
+ ******************************************************************************/
+int load_auth_image_pipelined(unsigned int image_id, image_info_t *image_data,
+			      unsigned int next_image_id)
+{
+	return load_auth_image_internal(image_id, image_data, 0,
+					next_image_id);
 }
 
 #else /* LOAD_IMAGE_V2 */
@@ -432,7 +554,8 @@ int load_image(meminfo_t *mem_layout,
 
 	/* We have enough space so load the image now */
 	/* TODO: Consider whether to try to recover/retry a partially successful read */
-	io_result = io_read(image_handle, image_base, image_size, &bytes_read);
+	io_result = read_image(image_id, image_handle, image_base, image_size,
+			       &bytes_read);
 	if ((io_result != 0) || (bytes_read < image_size)) {
 		WARN("Failed to load image id=%u (%i)\n", image_id, io_result);
 		goto exit;
@@ -505,6 +628,11 @@ static int load_auth_image_internal(meminfo_t *mem_layout,
 	}
 #endif /* TRUSTED_BOARD_BOOT */
 
+#if TRUSTED_BOARD_BOOT && STREAM_IMAGE_HASH
+	/* Hash the image while it is loaded, if its authentication allows */
+	(void)auth_mod_hash_stream_start(image_id);
+#endif
+
 	/* Load the image */
 	rc = load_image(mem_layout, image_id, image_base, image_data,
 			entry_point_info);
@@ -27,6 +27,25 @@ static rt_svc_desc_t *rt_svc_descs;
 #define RT_SVC_DECS_NUM		((RT_SVC_DESCS_END - RT_SVC_DESCS_START)\
 					/ sizeof(rt_svc_desc_t))
 
+#if RT_SVC_FAST_DISPATCH
+/*******************************************************************************
+ * The 'rt_svc_fid_table' array is a direct mapped table of leaf handlers for
+ * individual SMC function ids, exported by services by placing
+ * 'rt_svc_fid_desc_t' descriptors in the 'rt_svc_fid_descs' linker section.
+ * When an SMC arrives, RT_SVC_FID_HASH() of the function id gives the entry
+ * to check. If the function id recorded in the entry matches, its handler is
+ * invoked directly. Otherwise the SMC goes through the 'rt_svc_descs_indices'
+ * array as usual.
+ ******************************************************************************/
+#define RT_SVC_FID_DESCS_START	((uintptr_t) (&__RT_SVC_FID_DESCS_START__))
+#define RT_SVC_FID_DESCS_END	((uintptr_t) (&__RT_SVC_FID_DESCS_END__))
+rt_svc_fid_entry_t rt_svc_fid_table[RT_SVC_FID_TABLE_SIZE];
+
+#define RT_SVC_FID_DESCS_NUM	((RT_SVC_FID_DESCS_END - \
+					RT_SVC_FID_DESCS_START) \
+					/ sizeof(rt_svc_fid_desc_t))
+#endif
+
 /*******************************************************************************
  * Function to invoke the registered `handle` corresponding to the smc_fid.
  ******************************************************************************/
@@ -40,7 +59,21 @@ uintptr_t handle_runtime_svc(uint32_t smc_fid,
 	unsigned int idx;
 	const rt_svc_desc_t *rt_svc_descs;
 
+#if RT_SVC_FAST_DISPATCH
+	const rt_svc_fid_entry_t *entry;
+#endif
+
 	assert(handle);
+
+#if RT_SVC_FAST_DISPATCH
+	entry = &rt_svc_fid_table[RT_SVC_FID_HASH(smc_fid)];
+	if ((entry->smc_fid == smc_fid) && entry->handle) {
+		get_smc_params_from_ctx(handle, x1, x2, x3, x4);
+		return entry->handle(smc_fid, x1, x2, x3, x4, cookie,
+						handle, flags);
+	}
+#endif
+
 	idx = get_unique_oen_from_smc_fid(smc_fid);
 	assert(idx < MAX_RT_SVCS);
 
@@ -81,6 +114,55 @@ static int32_t validate_rt_svc_desc(const rt_svc_desc_t *desc)
 	return 0;
 }
 
+#if RT_SVC_FAST_DISPATCH
+/*******************************************************************************
+ * This function populates the direct function id table from the leaf handler
+ * descriptors. It must be called once 'rt_svc_descs_indices' has been filled
+ * in, so that leaf handlers belonging to a service which failed to initialise
+ * are not installed. A descriptor whose function id hashes to an entry that is
+ * already taken is not installed either; the corresponding SMCs are then
+ * handled through the top level handler of the service.
+ ******************************************************************************/
+static void rt_svc_fid_table_init(void)
+{
+	unsigned int index, idx;
+	const rt_svc_fid_desc_t *fid_descs;
+	rt_svc_fid_entry_t *entry;
+
+	assert(RT_SVC_FID_DESCS_END >= RT_SVC_FID_DESCS_START);
+
+	memset(rt_svc_fid_table, 0, sizeof(rt_svc_fid_table));
+
+	fid_descs = (rt_svc_fid_desc_t *) RT_SVC_FID_DESCS_START;
+	for (index = 0; index < RT_SVC_FID_DESCS_NUM; index++) {
+		const rt_svc_fid_desc_t *desc = &fid_descs[index];
+
+		if (desc->handle == NULL) {
+			ERROR("Invalid SMC function id descriptor %p\n",
+				(const void *) desc);
+			panic();
+		}
+
+		/* Skip function ids of services that are not available */
+		idx = get_unique_oen_from_smc_fid(desc->smc_fid);
+		assert(idx < MAX_RT_SVCS);
+		if (rt_svc_descs_indices[idx] >= RT_SVC_DECS_NUM)
+			continue;
+
+		entry = &rt_svc_fid_table[RT_SVC_FID_HASH(desc->smc_fid)];
+		if (entry->handle) {
+			VERBOSE("SMC 0x%x (%s) not added to fast dispatch\n",
+				desc->smc_fid, desc->name);
+			continue;
+		}
+
+		entry->smc_fid = desc->smc_fid;
+		entry->flags = desc->flags;
+		entry->handle = desc->handle;
+	}
+}
+#endif
+
 /*******************************************************************************
  * This function calls the initialisation routine in the descriptor exported by
  * a runtime service. Once a descriptor has been validated, its start & end
@@ -151,4 +233,8 @@ void runtime_svc_init(void)
 		for (; start_idx <= end_idx; start_idx++)
 			rt_svc_descs_indices[start_idx] = index;
 	}
+
+#if RT_SVC_FAST_DISPATCH
+	rt_svc_fid_table_init();
+#endif
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -32,6 +32,36 @@
 extern const auth_img_desc_t *const cot_desc_ptr;
 extern unsigned int auth_img_flags[];
 
+#if AUTH_IMAGE_CACHE
+/*
+ * Number of entries in the cache of verified images. Platforms may override it
+ * in platform_def.h.
+ */
+#ifndef AUTH_IMAGE_CACHE_ENTRIES
+#define AUTH_IMAGE_CACHE_ENTRIES	8
+#endif
+
+/* Digest of the contents of an image that has been fully authenticated */
+typedef struct auth_img_cache_entry {
+	unsigned int img_id;
+	unsigned int img_len;
+	unsigned char digest[CRYPTO_DIGEST_SIZE];
+} auth_img_cache_entry_t;
+
+static auth_img_cache_entry_t auth_img_cache[AUTH_IMAGE_CACHE_ENTRIES];
+static unsigned int auth_img_cache_used;
+static unsigned int auth_img_cache_hits;
+static unsigned int auth_img_cache_misses;
+#endif
+
+#if STREAM_IMAGE_HASH
+/* Hash of an image being calculated while the image is loaded */
+static unsigned int hash_stream_img_id;
+static unsigned int hash_stream_len;
+static int hash_stream_active;
+static int hash_stream_error;
+#endif
+
 static int cmp_auth_param_type_desc(const auth_param_type_desc_t *a,
 		const auth_param_type_desc_t *b)
 {
@@ -44,13 +74,29 @@ static int cmp_auth_param_type_desc(const auth_param_type_desc_t *a,
 /*
  * This function obtains the requested authentication parameter data from the
  * information extracted from the parent image after its authentication.
+ *
+ * The slot recorded in the parameter type descriptor is tried first. The
+ * 'authenticated_data' array is only searched if the parameter is not stored
+ * at that slot.
  */
 static int auth_get_param(const auth_param_type_desc_t *param_type_desc,
 			  const auth_img_desc_t *img_desc,
 			  void **param, unsigned int *len)
 {
+	const auth_param_desc_t *desc;
 	int i;
 
+	if (param_type_desc->slot < COT_MAX_VERIFIED_PARAMS) {
+		desc = &img_desc->authenticated_data[param_type_desc->slot];
+		if ((desc->type_desc != NULL) &&
+		    (0 == cmp_auth_param_type_desc(param_type_desc,
+						   desc->type_desc))) {
+			*param = desc->data.ptr;
+			*len = desc->data.len;
+			return 0;
+		}
+	}
+
 	for (i = 0 ; i < COT_MAX_VERIFIED_PARAMS ; i++) {
 		if (0 == cmp_auth_param_type_desc(param_type_desc,
 				img_desc->authenticated_data[i].type_desc)) {
@@ -114,6 +160,86 @@ static int auth_hash(const auth_method_param_hash_t *param,
 	return rc;
 }
 
+#if STREAM_IMAGE_HASH
+/*
+ * Finish the hash calculated while the image was loaded and match it
+ *
+ * This is the streamed form of 'AUTH_METHOD_HASH' for raw images, where the
+ * data to calculate the hash from is the whole image.
+ *
+ * Parameters:
+ *   img_len: length of image (in bytes)
+ *
+ * Return:
+ *   0 = success, Otherwise = error
+ */
+static int auth_hash_stream_finish(unsigned int img_len)
+{
+	int rc;
+
+	hash_stream_active = 0;
+
+	/* Always finish the hash so that the crypto library releases it */
+	rc = crypto_mod_verify_hash_finish();
+	if ((hash_stream_error != 0) || (hash_stream_len != img_len)) {
+		return 1;
+	}
+
+	return rc;
+}
+#endif /* STREAM_IMAGE_HASH */
+
+#if AUTH_IMAGE_CACHE
+/*
+ * Return whether an image with these contents has already been authenticated
+ */
+static int auth_img_cache_lookup(unsigned int img_id, unsigned int img_len,
+				 const unsigned char *digest)
+{
+	unsigned int i;
+
+	for (i = 0 ; i < auth_img_cache_used ; i++) {
+		if ((auth_img_cache[i].img_id == img_id) &&
+		    (auth_img_cache[i].img_len == img_len) &&
+		    (memcmp(auth_img_cache[i].digest, digest,
+			    CRYPTO_DIGEST_SIZE) == 0)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Record the contents of an authenticated image. An image id has at most one
+ * entry. Nothing is recorded once the cache is full.
+ */
+static void auth_img_cache_insert(unsigned int img_id, unsigned int img_len,
+				  const unsigned char *digest)
+{
+	auth_img_cache_entry_t *entry = NULL;
+	unsigned int i;
+
+	for (i = 0 ; i < auth_img_cache_used ; i++) {
+		if (auth_img_cache[i].img_id == img_id) {
+			entry = &auth_img_cache[i];
+			break;
+		}
+	}
+
+	if (entry == NULL) {
+		if (auth_img_cache_used == AUTH_IMAGE_CACHE_ENTRIES) {
+			return;
+		}
+		entry = &auth_img_cache[auth_img_cache_used++];
+	}
+
+	entry->img_id = img_id;
+	entry->img_len = img_len;
+	memcpy(entry->digest, digest, CRYPTO_DIGEST_SIZE);
+}
+#endif /* AUTH_IMAGE_CACHE */
+
 /*
  * Authenticate by digital signature
  *
@@ -349,6 +475,11 @@ int auth_mod_verify_img(unsigned int img_id,
 	void *param_ptr;
 	unsigned int param_len;
 	int rc, i;
+	int verified = 0;
+#if AUTH_IMAGE_CACHE
+	unsigned char digest[CRYPTO_DIGEST_SIZE];
+	int cacheable = 0;
+#endif
 
 	/* Get the image descriptor from the chain of trust */
 	img_desc = &cot_desc_ptr[img_id];
@@ -357,15 +488,42 @@ int auth_mod_verify_img(unsigned int img_id,
 	rc = img_parser_check_integrity(img_desc->img_type, img_ptr, img_len);
 	return_if_error(rc);
 
+#if AUTH_IMAGE_CACHE
+	/*
+	 * Certificates are loaded again for every image they are the parent
+	 * of. If these exact contents have already been authenticated, the
+	 * signature checks can be skipped. The parameters are still extracted
+	 * below, as their buffers may have been overwritten since. Raw images
+	 * are authenticated by hash, which costs as much as looking them up.
+	 */
+	if ((img_desc->img_type != IMG_RAW) &&
+	    (crypto_mod_calc_hash(img_ptr, img_len, digest) == 0)) {
+		cacheable = 1;
+		verified = auth_img_cache_lookup(img_id, img_len, digest);
+		if (verified != 0) {
+			auth_img_cache_hits++;
+			VERBOSE("Image id=%u already authenticated\n", img_id);
+		} else {
+			auth_img_cache_misses++;
+		}
+	}
+#endif
+
 	/* Authenticate the image using the methods indicated in the image
 	 * descriptor. */
-	for (i = 0 ; i < AUTH_METHOD_NUM ; i++) {
+	for (i = 0 ; (i < AUTH_METHOD_NUM) && (verified == 0) ; i++) {
 		auth_method = &img_desc->img_auth_methods[i];
 		switch (auth_method->type) {
 		case AUTH_METHOD_NONE:
 			rc = 0;
 			break;
 		case AUTH_METHOD_HASH:
+#if STREAM_IMAGE_HASH
+			if (auth_mod_hash_stream_active(img_id) != 0) {
+				rc = auth_hash_stream_finish(img_len);
+				break;
+			}
+#endif
 			rc = auth_hash(&auth_method->param.hash,
 					img_desc, img_ptr, img_len);
 			break;
@@ -411,5 +569,103 @@ int auth_mod_verify_img(unsigned int img_id,
 	/* Mark image as authenticated */
 	auth_img_flags[img_desc->img_id] |= IMG_FLAG_AUTHENTICATED;
 
+#if AUTH_IMAGE_CACHE
+	if ((cacheable != 0) && (verified == 0)) {
+		auth_img_cache_insert(img_id, img_len, digest);
+	}
+#endif
+
 	return 0;
 }
+
+#if AUTH_IMAGE_CACHE
+/*
+ * Return the number of image authentications avoided thanks to the cache of
+ * verified images, and the number of lookups that missed
+ */
+void auth_mod_get_cache_stats(unsigned int *hits, unsigned int *misses)
+{
+	assert((hits != NULL) && (misses != NULL));
+
+	*hits = auth_img_cache_hits;
+	*misses = auth_img_cache_misses;
+}
+#endif
+
+#if STREAM_IMAGE_HASH
+/*
+ * Start calculating the hash of an image while it is loaded. This is only
+ * possible for raw images authenticated by hash once their parent has been
+ * authenticated, and if the crypto library supports it.
+ *
+ * Return:
+ *   0 = the image data must be passed to auth_mod_hash_stream_update() as it
+ *       is loaded, Otherwise = the image will be hashed by
+ *       auth_mod_verify_img() as usual
+ */
+int auth_mod_hash_stream_start(unsigned int img_id)
+{
+	const auth_img_desc_t *img_desc = &cot_desc_ptr[img_id];
+	const auth_method_param_hash_t *param = NULL;
+	void *hash_der_ptr;
+	unsigned int hash_der_len;
+	int rc, i;
+
+	hash_stream_active = 0;
+
+	if ((img_desc->img_type != IMG_RAW) || (img_desc->parent == NULL)) {
+		return 1;
+	}
+
+	if ((auth_img_flags[img_desc->parent->img_id] &
+	     IMG_FLAG_AUTHENTICATED) == 0) {
+		return 1;
+	}
+
+	for (i = 0 ; i < AUTH_METHOD_NUM ; i++) {
+		if (img_desc->img_auth_methods[i].type == AUTH_METHOD_HASH) {
+			param = &img_desc->img_auth_methods[i].param.hash;
+			break;
+		}
+	}
+	if (param == NULL) {
+		return 1;
+	}
+
+	/* Get the hash from the parent image */
+	rc = auth_get_param(param->hash, img_desc->parent,
+			&hash_der_ptr, &hash_der_len);
+	return_if_error(rc);
+
+	rc = crypto_mod_verify_hash_start(hash_der_ptr, hash_der_len);
+	return_if_error(rc);
+
+	hash_stream_img_id = img_id;
+	hash_stream_len = 0;
+	hash_stream_error = 0;
+	hash_stream_active = 1;
+
+	return 0;
+}
+
+/*
+ * Return whether the hash of an image is being calculated while it is loaded
+ */
+int auth_mod_hash_stream_active(unsigned int img_id)
+{
+	return (hash_stream_active != 0) && (hash_stream_img_id == img_id);
+}
+
+/*
+ * Add a chunk of the image, in load order, to the hash being calculated
+ */
+void auth_mod_hash_stream_update(void *data_ptr, unsigned int data_len)
+{
+	assert(hash_stream_active != 0);
+
+	if (crypto_mod_verify_hash_update(data_ptr, data_len) != 0) {
+		hash_stream_error = 1;
+	}
+	hash_stream_len += data_len;
+}
+#endif /* STREAM_IMAGE_HASH */
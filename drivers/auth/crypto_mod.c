@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,10 +7,25 @@
 #include <assert.h>
 #include <crypto_mod.h>
 #include <debug.h>
+#include <platform.h>
 
 /* Variable exported by the crypto library through REGISTER_CRYPTO_LIB() */
 extern const crypto_lib_desc_t crypto_lib_desc;
 
+/* Hash engine provided by the platform, if any */
+static const crypto_hash_engine_desc_t *hash_engine;
+
+#pragma weak plat_get_crypto_hash_engine
+
+/*
+ * By default there is no hash engine, and hashes over several chunks of data
+ * are calculated by the crypto library
+ */
+const crypto_hash_engine_desc_t *plat_get_crypto_hash_engine(void)
+{
+	return NULL;
+}
+
 /*
  * The crypto module is responsible for verifying digital signatures and hashes.
  * It relies on a crypto library to perform the cryptographic operations.
@@ -52,6 +67,30 @@ void crypto_mod_init(void)
 	/* Initialize the cryptographic library */
 	crypto_lib_desc.init();
 	INFO("Using crypto library '%s'\n", crypto_lib_desc.name);
+
+	hash_engine = plat_get_crypto_hash_engine();
+	if (hash_engine != NULL) {
+		assert(hash_engine->name != NULL);
+		assert(hash_engine->start != NULL);
+		assert(hash_engine->submit != NULL);
+		assert(hash_engine->poll != NULL);
+		assert(hash_engine->finish != NULL);
+		INFO("Using hash engine '%s'\n", hash_engine->name);
+	}
+}
+
+/*
+ * Wait until the hash engine has consumed the data submitted last
+ */
+static int hash_engine_wait(void)
+{
+	int rc;
+
+	do {
+		rc = hash_engine->poll();
+	} while (rc == CRYPTO_ERR_BUSY);
+
+	return rc;
 }
 
 /*
@@ -103,3 +142,122 @@ int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 	return crypto_lib_desc.verify_hash(data_ptr, data_len,
 					   digest_info_ptr, digest_info_len);
 }
+
+/*
+ * Calculate the digest of some data. Fails with CRYPTO_ERR_UNKNOWN if the
+ * library doesn't support it.
+ *
+ * Parameters:
+ *
+ *   data_ptr, data_len: data to be hashed
+ *   output: buffer of CRYPTO_DIGEST_SIZE bytes for the digest
+ */
+int crypto_mod_calc_hash(void *data_ptr, unsigned int data_len,
+			 unsigned char *output)
+{
+	assert(data_ptr != NULL);
+	assert(data_len != 0);
+	assert(output != NULL);
+
+	if (crypto_lib_desc.calc_hash == NULL) {
+		return CRYPTO_ERR_UNKNOWN;
+	}
+
+	return crypto_lib_desc.calc_hash(data_ptr, data_len, output);
+}
+
+/*
+ * Start verifying a hash calculated over several chunks of data, using the
+ * platform hash engine if there is one. Otherwise, fails with
+ * CRYPTO_ERR_UNKNOWN if the library doesn't support it.
+ *
+ * Parameters:
+ *
+ *   digest_info_ptr, digest_info_len: hash to be compared
+ */
+int crypto_mod_verify_hash_start(void *digest_info_ptr,
+				 unsigned int digest_info_len)
+{
+	assert(digest_info_ptr != NULL);
+	assert(digest_info_len != 0);
+
+	if (hash_engine != NULL) {
+		return hash_engine->start(digest_info_ptr, digest_info_len);
+	}
+
+	if (crypto_lib_desc.verify_hash_start == NULL) {
+		return CRYPTO_ERR_UNKNOWN;
+	}
+
+	return crypto_lib_desc.verify_hash_start(digest_info_ptr,
+						 digest_info_len);
+}
+
+/*
+ * Add a chunk of data to the hash started by crypto_mod_verify_hash_start()
+ *
+ * When the platform provides a hash engine, this only waits for the previous
+ * chunk to be consumed and submits the new one, so the caller can go on (e.g.
+ * reading the next chunk) while the engine works. The data must then not be
+ * modified until crypto_mod_verify_hash_poll() reports that it has been
+ * consumed, or until the next update or the end of the hash.
+ *
+ * Parameters:
+ *
+ *   data_ptr, data_len: data to be hashed
+ */
+int crypto_mod_verify_hash_update(void *data_ptr, unsigned int data_len)
+{
+	int rc;
+
+	assert(data_ptr != NULL);
+	assert(data_len != 0);
+
+	if (hash_engine != NULL) {
+		rc = hash_engine_wait();
+		if (rc != CRYPTO_SUCCESS) {
+			return rc;
+		}
+		return hash_engine->submit(data_ptr, data_len);
+	}
+
+	assert(crypto_lib_desc.verify_hash_update != NULL);
+
+	return crypto_lib_desc.verify_hash_update(data_ptr, data_len);
+}
+
+/*
+ * Check whether the data passed to crypto_mod_verify_hash_update() has been
+ * consumed. Returns CRYPTO_ERR_BUSY while it is still in use.
+ */
+int crypto_mod_verify_hash_poll(void)
+{
+	if (hash_engine != NULL) {
+		return hash_engine->poll();
+	}
+
+	/* The crypto library consumes the data before returning */
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Finish the hash started by crypto_mod_verify_hash_start() and compare it
+ */
+int crypto_mod_verify_hash_finish(void)
+{
+	int rc;
+
+	if (hash_engine != NULL) {
+		/* Always finish the hash so that the engine releases it */
+		rc = hash_engine_wait();
+		if (rc != CRYPTO_SUCCESS) {
+			(void)hash_engine->finish();
+			return rc;
+		}
+		return hash_engine->finish();
+	}
+
+	assert(crypto_lib_desc.verify_hash_finish != NULL);
+
+	return crypto_lib_desc.verify_hash_finish();
+}
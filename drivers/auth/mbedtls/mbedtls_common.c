@@ -4,7 +4,13 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <assert.h>
 #include <debug.h>
+#include <mbedtls_common.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/cdefs.h>
 
 /* mbed TLS headers */
 #include <mbedtls/memory_buffer_alloc.h>
@@ -12,14 +18,193 @@
 #include <mbedtls_config.h>
 
 /*
- * mbed TLS heap
+ * mbed TLS heap. Platforms may define a different size in their makefiles.
+ *
+ * The public keys kept by the public key cache stay in the heap. For ECDSA, this
+ * includes the comb table of precomputed points kept in the group of each
+ * cached ECDSA context.
  */
+#if MBEDTLS_PK_CACHE
+#if (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_ECDSA)
+#define PK_CACHE_HEAP_SIZE		(MBEDTLS_PK_CACHE_ENTRIES * 3 * 1024)
+#elif (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_RSA)
+#define PK_CACHE_HEAP_SIZE		(MBEDTLS_PK_CACHE_ENTRIES * 1024)
+#endif
+#else
+#define PK_CACHE_HEAP_SIZE		0
+#endif
+
+#ifndef MBEDTLS_HEAP_SIZE
 #if (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_ECDSA)
-#define MBEDTLS_HEAP_SIZE		(14*1024)
+#define MBEDTLS_HEAP_SIZE		((14*1024) + PK_CACHE_HEAP_SIZE)
 #elif (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_RSA)
-#define MBEDTLS_HEAP_SIZE		(7*1024)
+#define MBEDTLS_HEAP_SIZE		((7*1024) + PK_CACHE_HEAP_SIZE)
 #endif
-static unsigned char heap[MBEDTLS_HEAP_SIZE];
+#endif
+static unsigned char heap[MBEDTLS_HEAP_SIZE] __aligned(8);
+
+#if MBEDTLS_HEAP_ARENA
+/*
+ * Arena allocator for mbed TLS
+ *
+ * mbed TLS allocates and frees many buffers of a few recurring sizes (mostly
+ * bignum limbs) while verifying a signature. Blocks are carved from the heap
+ * with the exact size requested, rounded up to 8 bytes, and start with a
+ * header that records that size. Freed blocks are kept in segregated free
+ * lists, one per power-of-two range of block sizes. A request is served with
+ * the first block large enough in the list of its range, then with the first
+ * block of the lists of the larger ranges, before the unused part of the heap
+ * is touched.
+ *
+ * Blocks are never split or merged. Splitting them without merging them back
+ * would leave the heap full of small blocks that cannot serve the larger
+ * requests. In exchange, a request may be served with a much larger block,
+ * and a heap full of small free blocks still cannot serve a large request, so
+ * the arena can need a larger heap than the mbed TLS buffer allocator.
+ */
+
+/* Free list 'n' holds blocks of 2^(ARENA_MIN_SHIFT + n) bytes or more */
+#define ARENA_MIN_SHIFT			4
+#define ARENA_NUM_LISTS			12
+
+#define ARENA_ALIGN			8
+
+/* Header of every block */
+typedef struct arena_block {
+	uint64_t size;			/* Size of the block, including header */
+} arena_block_t;
+
+/* Free blocks link to each other through their first data word */
+typedef struct arena_free_block {
+	arena_block_t hdr;
+	struct arena_free_block *next;
+} arena_free_block_t;
+
+static arena_free_block_t *arena_free_list[ARENA_NUM_LISTS];
+static size_t arena_top;
+static mbedtls_heap_stats_t arena_stats;
+
+/* Return the free list that holds blocks of 'block_size' bytes */
+static unsigned int arena_list(size_t block_size)
+{
+	unsigned int list = 0;
+
+	block_size >>= ARENA_MIN_SHIFT + 1;
+	while ((block_size != 0) && (list < ARENA_NUM_LISTS - 1)) {
+		block_size >>= 1;
+		list++;
+	}
+
+	return list;
+}
+
+/*
+ * Remove the first free block of at least 'block_size' bytes from the free
+ * lists. The blocks of the larger size ranges are all large enough.
+ */
+static arena_free_block_t *arena_take(size_t block_size)
+{
+	arena_free_block_t *block, **prev;
+	unsigned int list;
+
+	for (list = arena_list(block_size); list < ARENA_NUM_LISTS; list++) {
+		prev = &arena_free_list[list];
+		for (block = *prev; block != NULL; block = block->next) {
+			if (block->hdr.size >= block_size) {
+				*prev = block->next;
+				return block;
+			}
+			prev = &block->next;
+		}
+	}
+
+	return NULL;
+}
+
+static void *arena_calloc(size_t nmemb, size_t size)
+{
+	arena_free_block_t *block;
+	size_t block_size;
+
+	if ((nmemb == 0) || (size == 0) || (nmemb > SIZE_MAX / size)) {
+		return NULL;
+	}
+	size *= nmemb;
+	if (size > MBEDTLS_HEAP_SIZE) {
+		arena_stats.failed++;
+		return NULL;
+	}
+
+	block_size = (size + sizeof(arena_block_t) + ARENA_ALIGN - 1) &
+		     ~((size_t)ARENA_ALIGN - 1);
+	if (block_size < sizeof(arena_free_block_t)) {
+		block_size = sizeof(arena_free_block_t);
+	}
+
+	block = arena_take(block_size);
+	if (block == NULL) {
+		if (block_size > (MBEDTLS_HEAP_SIZE - arena_top)) {
+			arena_stats.failed++;
+			return NULL;
+		}
+		block = (arena_free_block_t *)&heap[arena_top];
+		block->hdr.size = block_size;
+		arena_top += block_size;
+		arena_stats.heap_top = arena_top;
+	}
+
+	arena_stats.allocs++;
+	arena_stats.in_use += block->hdr.size;
+	if (arena_stats.in_use > arena_stats.peak) {
+		arena_stats.peak = arena_stats.in_use;
+	}
+
+	return memset(&block->hdr + 1, 0, size);
+}
+
+static void arena_free(void *ptr)
+{
+	arena_free_block_t *block;
+	unsigned int list;
+
+	if (ptr == NULL) {
+		return;
+	}
+
+	block = (arena_free_block_t *)((arena_block_t *)ptr - 1);
+	assert(((uintptr_t)block >= (uintptr_t)heap) &&
+	       ((uintptr_t)block < (uintptr_t)heap + arena_top));
+
+	list = arena_list(block->hdr.size);
+	block->next = arena_free_list[list];
+	arena_free_list[list] = block;
+
+	arena_stats.frees++;
+	arena_stats.in_use -= block->hdr.size;
+}
+
+/*
+ * Get the usage statistics of the mbed TLS heap
+ */
+void mbedtls_heap_get_stats(mbedtls_heap_stats_t *stats)
+{
+	assert(stats != NULL);
+
+	*stats = arena_stats;
+}
+
+/*
+ * Reset the peak use and the allocation counters of the mbed TLS heap, so they
+ * only account for the operations performed from now on
+ */
+void mbedtls_heap_reset_stats(void)
+{
+	arena_stats.peak = arena_stats.in_use;
+	arena_stats.allocs = 0;
+	arena_stats.frees = 0;
+	arena_stats.failed = 0;
+}
+#endif /* MBEDTLS_HEAP_ARENA */
 
 /*
  * mbed TLS initialization function
@@ -29,8 +214,14 @@ void mbedtls_init(void)
 	static int ready;
 
 	if (!ready) {
+#if MBEDTLS_HEAP_ARENA
+		/* Use the arena allocator for the mbed TLS heap */
+		arena_stats.heap_size = MBEDTLS_HEAP_SIZE;
+		mbedtls_platform_set_calloc_free(arena_calloc, arena_free);
+#else
 		/* Initialize the mbed TLS heap */
 		mbedtls_memory_buffer_alloc_init(heap, MBEDTLS_HEAP_SIZE);
+#endif
 
 #ifdef MBEDTLS_PLATFORM_SNPRINTF_ALT
 		/* Use reduced version of snprintf to save space. */
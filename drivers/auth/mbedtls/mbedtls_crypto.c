@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -15,6 +15,9 @@
 #include <mbedtls/memory_buffer_alloc.h>
 #include <mbedtls/oid.h>
 #include <mbedtls/platform.h>
+#if MBEDTLS_PK_CACHE && (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_ECDSA)
+#include <mbedtls/ecdsa.h>
+#endif
 
 #define LIB_NAME		"mbed TLS"
 
@@ -44,6 +47,190 @@ static void init(void)
 	mbedtls_init();
 }
 
+#if MBEDTLS_HEAP_ARENA
+/*
+ * Report the use of the mbed TLS heap by the last operation. Most of the heap
+ * use comes from the public key operations, so this gives the requirements of
+ * each signature verification, i.e. of each certificate.
+ */
+static void report_heap_stats(void)
+{
+	mbedtls_heap_stats_t stats;
+
+	mbedtls_heap_get_stats(&stats);
+	VERBOSE("mbed TLS heap: peak %zu, %u allocs, %u failed, top %zu/%zu\n",
+		stats.peak, stats.allocs, stats.failed, stats.heap_top,
+		stats.heap_size);
+}
+#endif
+
+#if MBEDTLS_PK_CACHE
+/*
+ * Cache of parsed public keys
+ *
+ * The same public key is often used to verify several certificates, e.g. the
+ * trusted world key signs all the trusted key certificates. Keeping the parsed
+ * key saves parsing and validating it again.
+ *
+ * ECDSA keys are kept as ECDSA contexts, and their signatures are verified with
+ * mbedtls_ecdsa_read_signature(). The elliptic curve group of the context then
+ * keeps the comb table of precomputed multiples of the base point, which mbed
+ * TLS builds on the first verification. mbedtls_pk_verify_ext() would instead
+ * copy the key into a new ECDSA context, and so a new group, every time.
+ */
+#define PK_CACHE_DER_MAX_LEN		300
+
+/* Returned by pk_cache_verify() when the key can't be cached */
+#define PK_CACHE_MISS			1
+
+typedef struct pk_cache_entry {
+#if (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_ECDSA)
+	mbedtls_ecdsa_context ecdsa;
+#else
+	mbedtls_pk_context pk;
+#endif
+	unsigned char der[PK_CACHE_DER_MAX_LEN];
+	unsigned int der_len;
+	unsigned int last_use;
+	int valid;
+} pk_cache_entry_t;
+
+static pk_cache_entry_t pk_cache[MBEDTLS_PK_CACHE_ENTRIES];
+static unsigned int pk_cache_clock;
+
+static void pk_cache_free(pk_cache_entry_t *entry)
+{
+	if (entry->valid != 0) {
+#if (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_ECDSA)
+		mbedtls_ecdsa_free(&entry->ecdsa);
+#else
+		mbedtls_pk_free(&entry->pk);
+#endif
+		entry->valid = 0;
+	}
+}
+
+static void pk_cache_flush(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < MBEDTLS_PK_CACHE_ENTRIES; i++) {
+		pk_cache_free(&pk_cache[i]);
+	}
+}
+
+/*
+ * Parse the DER encoded SubjectPublicKeyInfo into a cache entry
+ */
+static int pk_cache_parse(pk_cache_entry_t *entry, void *pk_ptr,
+			  unsigned int pk_len)
+{
+	unsigned char *p, *end;
+	int rc;
+#if (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_ECDSA)
+	mbedtls_pk_context pk;
+
+	mbedtls_pk_init(&pk);
+	p = (unsigned char *)pk_ptr;
+	end = p + pk_len;
+	rc = mbedtls_pk_parse_subpubkey(&p, end, &pk);
+	if ((rc == 0) && (mbedtls_pk_can_do(&pk, MBEDTLS_PK_ECDSA) == 0)) {
+		rc = MBEDTLS_ERR_PK_TYPE_MISMATCH;
+	}
+	if (rc == 0) {
+		mbedtls_ecdsa_init(&entry->ecdsa);
+		rc = mbedtls_ecdsa_from_keypair(&entry->ecdsa,
+						mbedtls_pk_ec(pk));
+		if (rc != 0) {
+			mbedtls_ecdsa_free(&entry->ecdsa);
+		}
+	}
+	mbedtls_pk_free(&pk);
+#else
+	mbedtls_pk_init(&entry->pk);
+	p = (unsigned char *)pk_ptr;
+	end = p + pk_len;
+	rc = mbedtls_pk_parse_subpubkey(&p, end, &entry->pk);
+	if (rc != 0) {
+		mbedtls_pk_free(&entry->pk);
+	}
+#endif
+
+	return rc;
+}
+
+/*
+ * Return the cache entry of the given DER encoded SubjectPublicKeyInfo,
+ * parsing it into the least recently used entry if it is not in the cache.
+ * Returns NULL if the key can't be cached.
+ */
+static pk_cache_entry_t *pk_cache_get(void *pk_ptr, unsigned int pk_len)
+{
+	pk_cache_entry_t *entry = &pk_cache[0];
+	unsigned int i;
+
+	for (i = 0; i < MBEDTLS_PK_CACHE_ENTRIES; i++) {
+		if ((pk_cache[i].valid != 0) && (pk_cache[i].der_len == pk_len) &&
+		    (memcmp(pk_cache[i].der, pk_ptr, pk_len) == 0)) {
+			pk_cache[i].last_use = ++pk_cache_clock;
+			return &pk_cache[i];
+		}
+
+		if ((entry->valid != 0) && ((pk_cache[i].valid == 0) ||
+		    (pk_cache[i].last_use < entry->last_use))) {
+			entry = &pk_cache[i];
+		}
+	}
+
+	if (pk_len > PK_CACHE_DER_MAX_LEN) {
+		return NULL;
+	}
+
+	pk_cache_free(entry);
+	if (pk_cache_parse(entry, pk_ptr, pk_len) != 0) {
+		/* Release the heap in case it has run out because of the cache */
+		pk_cache_flush();
+		return NULL;
+	}
+
+	memcpy(entry->der, pk_ptr, pk_len);
+	entry->der_len = pk_len;
+	entry->last_use = ++pk_cache_clock;
+	entry->valid = 1;
+
+	return entry;
+}
+
+/*
+ * Verify a signature with a cached key. Returns 0 if the signature is valid,
+ * PK_CACHE_MISS if the key can't be cached, or another value if the signature
+ * is not valid.
+ */
+static int pk_cache_verify(void *pk_ptr, unsigned int pk_len,
+			   mbedtls_pk_type_t pk_alg, const void *sig_opts,
+			   mbedtls_md_type_t md_alg, const unsigned char *hash,
+			   size_t hash_len, const unsigned char *sig,
+			   size_t sig_len)
+{
+	pk_cache_entry_t *entry = pk_cache_get(pk_ptr, pk_len);
+
+	if (entry == NULL) {
+		return PK_CACHE_MISS;
+	}
+
+#if (TF_MBEDTLS_KEY_ALG_ID == TF_MBEDTLS_ECDSA)
+	if (pk_alg != MBEDTLS_PK_ECDSA) {
+		return MBEDTLS_ERR_PK_TYPE_MISMATCH;
+	}
+	return mbedtls_ecdsa_read_signature(&entry->ecdsa, hash, hash_len, sig,
+					    sig_len);
+#else
+	return mbedtls_pk_verify_ext(pk_alg, sig_opts, &entry->pk, md_alg,
+				     hash, hash_len, sig, sig_len);
+#endif
+}
+#endif /* MBEDTLS_PK_CACHE */
+
 /*
  * Verify a signature.
  *
@@ -66,6 +253,10 @@ static int verify_signature(void *data_ptr, unsigned int data_len,
 	unsigned char *p, *end;
 	unsigned char hash[MBEDTLS_MD_MAX_SIZE];
 
+#if MBEDTLS_HEAP_ARENA
+	mbedtls_heap_reset_stats();
+#endif
+
 	/* Get pointers to signature OID and parameters */
 	p = (unsigned char *)sig_alg;
 	end = (unsigned char *)(p + sig_alg_len);
@@ -80,16 +271,6 @@ static int verify_signature(void *data_ptr, unsigned int data_len,
 		return CRYPTO_ERR_SIGNATURE;
 	}
 
-	/* Parse the public key */
-	mbedtls_pk_init(&pk);
-	p = (unsigned char *)pk_ptr;
-	end = (unsigned char *)(p + pk_len);
-	rc = mbedtls_pk_parse_subpubkey(&p, end, &pk);
-	if (rc != 0) {
-		rc = CRYPTO_ERR_SIGNATURE;
-		goto end2;
-	}
-
 	/* Get the signature (bitstring) */
 	p = (unsigned char *)sig_ptr;
 	end = (unsigned char *)(p + sig_len);
@@ -97,7 +278,7 @@ static int verify_signature(void *data_ptr, unsigned int data_len,
 	rc = mbedtls_asn1_get_bitstring_null(&p, end, &signature.len);
 	if (rc != 0) {
 		rc = CRYPTO_ERR_SIGNATURE;
-		goto end1;
+		goto end2;
 	}
 	signature.p = p;
 
@@ -105,10 +286,31 @@ static int verify_signature(void *data_ptr, unsigned int data_len,
 	md_info = mbedtls_md_info_from_type(md_alg);
 	if (md_info == NULL) {
 		rc = CRYPTO_ERR_SIGNATURE;
-		goto end1;
+		goto end2;
 	}
 	p = (unsigned char *)data_ptr;
 	rc = mbedtls_md(md_info, p, data_len, hash);
+	if (rc != 0) {
+		rc = CRYPTO_ERR_SIGNATURE;
+		goto end2;
+	}
+
+#if MBEDTLS_PK_CACHE
+	/* Verify the signature with the cached key, if it can be cached */
+	rc = pk_cache_verify(pk_ptr, pk_len, pk_alg, sig_opts, md_alg, hash,
+			mbedtls_md_get_size(md_info),
+			signature.p, signature.len);
+	if (rc != PK_CACHE_MISS) {
+		rc = (rc == 0) ? CRYPTO_SUCCESS : CRYPTO_ERR_SIGNATURE;
+		goto end2;
+	}
+#endif
+
+	/* Parse the public key */
+	mbedtls_pk_init(&pk);
+	p = (unsigned char *)pk_ptr;
+	end = (unsigned char *)(p + pk_len);
+	rc = mbedtls_pk_parse_subpubkey(&p, end, &pk);
 	if (rc != 0) {
 		rc = CRYPTO_ERR_SIGNATURE;
 		goto end1;
@@ -130,23 +332,23 @@ end1:
 	mbedtls_pk_free(&pk);
 end2:
 	mbedtls_free(sig_opts);
+#if MBEDTLS_HEAP_ARENA
+	report_heap_stats();
+#endif
 	return rc;
 }
 
 /*
- * Match a hash
- *
- * Digest info is passed in DER format following the ASN.1 structure detailed
- * above.
+ * Parse a DigestInfo structure. Return the hash algorithm and a pointer to the
+ * expected hash, whose length is the algorithm's hash size.
  */
-static int verify_hash(void *data_ptr, unsigned int data_len,
-		       void *digest_info_ptr, unsigned int digest_info_len)
+static int get_digest_info(void *digest_info_ptr, unsigned int digest_info_len,
+			   const mbedtls_md_info_t **md_info,
+			   unsigned char **hash)
 {
 	mbedtls_asn1_buf hash_oid, params;
 	mbedtls_md_type_t md_alg;
-	const mbedtls_md_info_t *md_info;
-	unsigned char *p, *end, *hash;
-	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	unsigned char *p, *end;
 	size_t len;
 	int rc;
 
@@ -170,8 +372,8 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 		return CRYPTO_ERR_HASH;
 	}
 
-	md_info = mbedtls_md_info_from_type(md_alg);
-	if (md_info == NULL) {
+	*md_info = mbedtls_md_info_from_type(md_alg);
+	if (*md_info == NULL) {
 		return CRYPTO_ERR_HASH;
 	}
 
@@ -182,14 +384,36 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	}
 
 	/* Length of hash must match the algorithm's size */
-	if (len != mbedtls_md_get_size(md_info)) {
+	if (len != mbedtls_md_get_size(*md_info)) {
 		return CRYPTO_ERR_HASH;
 	}
-	hash = p;
+	*hash = p;
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Match a hash
+ *
+ * Digest info is passed in DER format following the ASN.1 structure detailed
+ * above.
+ */
+static int verify_hash(void *data_ptr, unsigned int data_len,
+		       void *digest_info_ptr, unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *hash;
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	int rc;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info, &hash);
+	if (rc != CRYPTO_SUCCESS) {
+		return rc;
+	}
 
 	/* Calculate the hash of the data */
-	p = (unsigned char *)data_ptr;
-	rc = mbedtls_md(md_info, p, data_len, data_hash);
+	rc = mbedtls_md(md_info, (unsigned char *)data_ptr, data_len,
+			data_hash);
 	if (rc != 0) {
 		return CRYPTO_ERR_HASH;
 	}
@@ -203,7 +427,115 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	return CRYPTO_SUCCESS;
 }
 
+/*
+ * Calculate the SHA-256 digest of some data
+ */
+static int calc_hash(void *data_ptr, unsigned int data_len,
+		     unsigned char *output)
+{
+	const mbedtls_md_info_t *md_info;
+
+	md_info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+	if ((md_info == NULL) ||
+	    (mbedtls_md_get_size(md_info) != CRYPTO_DIGEST_SIZE)) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	if (mbedtls_md(md_info, (unsigned char *)data_ptr, data_len,
+		       output) != 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+#if STREAM_IMAGE_HASH
+/* State of the hash being calculated over several chunks of data */
+static mbedtls_md_context_t stream_ctx;
+static unsigned char *stream_hash;
+static size_t stream_hash_len;
+static int stream_active;
+
+static void verify_hash_stop(void)
+{
+	if (stream_active != 0) {
+		mbedtls_md_free(&stream_ctx);
+		stream_active = 0;
+	}
+}
+
+/*
+ * Start calculating a hash over several chunks of data. Any hash already in
+ * progress is discarded.
+ */
+static int verify_hash_start(void *digest_info_ptr,
+			     unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	int rc;
+
+	verify_hash_stop();
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info,
+			     &stream_hash);
+	if (rc != CRYPTO_SUCCESS) {
+		return rc;
+	}
+
+	stream_hash_len = mbedtls_md_get_size(md_info);
+	mbedtls_md_init(&stream_ctx);
+	stream_active = 1;
+
+	if ((mbedtls_md_setup(&stream_ctx, md_info, 0) != 0) ||
+	    (mbedtls_md_starts(&stream_ctx) != 0)) {
+		verify_hash_stop();
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+static int verify_hash_update(void *data_ptr, unsigned int data_len)
+{
+	if (stream_active == 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	if (mbedtls_md_update(&stream_ctx, (unsigned char *)data_ptr,
+			      data_len) != 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+static int verify_hash_finish(void)
+{
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	int rc;
+
+	if (stream_active == 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	rc = mbedtls_md_finish(&stream_ctx, data_hash);
+	if (rc == 0) {
+		rc = memcmp(data_hash, stream_hash, stream_hash_len);
+	}
+	verify_hash_stop();
+
+	return (rc == 0) ? CRYPTO_SUCCESS : CRYPTO_ERR_HASH;
+}
+#endif /* STREAM_IMAGE_HASH */
+
 /*
  * Register crypto library descriptor
  */
-REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash);
+#if STREAM_IMAGE_HASH
+REGISTER_CRYPTO_LIB_HASH_STREAM(LIB_NAME, init, verify_signature, verify_hash,
+				calc_hash, verify_hash_start, verify_hash_update,
+				verify_hash_finish);
+#else
+REGISTER_CRYPTO_LIB_HASH_STREAM(LIB_NAME, init, verify_signature, verify_hash,
+				calc_hash, NULL, NULL, NULL);
+#endif
@@ -23,6 +23,7 @@ ifdef MBEDTLS_KEY_ALG
 endif
 
 MBEDTLS_CRYPTO_SOURCES		:=	drivers/auth/mbedtls/mbedtls_crypto.c	\
+					drivers/auth/mbedtls/mbedtls_hash_engine.c \
 					$(addprefix ${MBEDTLS_DIR}/library/,	\
 					bignum.c				\
 					md.c					\
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <crypto_mod.h>
+#include <mbedtls_hash_engine.h>
+#include <stddef.h>
+#include <string.h>
+
+/* mbed TLS headers */
+#include <mbedtls/asn1.h>
+#include <mbedtls/md.h>
+#include <mbedtls/oid.h>
+
+/*
+ * Software hash engine
+ *
+ * The engine behaves like an asynchronous one: submit() only records the data,
+ * which is hashed by the following calls to poll(), at most
+ * HASH_ENGINE_SLICE_SIZE bytes at a time. The data is therefore in use until
+ * poll() stops returning CRYPTO_ERR_BUSY, as it would be with a hardware
+ * engine. Only SHA-256 hashes are supported.
+ */
+#define HASH_ENGINE_NAME		"mbed TLS SHA-256"
+#define HASH_ENGINE_SLICE_SIZE		4096
+#define HASH_ENGINE_DIGEST_SIZE		32
+
+static mbedtls_md_context_t engine_ctx;
+static unsigned char engine_hash[HASH_ENGINE_DIGEST_SIZE];
+static unsigned char *engine_data;
+static unsigned int engine_data_len;
+static int engine_active;
+static int engine_error;
+
+static void engine_stop(void)
+{
+	if (engine_active != 0) {
+		mbedtls_md_free(&engine_ctx);
+		engine_active = 0;
+	}
+	engine_data_len = 0;
+}
+
+/*
+ * Start a hash to be compared with the SHA-256 digest of the DigestInfo:
+ *
+ *     DigestInfo ::= SEQUENCE {
+ *         digestAlgorithm AlgorithmIdentifier,
+ *         digest OCTET STRING
+ *     }
+ */
+static int engine_start(void *digest_info_ptr, unsigned int digest_info_len)
+{
+	mbedtls_asn1_buf hash_oid, params;
+	unsigned char *p, *end;
+	size_t len;
+
+	engine_stop();
+
+	p = (unsigned char *)digest_info_ptr;
+	end = p + digest_info_len;
+	if ((mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED |
+				  MBEDTLS_ASN1_SEQUENCE) != 0) ||
+	    (mbedtls_asn1_get_alg(&p, end, &hash_oid, &params) != 0) ||
+	    (MBEDTLS_OID_CMP(MBEDTLS_OID_DIGEST_ALG_SHA256, &hash_oid) != 0) ||
+	    (mbedtls_asn1_get_tag(&p, end, &len,
+				  MBEDTLS_ASN1_OCTET_STRING) != 0) ||
+	    (len != HASH_ENGINE_DIGEST_SIZE)) {
+		return CRYPTO_ERR_HASH;
+	}
+	memcpy(engine_hash, p, HASH_ENGINE_DIGEST_SIZE);
+
+	mbedtls_md_init(&engine_ctx);
+	engine_active = 1;
+	engine_error = 0;
+
+	if ((mbedtls_md_setup(&engine_ctx,
+			      mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+			      0) != 0) ||
+	    (mbedtls_md_starts(&engine_ctx) != 0)) {
+		engine_stop();
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+static int engine_submit(void *data_ptr, unsigned int data_len)
+{
+	if (engine_active == 0) {
+		return CRYPTO_ERR_HASH;
+	}
+	if (engine_data_len != 0) {
+		return CRYPTO_ERR_BUSY;
+	}
+
+	engine_data = (unsigned char *)data_ptr;
+	engine_data_len = data_len;
+	return CRYPTO_SUCCESS;
+}
+
+/* Hash the next slice of the data submitted last */
+static int engine_poll(void)
+{
+	unsigned int len;
+
+	if (engine_data_len != 0) {
+		len = engine_data_len;
+		if (len > HASH_ENGINE_SLICE_SIZE) {
+			len = HASH_ENGINE_SLICE_SIZE;
+		}
+
+		if (mbedtls_md_update(&engine_ctx, engine_data, len) != 0) {
+			engine_error = 1;
+			engine_data_len = 0;
+		} else {
+			engine_data += len;
+			engine_data_len -= len;
+		}
+	}
+
+	if (engine_error != 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return (engine_data_len != 0) ? CRYPTO_ERR_BUSY : CRYPTO_SUCCESS;
+}
+
+static int engine_finish(void)
+{
+	unsigned char data_hash[HASH_ENGINE_DIGEST_SIZE];
+	int rc;
+
+	if ((engine_active == 0) || (engine_data_len != 0) ||
+	    (engine_error != 0)) {
+		engine_stop();
+		return CRYPTO_ERR_HASH;
+	}
+
+	rc = mbedtls_md_finish(&engine_ctx, data_hash);
+	if (rc == 0) {
+		rc = memcmp(data_hash, engine_hash, HASH_ENGINE_DIGEST_SIZE);
+	}
+	engine_stop();
+
+	return (rc == 0) ? CRYPTO_SUCCESS : CRYPTO_ERR_HASH;
+}
+
+const crypto_hash_engine_desc_t mbedtls_hash_engine = {
+	.name = HASH_ENGINE_NAME,
+	.start = engine_start,
+	.submit = engine_submit,
+	.poll = engine_poll,
+	.finish = engine_finish
+};
@@ -6,6 +6,14 @@
 
 include drivers/auth/mbedtls/mbedtls_common.mk
 
+# The platform may define the variable 'MAX_V3_EXTENSIONS' to set the number of
+# X509v3 extensions indexed by the integrity check of a certificate. Default is
+# 10, which covers all the certificates of the TBBR CoT.
+ifeq (${MAX_V3_EXTENSIONS},)
+    MAX_V3_EXTENSIONS		:=	10
+endif
+$(eval $(call add_define,MAX_V3_EXTENSIONS))
+
 MBEDTLS_X509_SOURCES	:=	drivers/auth/mbedtls/mbedtls_x509_parser.c	\
 				$(addprefix ${MBEDTLS_DIR}/library/,		\
 				x509.c 						\
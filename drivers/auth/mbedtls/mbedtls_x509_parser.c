@@ -23,11 +23,21 @@
 
 /* mbed TLS headers */
 #include <mbedtls/asn1.h>
-#include <mbedtls/oid.h>
 #include <mbedtls/platform.h>
 
-/* Maximum OID string length ("a.b.c.d.e.f ...") */
-#define MAX_OID_STR_LEN			64
+/* Maximum length of a DER encoded OID (excluding tag and length) */
+#define MAX_OID_DER_LEN			32
+
+/*
+ * Maximum number of X509v3 extensions indexed by the integrity check. It is set
+ * by the MAX_V3_EXTENSIONS build option.
+ */
+#ifndef MAX_V3_EXTENSIONS
+#define MAX_V3_EXTENSIONS		10
+#endif
+
+/* Number of extension IDs whose DER encoding is kept by get_ext() */
+#define OID_CACHE_SIZE			16
 
 #define LIB_NAME	"mbed TLS X509v3"
 
@@ -41,6 +51,28 @@ static mbedtls_asn1_buf pk;
 static mbedtls_asn1_buf sig_alg;
 static mbedtls_asn1_buf signature;
 
+/* X509v3 extension found during the integrity check */
+typedef struct v3_ext_entry {
+	mbedtls_asn1_buf oid;		/* DER encoded extension ID */
+	mbedtls_asn1_buf data;		/* Contents of the extension octet string */
+} v3_ext_entry_t;
+
+/* Index of the extensions in the certificate, built by the integrity check.
+ * The extensions which do not fit in the table start at 'v3_ext_more' */
+static v3_ext_entry_t v3_ext_table[MAX_V3_EXTENSIONS];
+static unsigned int v3_ext_num;
+static unsigned char *v3_ext_more;
+
+/* Extension ID requested by the CoT and its DER encoding */
+typedef struct oid_cache_entry {
+	const char *oid;
+	unsigned char der[MAX_OID_DER_LEN];
+	size_t der_len;
+} oid_cache_entry_t;
+
+static oid_cache_entry_t oid_cache[OID_CACHE_SIZE];
+static unsigned int oid_cache_next;
+
 /*
  * Clear all static temporary variables.
  */
@@ -57,47 +89,171 @@ static void clear_temp_vars(void)
 	ZERO_AND_CLEAN(pk);
 	ZERO_AND_CLEAN(sig_alg);
 	ZERO_AND_CLEAN(signature);
+	ZERO_AND_CLEAN(v3_ext_table);
+	ZERO_AND_CLEAN(v3_ext_num);
+	ZERO_AND_CLEAN(v3_ext_more);
 
 #undef ZERO_AND_CLEAN
 }
 
+/*
+ * Encode an OID given as a numeric string ("a.b.c.d ...") in DER format
+ *
+ * The first two components are encoded as a single subidentifier (40 * a + b)
+ * and every subidentifier is stored in base 128, most significant group first,
+ * with bit 7 set in all bytes except the last one.
+ */
+static int oid_str_to_der(const char *oid, unsigned char *der, size_t *der_len)
+{
+	unsigned int arc[2], val, digit;
+	unsigned int num_arcs = 0;
+	unsigned char tmp[5];
+	size_t len = 0;
+	int i;
+
+	while (*oid != '\0') {
+		if ((*oid < '0') || (*oid > '9')) {
+			return IMG_PARSER_ERR;
+		}
+		val = 0;
+		while ((*oid >= '0') && (*oid <= '9')) {
+			digit = (unsigned int)(*oid - '0');
+			if (val > (UINT32_MAX - digit) / 10U) {
+				return IMG_PARSER_ERR;
+			}
+			val = (val * 10U) + digit;
+			oid++;
+		}
+		if (*oid == '.') {
+			oid++;
+			if (*oid == '\0') {
+				return IMG_PARSER_ERR;
+			}
+		} else if (*oid != '\0') {
+			return IMG_PARSER_ERR;
+		}
+
+		/* The first two arcs form a single subidentifier */
+		if (num_arcs < 2) {
+			arc[num_arcs++] = val;
+			if (num_arcs < 2) {
+				continue;
+			}
+			if ((arc[0] > 2) || ((arc[0] < 2) && (arc[1] > 39)) ||
+			    (arc[1] > UINT32_MAX - 80U)) {
+				return IMG_PARSER_ERR;
+			}
+			val = (arc[0] * 40U) + arc[1];
+		}
+
+		i = 0;
+		do {
+			tmp[i++] = (unsigned char)(val & 0x7f);
+			val >>= 7;
+		} while (val != 0);
+
+		if (len + i > MAX_OID_DER_LEN) {
+			return IMG_PARSER_ERR;
+		}
+		while (i > 1) {
+			der[len++] = tmp[--i] | 0x80;
+		}
+		der[len++] = tmp[0];
+	}
+
+	if (num_arcs < 2) {
+		return IMG_PARSER_ERR;
+	}
+
+	*der_len = len;
+	return IMG_PARSER_OK;
+}
+
+/*
+ * Get the DER encoding of an extension ID
+ *
+ * The extension IDs are constant strings in the CoT descriptors, so each one is
+ * identified by its address and only encoded the first time it is requested.
+ * The least recently encoded ID is replaced when the cache is full.
+ */
+static int get_oid_der(const char *oid, const unsigned char **der,
+		       size_t *der_len)
+{
+	oid_cache_entry_t *entry;
+	unsigned int i;
+	int rc;
+
+	for (i = 0; i < OID_CACHE_SIZE; i++) {
+		if (oid_cache[i].oid == oid) {
+			*der = oid_cache[i].der;
+			*der_len = oid_cache[i].der_len;
+			return IMG_PARSER_OK;
+		}
+	}
+
+	entry = &oid_cache[oid_cache_next];
+	entry->oid = NULL;
+	rc = oid_str_to_der(oid, entry->der, &entry->der_len);
+	if (rc != IMG_PARSER_OK) {
+		return rc;
+	}
+	entry->oid = oid;
+	oid_cache_next = (oid_cache_next + 1) % OID_CACHE_SIZE;
+
+	*der = entry->der;
+	*der_len = entry->der_len;
+	return IMG_PARSER_OK;
+}
+
 /*
  * Get X509v3 extension
  *
- * Global variable 'v3_ext' must point to the extensions region
- * in the certificate. No need to check for errors since the image has passed
- * the integrity check.
+ * The extensions in the certificate have been indexed in 'v3_ext_table' during
+ * the integrity check, so the DER encoding of the requested OID is compared
+ * against the extension IDs in the table. Only the extensions which did not fit
+ * in the table are parsed again. No need to check for errors since the image
+ * has passed the integrity check.
  */
 static int get_ext(const char *oid, void **ext, unsigned int *ext_len)
 {
-	int oid_len;
-	size_t len;
-	unsigned char *end_ext_data, *end_ext_octet;
-	unsigned char *p;
-	const unsigned char *end;
-	char oid_str[MAX_OID_STR_LEN];
+	const unsigned char *oid_der;
+	size_t oid_der_len, len;
+	unsigned char *p, *end, *end_ext_data;
 	mbedtls_asn1_buf extn_oid;
-	int is_critical;
+	unsigned int i;
+	int rc, is_critical;
 
 	assert(oid != NULL);
 
-	p = v3_ext.p;
-	end = v3_ext.p + v3_ext.len;
+	rc = get_oid_der(oid, &oid_der, &oid_der_len);
+	if (rc != IMG_PARSER_OK) {
+		return rc;
+	}
 
-	mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED |
-			     MBEDTLS_ASN1_SEQUENCE);
+	for (i = 0; i < v3_ext_num; i++) {
+		if ((v3_ext_table[i].oid.len == oid_der_len) &&
+		    (memcmp(v3_ext_table[i].oid.p, oid_der, oid_der_len) == 0)) {
+			*ext = (void *)v3_ext_table[i].data.p;
+			*ext_len = (unsigned int)v3_ext_table[i].data.len;
+			return IMG_PARSER_OK;
+		}
+	}
 
-	while (p < end) {
-		zeromem(&extn_oid, sizeof(extn_oid));
-		is_critical = 0; /* DEFAULT FALSE */
+	if (v3_ext_more == NULL) {
+		return IMG_PARSER_ERR_NOT_FOUND;
+	}
+
+	p = v3_ext_more;
+	end = v3_ext.p + v3_ext.len;
 
+	while (p < end) {
 		mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED |
 				     MBEDTLS_ASN1_SEQUENCE);
 		end_ext_data = p + len;
 
 		/* Get extension ID */
-		extn_oid.tag = *p;
-		mbedtls_asn1_get_tag(&p, end, &extn_oid.len, MBEDTLS_ASN1_OID);
+		mbedtls_asn1_get_tag(&p, end_ext_data, &extn_oid.len,
+				     MBEDTLS_ASN1_OID);
 		extn_oid.p = p;
 		p += extn_oid.len;
 
@@ -107,29 +263,21 @@ static int get_ext(const char *oid, void **ext, unsigned int *ext_len)
 		/* Extension data */
 		mbedtls_asn1_get_tag(&p, end_ext_data, &len,
 				     MBEDTLS_ASN1_OCTET_STRING);
-		end_ext_octet = p + len;
 
-		/* Detect requested extension */
-		oid_len = mbedtls_oid_get_numeric_string(oid_str,
-							 MAX_OID_STR_LEN,
-							 &extn_oid);
-		if (oid_len == MBEDTLS_ERR_OID_BUF_TOO_SMALL) {
-			return IMG_PARSER_ERR;
-		}
-		if ((oid_len == strlen(oid_str)) && !strcmp(oid, oid_str)) {
+		if ((extn_oid.len == oid_der_len) &&
+		    (memcmp(extn_oid.p, oid_der, oid_der_len) == 0)) {
 			*ext = (void *)p;
 			*ext_len = (unsigned int)len;
 			return IMG_PARSER_OK;
 		}
 
 		/* Next */
-		p = end_ext_octet;
+		p = end_ext_data;
 	}
 
 	return IMG_PARSER_ERR_NOT_FOUND;
 }
 
-
 /*
  * Check the integrity of the certificate ASN.1 structure.
  *
@@ -149,6 +297,8 @@ static int cert_parse(void *img, unsigned int img_len)
 	p = (unsigned char *)img;
 	len = img_len;
 	end = p + len;
+	v3_ext_num = 0;
+	v3_ext_more = NULL;
 
 	/*
 	 * Certificate  ::=  SEQUENCE  {
@@ -309,9 +459,16 @@ static int cert_parse(void *img, unsigned int img_len)
 	v3_ext.len = (p + len) - v3_ext.p;
 
 	/*
-	 * Check extensions integrity
+	 * Check extensions integrity and record where each extension is, so
+	 * get_ext() does not need to parse them again. If there are more than
+	 * MAX_V3_EXTENSIONS extensions, get_ext() searches the ones after the
+	 * last recorded extension.
 	 */
 	while (p < end) {
+		if ((v3_ext_num == MAX_V3_EXTENSIONS) && (v3_ext_more == NULL)) {
+			v3_ext_more = p;
+		}
+
 		ret = mbedtls_asn1_get_tag(&p, end, &len,
 					   MBEDTLS_ASN1_CONSTRUCTED |
 					   MBEDTLS_ASN1_SEQUENCE);
@@ -324,6 +481,11 @@ static int cert_parse(void *img, unsigned int img_len)
 		if (ret != 0) {
 			return IMG_PARSER_ERR_FORMAT;
 		}
+		if (v3_ext_more == NULL) {
+			v3_ext_table[v3_ext_num].oid.tag = MBEDTLS_ASN1_OID;
+			v3_ext_table[v3_ext_num].oid.p = p;
+			v3_ext_table[v3_ext_num].oid.len = len;
+		}
 		p += len;
 
 		/* Get optional critical */
@@ -338,6 +500,13 @@ static int cert_parse(void *img, unsigned int img_len)
 		if (ret != 0) {
 			return IMG_PARSER_ERR_FORMAT;
 		}
+		if (v3_ext_more == NULL) {
+			v3_ext_table[v3_ext_num].data.tag =
+						MBEDTLS_ASN1_OCTET_STRING;
+			v3_ext_table[v3_ext_num].data.p = p;
+			v3_ext_table[v3_ext_num].data.len = len;
+			v3_ext_num++;
+		}
 		p += len;
 	}
 
@@ -21,6 +21,29 @@
 #define PK_DER_LEN			294
 #define HASH_DER_LEN			51
 
+/*
+ * Slots of the authentication parameters in the 'authenticated_data' array of
+ * the certificate they are extracted from. They are used both to place the
+ * parameters in the CoT and in the parameter type descriptors, so the
+ * parameters can be retrieved at runtime without searching.
+ */
+#define TB_FW_HASH_SLOT				0
+#define TRUSTED_WORLD_PK_SLOT			0
+#define NON_TRUSTED_WORLD_PK_SLOT		1
+#define SCP_FW_CONTENT_PK_SLOT			0
+#define SCP_FW_HASH_SLOT			0
+#define SOC_FW_CONTENT_PK_SLOT			0
+#define SOC_FW_HASH_SLOT			0
+#define TOS_FW_CONTENT_PK_SLOT			0
+#define TOS_FW_HASH_SLOT			0
+#define TOS_FW_EXTRA1_HASH_SLOT			1
+#define TOS_FW_EXTRA2_HASH_SLOT			2
+#define NT_FW_CONTENT_PK_SLOT			0
+#define NT_WORLD_BL_HASH_SLOT			0
+#define SCP_BL2U_HASH_SLOT			0
+#define BL2U_HASH_SLOT				1
+#define NS_BL2U_HASH_SLOT			2
+
 /*
  * The platform must allocate buffers to store the authentication parameters
  * extracted from the certificates. In this case, because of the way the CoT is
@@ -54,40 +77,56 @@ static auth_param_type_desc_t sig_alg = AUTH_PARAM_TYPE_DESC(
 static auth_param_type_desc_t raw_data = AUTH_PARAM_TYPE_DESC(
 		AUTH_PARAM_RAW_DATA, 0);
 
-static auth_param_type_desc_t trusted_world_pk = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_PUB_KEY, TRUSTED_WORLD_PK_OID);
-static auth_param_type_desc_t non_trusted_world_pk = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_PUB_KEY, NON_TRUSTED_WORLD_PK_OID);
+static auth_param_type_desc_t trusted_world_pk = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_PUB_KEY, TRUSTED_WORLD_PK_OID,
+		TRUSTED_WORLD_PK_SLOT);
+static auth_param_type_desc_t non_trusted_world_pk = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_PUB_KEY, NON_TRUSTED_WORLD_PK_OID,
+		NON_TRUSTED_WORLD_PK_SLOT);
 
-static auth_param_type_desc_t scp_fw_content_pk = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_PUB_KEY, SCP_FW_CONTENT_CERT_PK_OID);
-static auth_param_type_desc_t soc_fw_content_pk = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_PUB_KEY, SOC_FW_CONTENT_CERT_PK_OID);
-static auth_param_type_desc_t tos_fw_content_pk = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_PUB_KEY, TRUSTED_OS_FW_CONTENT_CERT_PK_OID);
-static auth_param_type_desc_t nt_fw_content_pk = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_PUB_KEY, NON_TRUSTED_FW_CONTENT_CERT_PK_OID);
+static auth_param_type_desc_t scp_fw_content_pk = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_PUB_KEY, SCP_FW_CONTENT_CERT_PK_OID,
+		SCP_FW_CONTENT_PK_SLOT);
+static auth_param_type_desc_t soc_fw_content_pk = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_PUB_KEY, SOC_FW_CONTENT_CERT_PK_OID,
+		SOC_FW_CONTENT_PK_SLOT);
+static auth_param_type_desc_t tos_fw_content_pk = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_PUB_KEY, TRUSTED_OS_FW_CONTENT_CERT_PK_OID,
+		TOS_FW_CONTENT_PK_SLOT);
+static auth_param_type_desc_t nt_fw_content_pk = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_PUB_KEY, NON_TRUSTED_FW_CONTENT_CERT_PK_OID,
+		NT_FW_CONTENT_PK_SLOT);
 
-static auth_param_type_desc_t tb_fw_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, TRUSTED_BOOT_FW_HASH_OID);
-static auth_param_type_desc_t scp_fw_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, SCP_FW_HASH_OID);
-static auth_param_type_desc_t soc_fw_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, SOC_AP_FW_HASH_OID);
-static auth_param_type_desc_t tos_fw_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, TRUSTED_OS_FW_HASH_OID);
-static auth_param_type_desc_t tos_fw_extra1_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, TRUSTED_OS_FW_EXTRA1_HASH_OID);
-static auth_param_type_desc_t tos_fw_extra2_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, TRUSTED_OS_FW_EXTRA2_HASH_OID);
-static auth_param_type_desc_t nt_world_bl_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, NON_TRUSTED_WORLD_BOOTLOADER_HASH_OID);
-static auth_param_type_desc_t scp_bl2u_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, SCP_FWU_CFG_HASH_OID);
-static auth_param_type_desc_t bl2u_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, AP_FWU_CFG_HASH_OID);
-static auth_param_type_desc_t ns_bl2u_hash = AUTH_PARAM_TYPE_DESC(
-		AUTH_PARAM_HASH, FWU_HASH_OID);
+static auth_param_type_desc_t tb_fw_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, TRUSTED_BOOT_FW_HASH_OID,
+		TB_FW_HASH_SLOT);
+static auth_param_type_desc_t scp_fw_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, SCP_FW_HASH_OID,
+		SCP_FW_HASH_SLOT);
+static auth_param_type_desc_t soc_fw_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, SOC_AP_FW_HASH_OID,
+		SOC_FW_HASH_SLOT);
+static auth_param_type_desc_t tos_fw_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, TRUSTED_OS_FW_HASH_OID,
+		TOS_FW_HASH_SLOT);
+static auth_param_type_desc_t tos_fw_extra1_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, TRUSTED_OS_FW_EXTRA1_HASH_OID,
+		TOS_FW_EXTRA1_HASH_SLOT);
+static auth_param_type_desc_t tos_fw_extra2_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, TRUSTED_OS_FW_EXTRA2_HASH_OID,
+		TOS_FW_EXTRA2_HASH_SLOT);
+static auth_param_type_desc_t nt_world_bl_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, NON_TRUSTED_WORLD_BOOTLOADER_HASH_OID,
+		NT_WORLD_BL_HASH_SLOT);
+static auth_param_type_desc_t scp_bl2u_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, SCP_FWU_CFG_HASH_OID,
+		SCP_BL2U_HASH_SLOT);
+static auth_param_type_desc_t bl2u_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, AP_FWU_CFG_HASH_OID,
+		BL2U_HASH_SLOT);
+static auth_param_type_desc_t ns_bl2u_hash = AUTH_PARAM_TYPE_DESC_SLOT(
+		AUTH_PARAM_HASH, FWU_HASH_OID,
+		NS_BL2U_HASH_SLOT);
 
 /*
  * TBBR Chain of trust definition
@@ -119,7 +158,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[TB_FW_HASH_SLOT] = {
 				.type_desc = &tb_fw_hash,
 				.data = {
 					.ptr = (void *)tb_fw_hash_buf,
@@ -168,14 +207,14 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[TRUSTED_WORLD_PK_SLOT] = {
 				.type_desc = &trusted_world_pk,
 				.data = {
 					.ptr = (void *)trusted_world_pk_buf,
 					.len = (unsigned int)PK_DER_LEN
 				}
 			},
-			[1] = {
+			[NON_TRUSTED_WORLD_PK_SLOT] = {
 				.type_desc = &non_trusted_world_pk,
 				.data = {
 					.ptr = (void *)non_trusted_world_pk_buf,
@@ -210,7 +249,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[SCP_FW_CONTENT_PK_SLOT] = {
 				.type_desc = &scp_fw_content_pk,
 				.data = {
 					.ptr = (void *)content_pk_buf,
@@ -242,7 +281,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[SCP_FW_HASH_SLOT] = {
 				.type_desc = &scp_fw_hash,
 				.data = {
 					.ptr = (void *)scp_fw_hash_buf,
@@ -291,7 +330,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[SOC_FW_CONTENT_PK_SLOT] = {
 				.type_desc = &soc_fw_content_pk,
 				.data = {
 					.ptr = (void *)content_pk_buf,
@@ -323,7 +362,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[SOC_FW_HASH_SLOT] = {
 				.type_desc = &soc_fw_hash,
 				.data = {
 					.ptr = (void *)soc_fw_hash_buf,
@@ -372,7 +411,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[TOS_FW_CONTENT_PK_SLOT] = {
 				.type_desc = &tos_fw_content_pk,
 				.data = {
 					.ptr = (void *)content_pk_buf,
@@ -404,21 +443,21 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[TOS_FW_HASH_SLOT] = {
 				.type_desc = &tos_fw_hash,
 				.data = {
 					.ptr = (void *)tos_fw_hash_buf,
 					.len = (unsigned int)HASH_DER_LEN
 				}
 			},
-			[1] = {
+			[TOS_FW_EXTRA1_HASH_SLOT] = {
 				.type_desc = &tos_fw_extra1_hash,
 				.data = {
 					.ptr = (void *)tos_fw_extra1_hash_buf,
 					.len = (unsigned int)HASH_DER_LEN
 				}
 			},
-			[2] = {
+			[TOS_FW_EXTRA2_HASH_SLOT] = {
 				.type_desc = &tos_fw_extra2_hash,
 				.data = {
 					.ptr = (void *)tos_fw_extra2_hash_buf,
@@ -495,7 +534,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[NT_FW_CONTENT_PK_SLOT] = {
 				.type_desc = &nt_fw_content_pk,
 				.data = {
 					.ptr = (void *)content_pk_buf,
@@ -527,7 +566,7 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[NT_WORLD_BL_HASH_SLOT] = {
 				.type_desc = &nt_world_bl_hash,
 				.data = {
 					.ptr = (void *)nt_world_bl_hash_buf,
@@ -569,21 +608,21 @@ static const auth_img_desc_t cot_desc[] = {
 			}
 		},
 		.authenticated_data = {
-			[0] = {
+			[SCP_BL2U_HASH_SLOT] = {
 				.type_desc = &scp_bl2u_hash,
 				.data = {
 					.ptr = (void *)scp_fw_hash_buf,
 					.len = (unsigned int)HASH_DER_LEN
 				}
 			},
-			[1] = {
+			[BL2U_HASH_SLOT] = {
 				.type_desc = &bl2u_hash,
 				.data = {
 					.ptr = (void *)tb_fw_hash_buf,
 					.len = (unsigned int)HASH_DER_LEN
 				}
 			},
-			[2] = {
+			[NS_BL2U_HASH_SLOT] = {
 				.type_desc = &ns_bl2u_hash,
 				.data = {
 					.ptr = (void *)nt_world_bl_hash_buf,
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <cassert.h>
+#include <console.h>
+#include <debug.h>
+#include <platform.h>
+#include <platform_def.h>
+
+/* Size in bytes of the ring of each cpu */
+#ifndef PLAT_CONSOLE_BUFFER_SIZE
+#define PLAT_CONSOLE_BUFFER_SIZE	1024
+#endif
+
+/* Number of buffered characters from which a ring is drained on SMC return */
+#ifndef PLAT_CONSOLE_BUFFER_DRAIN_LEVEL
+#define PLAT_CONSOLE_BUFFER_DRAIN_LEVEL	(PLAT_CONSOLE_BUFFER_SIZE / 2)
+#endif
+
+/*******************************************************************************
+ * Once the runtime console output is buffered, each cpu writes its characters
+ * to its own ring instead of waiting for the UART. A cpu is the only reader and
+ * writer of its ring, so no lock is needed. A cpu drains its ring to the
+ * console when it goes idle, before it prints synchronously, when it panics
+ * and when it returns from an SMC with the ring filled up to the drain level.
+ * The characters printed while the ring is full are dropped and counted.
+ ******************************************************************************/
+#define CONSOLE_BUF_MASK	(PLAT_CONSOLE_BUFFER_SIZE - 1)
+
+CASSERT((PLAT_CONSOLE_BUFFER_SIZE & CONSOLE_BUF_MASK) == 0,
+	assert_console_buffer_size_not_power_of_2);
+CASSERT((PLAT_CONSOLE_BUFFER_DRAIN_LEVEL > 0) &&
+	(PLAT_CONSOLE_BUFFER_DRAIN_LEVEL <= PLAT_CONSOLE_BUFFER_SIZE),
+	assert_console_buffer_drain_level_out_of_range);
+
+typedef struct console_buf {
+	/* Number of characters written to and drained from the ring */
+	unsigned int head;
+	unsigned int tail;
+	unsigned int dropped;
+	/* Nesting level of console_buffer_sync_start() */
+	unsigned int sync;
+	char buf[PLAT_CONSOLE_BUFFER_SIZE];
+} __aligned(CACHE_WRITEBACK_GRANULE) console_buf_t;
+
+static console_buf_t console_bufs[PLATFORM_CORE_COUNT];
+static unsigned int console_buffer_started;
+static unsigned int console_buffer_sync;
+
+/*
+ * The rings are not used before the end of the cold boot, nor while the data
+ * cache is disabled, e.g. late in the power down sequence.
+ */
+static int console_buf_active(void)
+{
+	return console_buffer_started && (read_sctlr_el3() & SCTLR_C_BIT);
+}
+
+/* Write the characters buffered by a cpu to the console */
+static void console_buf_drain(console_buf_t *cb)
+{
+	unsigned int dropped;
+
+	while (cb->tail != cb->head) {
+		(void)console_putc(cb->buf[cb->tail & CONSOLE_BUF_MASK]);
+		cb->tail++;
+	}
+
+	if (cb->dropped != 0) {
+		dropped = cb->dropped;
+		cb->dropped = 0;
+
+		cb->sync++;
+		tf_printf("\n(%u console characters dropped)\n", dropped);
+		cb->sync--;
+	}
+}
+
+/*******************************************************************************
+ * Called by putchar() in BL31. The character is written to the ring of the
+ * calling cpu unless the output is synchronous.
+ ******************************************************************************/
+int console_buffer_putc(int c)
+{
+	console_buf_t *cb;
+
+	if (!console_buf_active())
+		return console_putc(c);
+
+	cb = &console_bufs[plat_my_core_pos()];
+
+	if (console_buffer_sync || (cb->sync != 0)) {
+		/* Keep the output of this cpu in order */
+		if (cb->tail != cb->head)
+			console_buf_drain(cb);
+		return console_putc(c);
+	}
+
+	if (cb->head - cb->tail == PLAT_CONSOLE_BUFFER_SIZE) {
+		cb->dropped++;
+		return c;
+	}
+
+	cb->buf[cb->head & CONSOLE_BUF_MASK] = c;
+	cb->head++;
+	return c;
+}
+
+/*******************************************************************************
+ * Write the characters buffered by the calling cpu to the console.
+ ******************************************************************************/
+void console_buffer_drain(void)
+{
+	console_buf_t *cb;
+
+	if (!console_buf_active())
+		return;
+
+	cb = &console_bufs[plat_my_core_pos()];
+	if ((cb->tail != cb->head) || (cb->dropped != 0))
+		console_buf_drain(cb);
+}
+
+/*******************************************************************************
+ * Called by the SMC handler once the handler of an SMC has returned. The ring
+ * of the calling cpu is drained if it holds PLAT_CONSOLE_BUFFER_DRAIN_LEVEL
+ * characters or more, so that the output of a cpu which does not go idle is
+ * still printed.
+ ******************************************************************************/
+void console_buffer_smc_return(void)
+{
+	console_buf_t *cb = &console_bufs[plat_my_core_pos()];
+
+	if (cb->head - cb->tail >= PLAT_CONSOLE_BUFFER_DRAIN_LEVEL)
+		console_buffer_drain();
+}
+
+/*******************************************************************************
+ * Make the output of the calling cpu synchronous until the matching call to
+ * console_buffer_sync_end(). This is used for the error messages, which may
+ * precede a panic.
+ ******************************************************************************/
+void console_buffer_sync_start(void)
+{
+	if (console_buf_active())
+		console_bufs[plat_my_core_pos()].sync++;
+}
+
+void console_buffer_sync_end(void)
+{
+	console_buf_t *cb;
+
+	if (!console_buf_active())
+		return;
+
+	cb = &console_bufs[plat_my_core_pos()];
+	if (cb->sync != 0)
+		cb->sync--;
+}
+
+/*******************************************************************************
+ * Make the output of all cpus synchronous if `sync` is not 0, e.g. while
+ * debugging, or buffered again otherwise. Each cpu drains its ring the next
+ * time it prints or goes idle.
+ ******************************************************************************/
+void console_buffer_set_sync(unsigned int sync)
+{
+	console_buffer_sync = sync;
+}
+
+/*******************************************************************************
+ * Start buffering the console output. This is called by the primary cpu at the
+ * end of the cold boot, so that only the runtime output is buffered.
+ ******************************************************************************/
+void console_buffer_start(void)
+{
+	console_buffer_started = 1;
+}
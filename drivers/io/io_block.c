@@ -14,11 +14,23 @@
 #include <string.h>
 #include <utils.h>
 
+/* Tag of a cached block. The block data lives in the platform cache region. */
+typedef struct {
+	int			lba;
+	unsigned int		valid;
+	unsigned int		last_used;
+} block_cache_entry_t;
+
 typedef struct {
 	io_block_dev_spec_t	*dev_spec;
 	uintptr_t		base;
 	size_t			file_pos;
 	size_t			size;
+	/* Block cache, set up from dev_spec->cache when the device opens */
+	block_cache_entry_t	*cache_entries;
+	unsigned int		cache_blocks;
+	unsigned int		cache_clock;
+	io_block_cache_stats_t	cache_stats;
 } block_dev_state_t;
 
 #define is_power_of_2(x)	((x != 0) && ((x & (x - 1)) == 0))
@@ -167,15 +179,202 @@ static int block_seek(io_entity_t *entity, int mode, ssize_t offset)
 	return 0;
 }
 
+/*
+ * Set up the block cache of a device. The cache region holds the block data
+ * followed by the array of tags.
+ */
+static void block_cache_init(block_dev_state_t *cur)
+{
+	io_block_spec_t *cache = &(cur->dev_spec->cache);
+	size_t block_size = cur->dev_spec->block_size;
+
+	cur->cache_blocks = cache->length /
+			    (block_size + sizeof(block_cache_entry_t));
+	cur->cache_entries = (block_cache_entry_t *)(cache->offset +
+				cur->cache_blocks * block_size);
+	cur->cache_clock = 0;
+	zeromem(&cur->cache_stats, sizeof(cur->cache_stats));
+	if (cur->cache_blocks != 0) {
+		zeromem(cur->cache_entries,
+			cur->cache_blocks * sizeof(block_cache_entry_t));
+	}
+}
+
+/* Drop any cached copy of the blocks in [lba, lba + count). */
+static void block_cache_invalidate(block_dev_state_t *cur, int lba,
+				   size_t count)
+{
+	block_cache_entry_t *entry;
+	unsigned int i;
+
+	for (i = 0; i < cur->cache_blocks; i++) {
+		entry = &cur->cache_entries[i];
+		if ((entry->valid != 0) && (entry->lba >= lba) &&
+		    ((size_t)(entry->lba - lba) < count))
+			entry->valid = 0;
+	}
+}
+
+/* Return the cache slot holding a block, or -1 if it isn't cached. */
+static int block_cache_lookup(block_dev_state_t *cur, int lba)
+{
+	unsigned int i;
+
+	for (i = 0; i < cur->cache_blocks; i++) {
+		if ((cur->cache_entries[i].valid != 0) &&
+		    (cur->cache_entries[i].lba == lba))
+			return i;
+	}
+
+	return -1;
+}
+
+/* Return an invalid cache slot, or else the least recently used one. */
+static unsigned int block_cache_victim(block_dev_state_t *cur)
+{
+	unsigned int i, victim = 0;
+
+	for (i = 0; i < cur->cache_blocks; i++) {
+		if (cur->cache_entries[i].valid == 0)
+			return i;
+		if (cur->cache_entries[i].last_used <
+		    cur->cache_entries[victim].last_used)
+			victim = i;
+	}
+
+	return victim;
+}
+
+/*
+ * Return the address of a copy of a single block. Without a cache the block
+ * is read into the block buffer. With a cache, a miss reads the block and the
+ * configured read-ahead through the block buffer and caches all of them.
+ */
+static uintptr_t block_read_block(block_dev_state_t *cur, int lba)
+{
+	io_block_dev_spec_t *dev_spec = cur->dev_spec;
+	io_block_spec_t *buf = &(dev_spec->buffer);
+	size_t block_size = dev_spec->block_size;
+	size_t count, blocks, end_lba;
+	unsigned int i, slot = 0;
+	int found;
+
+	if (cur->cache_blocks == 0) {
+		count = dev_spec->ops.read(lba, buf->offset, block_size);
+		assert(count == block_size);
+		return buf->offset;
+	}
+
+	found = block_cache_lookup(cur, lba);
+	if (found >= 0) {
+		cur->cache_stats.hits++;
+		cur->cache_entries[found].last_used = ++cur->cache_clock;
+		return dev_spec->cache.offset + found * block_size;
+	}
+
+	cur->cache_stats.misses++;
+
+	/* Read ahead within the open region and the block buffer. */
+	blocks = 1 + dev_spec->cache_readahead;
+	blocks = MIN(blocks, buf->length / block_size);
+	blocks = MIN(blocks, (size_t)cur->cache_blocks);
+	end_lba = (cur->base + cur->size) / block_size;
+	blocks = MIN(blocks, end_lba - lba);
+
+	count = dev_spec->ops.read(lba, buf->offset, blocks * block_size);
+	assert(count == blocks * block_size);
+
+	/*
+	 * Fill the slots backwards so that the requested block is the most
+	 * recently used and can't be evicted by its own read-ahead.
+	 */
+	block_cache_invalidate(cur, lba, blocks);
+	for (i = blocks; i-- > 0;) {
+		slot = block_cache_victim(cur);
+		memcpy((void *)(dev_spec->cache.offset + slot * block_size),
+		       (void *)(buf->offset + i * block_size), block_size);
+		cur->cache_entries[slot].lba = lba + i;
+		cur->cache_entries[slot].valid = 1;
+		cur->cache_entries[slot].last_used = ++cur->cache_clock;
+	}
+
+	return dev_spec->cache.offset + slot * block_size;
+}
+
+/*
+ * Read whole blocks starting at the current file position, which must be
+ * block aligned. A block aligned destination is handed straight to the
+ * device for DMA. Otherwise the data goes through the block buffer, one
+ * buffer length at a time.
+ */
+static void block_read_aligned(block_dev_state_t *cur, uintptr_t buffer,
+			       size_t length)
+{
+	io_block_spec_t *buf = &(cur->dev_spec->buffer);
+	io_block_ops_t *ops = &(cur->dev_spec->ops);
+	size_t block_size = cur->dev_spec->block_size;
+	size_t count, size;
+	int lba;
+
+	assert(((cur->file_pos % block_size) == 0) &&
+	       ((length % block_size) == 0));
+
+	if ((buffer & (block_size - 1)) == 0) {
+		lba = (cur->file_pos + cur->base) / block_size;
+		count = ops->read(lba, buffer, length);
+		assert(count == length);
+		cur->file_pos += length;
+		return;
+	}
+
+	while (length > 0) {
+		size = MIN(length, buf->length);
+		lba = (cur->file_pos + cur->base) / block_size;
+		count = ops->read(lba, buf->offset, size);
+		assert(count == size);
+		memcpy((void *)buffer, (void *)buf->offset, size);
+		cur->file_pos += size;
+		buffer += size;
+		length -= size;
+	}
+}
+
+/*
+ * Read the part of a single block starting at the current file position
+ * through the block cache or buffer. Return the number of bytes copied.
+ */
+static size_t block_read_partial(block_dev_state_t *cur, uintptr_t buffer,
+				 size_t length)
+{
+	size_t block_size = cur->dev_spec->block_size;
+	uintptr_t block;
+	size_t skip;
+	int lba;
+
+	skip = cur->file_pos % block_size;
+	lba = (cur->file_pos + cur->base) / block_size;
+	block = block_read_block(cur, lba);
+
+	length = MIN(length, block_size - skip);
+	memcpy((void *)buffer, (void *)(block + skip), length);
+	cur->file_pos += length;
+
+	return length;
+}
+
+/*
+ * The read is split into an unaligned head, an aligned middle and an
+ * unaligned tail. Only the head and tail blocks go through the block cache or
+ * buffer; the middle is read in a single request straight into the
+ * destination when the destination is block aligned.
+ */
 static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		      size_t *length_read)
 {
 	block_dev_state_t *cur;
 	io_block_spec_t *buf;
 	io_block_ops_t *ops;
-	size_t aligned_length, skip, count, left, padding, block_size;
-	int lba;
-	int buffer_not_aligned;
+	size_t block_size, left, size;
 
 	assert(entity->info != (uintptr_t)NULL);
 	cur = (block_dev_state_t *)entity->info;
@@ -184,90 +383,33 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	block_size = cur->dev_spec->block_size;
 	assert((length <= cur->size) &&
 	       (length > 0) &&
-	       (ops->read != 0));
+	       (ops->read != 0) &&
+	       (buf->length >= block_size) &&
+	       ((buf->length % block_size) == 0));
 
-	if ((buffer & (block_size - 1)) != 0) {
-		/*
-		 * buffer isn't aligned with block size.
-		 * Block device always relies on DMA operation.
-		 * It's better to make the buffer as block size aligned.
-		 */
-		buffer_not_aligned = 1;
-	} else {
-		buffer_not_aligned = 0;
+	left = length;
+
+	/* Head: the file position isn't aligned with block size. */
+	if ((cur->file_pos % block_size) != 0) {
+		size = block_read_partial(cur, buffer, left);
+		buffer += size;
+		left -= size;
+	}
+
+	/* Middle: whole blocks. */
+	size = left & ~(block_size - 1);
+	if (size != 0) {
+		block_read_aligned(cur, buffer, size);
+		buffer += size;
+		left -= size;
+	}
+
+	/* Tail: the end of the read isn't aligned with block size. */
+	if (left != 0) {
+		size = block_read_partial(cur, buffer, left);
+		assert(size == left);
 	}
 
-	skip = cur->file_pos % block_size;
-	aligned_length = ((skip + length) + (block_size - 1)) &
-			 ~(block_size - 1);
-	padding = aligned_length - (skip + length);
-	left = aligned_length;
-	do {
-		lba = (cur->file_pos + cur->base) / block_size;
-		if (left >= buf->length) {
-			/*
-			 * Since left is larger, it's impossible to padding.
-			 *
-			 * If buffer isn't aligned, we need to use aligned
-			 * buffer instead.
-			 */
-			if (skip || buffer_not_aligned) {
-				/*
-				 * The beginning address (file_pos) isn't
-				 * aligned with block size, we need to use
-				 * block buffer to read block. Since block
-				 * device is always relied on DMA operation.
-				 */
-				count = ops->read(lba, buf->offset,
-						  buf->length);
-			} else {
-				count = ops->read(lba, buffer, buf->length);
-			}
-			assert(count == buf->length);
-			cur->file_pos += count - skip;
-			if (skip || buffer_not_aligned) {
-				/*
-				 * Since there's not aligned block size caused
-				 * by skip or not aligned buffer, block buffer
-				 * is used to store data.
-				 */
-				memcpy((void *)buffer,
-				       (void *)(buf->offset + skip),
-				       count - skip);
-			}
-			left = left - (count - skip);
-		} else {
-			if (skip || padding || buffer_not_aligned) {
-				/*
-				 * The beginning address (file_pos) isn't
-				 * aligned with block size, we have to read
-				 * full block by block buffer instead.
-				 * The size isn't aligned with block size.
-				 * Use block buffer to avoid overflow.
-				 *
-				 * If buffer isn't aligned, use block buffer
-				 * to avoid DMA error.
-				 */
-				count = ops->read(lba, buf->offset, left);
-			} else
-				count = ops->read(lba, buffer, left);
-			assert(count == left);
-			left = left - (skip + padding);
-			cur->file_pos += left;
-			if (skip || padding || buffer_not_aligned) {
-				/*
-				 * Since there's not aligned block size or
-				 * buffer, block buffer is used to store data.
-				 */
-				memcpy((void *)buffer,
-				       (void *)(buf->offset + skip),
-				       left);
-			}
-			/* It's already the last block operation */
-			left = 0;
-		}
-		skip = cur->file_pos % block_size;
-	} while (left > 0);
 	*length_read = length;
 
 	return 0;
@@ -293,6 +435,11 @@ static int block_write(io_entity_t *entity, const uintptr_t buffer,
 	       (ops->read != 0) &&
 	       (ops->write != 0));
 
+	/* Writes go straight to the device, so drop stale cached blocks. */
+	skip = cur->file_pos % block_size;
+	block_cache_invalidate(cur, (cur->file_pos + cur->base) / block_size,
+			       (skip + length + block_size - 1) / block_size);
+
 	if ((buffer & (block_size - 1)) != 0) {
 		/*
 		 * buffer isn't aligned with block size.
@@ -392,7 +539,10 @@ static int block_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info)
 	assert((block_size > 0) &&
 	       (is_power_of_2(block_size) != 0) &&
 	       ((buffer->offset % block_size) == 0) &&
-	       ((buffer->length % block_size) == 0));
+	       ((buffer->length % block_size) == 0) &&
+	       ((cur->dev_spec->cache.offset % block_size) == 0));
+
+	block_cache_init(cur);
 
 	*dev_info = info;	/* cast away const */
 	(void)block_size;
@@ -407,6 +557,22 @@ static int block_dev_close(io_dev_info_t *dev_info)
 
 /* Exported functions */
 
+/* Return the block cache statistics of a block device */
+int io_block_get_cache_stats(const io_block_dev_spec_t *dev_spec,
+			     io_block_cache_stats_t *stats)
+{
+	unsigned int index = 0;
+	int result;
+
+	assert((dev_spec != NULL) && (stats != NULL));
+
+	result = find_first_block_state(dev_spec, &index);
+	if (result == 0)
+		*stats = state_pool[index].cache_stats;
+
+	return result;
+}
+
 /* Register the Block driver with the IO abstraction */
 int register_io_dev_block(const io_dev_connector_t **dev_con)
 {
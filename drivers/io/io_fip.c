@@ -6,6 +6,7 @@
 
 #include <assert.h>
 #include <bl_common.h>
+#include <cassert.h>
 #include <debug.h>
 #include <errno.h>
 #include <firmware_image_package.h>
@@ -27,6 +28,30 @@
 		x.node[0], x.node[1], x.node[2], x.node[3],			\
 		x.node[4], x.node[5]
 
+/*
+ * Number of slots in the cached Table of Contents. The ToC is parsed once
+ * when the device is initialised and stored in an open addressed hash table
+ * keyed by UUID, so this must be a power of two and larger than the number
+ * of entries in the FIP. Platforms may override it in platform_def.h.
+ */
+#ifndef FIP_TOC_CACHE_ENTRIES
+#define FIP_TOC_CACHE_ENTRIES	32
+#endif
+
+CASSERT(IS_POWER_OF_TWO(FIP_TOC_CACHE_ENTRIES),
+	assert_fip_toc_cache_entries_power_of_two);
+
+/*
+ * Number of files in the package that can be open at the same time, e.g. a
+ * certificate and the image it authenticates. Platforms may override it in
+ * platform_def.h.
+ */
+#ifndef FIP_MAX_OPEN_FILES
+#define FIP_MAX_OPEN_FILES	2
+#endif
+
+CASSERT(FIP_MAX_OPEN_FILES > 0, assert_fip_max_open_files);
+
 typedef struct {
 	/* Put file_pos above the struct to allow {0} on static init.
 	 * It is a workaround for a known bug in GCC
@@ -37,10 +62,25 @@ typedef struct {
 } file_state_t;
 
 static const uuid_t uuid_null = {0};
-static file_state_t current_file = {0};
+static file_state_t file_state_pool[FIP_MAX_OPEN_FILES] = { {0} };
 static uintptr_t backend_dev_handle;
 static uintptr_t backend_image_spec;
 
+/*
+ * The backend is opened by the first file opened in the package and shared
+ * by all open files until the last one is closed. fip_backend_pos tracks its
+ * cursor so that a read only seeks when it follows a read of another file.
+ */
+static unsigned int fip_open_files;
+static uintptr_t fip_backend_handle;
+static size_t fip_backend_pos;
+
+/* Cached ToC. Empty slots have a null UUID. */
+static fip_toc_entry_t toc_cache[FIP_TOC_CACHE_ENTRIES];
+static unsigned int toc_cache_entries;
+static unsigned int toc_cache_image_id;
+static int toc_cache_valid;
+
 
 /* Firmware Image Package driver functions */
 static int fip_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info);
@@ -61,6 +101,93 @@ static inline int compare_uuids(const uuid_t *uuid1, const uuid_t *uuid2)
 }
 
 
+/* Return the first hash table slot to probe for a UUID. */
+static inline unsigned int toc_cache_hash(const uuid_t *uuid)
+{
+	uint32_t key = uuid->time_low ^ uuid->time_mid ^
+			((uint32_t)uuid->time_hi_and_version << 16);
+
+	key ^= key >> 16;
+	key ^= key >> 8;
+
+	return key & (FIP_TOC_CACHE_ENTRIES - 1);
+}
+
+
+/* Return the cached ToC entry for a UUID, or NULL if it is not in the FIP. */
+static const fip_toc_entry_t *toc_cache_lookup(const uuid_t *uuid)
+{
+	unsigned int slot = toc_cache_hash(uuid);
+	unsigned int i;
+
+	/* The table is never full, so the probe ends on an empty slot. */
+	for (i = 0; i < FIP_TOC_CACHE_ENTRIES; i++) {
+		if (compare_uuids(&toc_cache[slot].uuid, &uuid_null) == 0)
+			break;
+		if (compare_uuids(&toc_cache[slot].uuid, uuid) == 0)
+			return &toc_cache[slot];
+		slot = (slot + 1) & (FIP_TOC_CACHE_ENTRIES - 1);
+	}
+
+	return NULL;
+}
+
+
+/* Insert a ToC entry into the cache. Return 0 on success. */
+static int toc_cache_insert(const fip_toc_entry_t *entry)
+{
+	unsigned int slot;
+
+	/* Keep one slot empty to terminate the lookup probe sequence. */
+	if (toc_cache_entries >= (FIP_TOC_CACHE_ENTRIES - 1))
+		return -ENOMEM;
+
+	/* A duplicated UUID keeps its first entry, as a linear search would. */
+	if (toc_cache_lookup(&entry->uuid) != NULL)
+		return 0;
+
+	slot = toc_cache_hash(&entry->uuid);
+	while (compare_uuids(&toc_cache[slot].uuid, &uuid_null) != 0)
+		slot = (slot + 1) & (FIP_TOC_CACHE_ENTRIES - 1);
+
+	toc_cache[slot] = *entry;
+	toc_cache_entries++;
+
+	return 0;
+}
+
+
+/* Read the whole Table of Contents from the backend into the cache. */
+static int toc_cache_fill(uintptr_t backend_handle)
+{
+	int result;
+	fip_toc_entry_t entry;
+	size_t bytes_read;
+
+	zeromem(toc_cache, sizeof(toc_cache));
+	toc_cache_entries = 0;
+
+	for (;;) {
+		result = io_read(backend_handle, (uintptr_t)&entry,
+				 sizeof(entry), &bytes_read);
+		if (result != 0) {
+			WARN("Failed to read FIP (%i)\n", result);
+			return -ENOENT;
+		}
+
+		/* A null UUID marks the end of the ToC */
+		if (compare_uuids(&entry.uuid, &uuid_null) == 0)
+			return 0;
+
+		if (toc_cache_insert(&entry) != 0) {
+			WARN("FIP ToC has more than %u entries\n",
+				FIP_TOC_CACHE_ENTRIES - 1);
+			return -ENOMEM;
+		}
+	}
+}
+
+
 /* TODO: We could check version numbers or do a package checksum? */
 static inline int is_valid_header(fip_toc_header_t *header)
 {
@@ -115,7 +242,10 @@ static int fip_dev_open(const uintptr_t dev_spec __unused,
 }
 
 
-/* Do some basic package checks. */
+/*
+ * Do some basic package checks and cache the Table of Contents. The cache is
+ * reused by later calls for the same image until the device is closed.
+ */
 static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 {
 	int result;
@@ -124,6 +254,11 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 	fip_toc_header_t header;
 	size_t bytes_read;
 
+	if ((toc_cache_valid != 0) && (toc_cache_image_id == image_id))
+		return 0;
+
+	toc_cache_valid = 0;
+
 	/* Obtain a reference to the image by querying the platform layer */
 	result = plat_get_image_source(image_id, &backend_dev_handle,
 				       &backend_image_spec);
@@ -151,9 +286,15 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 			result = -ENOENT;
 		} else {
 			VERBOSE("FIP header looks OK.\n");
+			result = toc_cache_fill(backend_handle);
 		}
 	}
 
+	if (result == 0) {
+		toc_cache_image_id = image_id;
+		toc_cache_valid = 1;
+	}
+
 	io_close(backend_handle);
 
  fip_dev_init_exit:
@@ -165,9 +306,10 @@ static int fip_dev_close(io_dev_info_t *dev_info)
 {
 	/* TODO: Consider tracking open files and cleaning them up here */
 
-	/* Clear the backend. */
+	/* Clear the backend and drop the cached ToC. */
 	backend_dev_handle = (uintptr_t)NULL;
 	backend_image_spec = (uintptr_t)NULL;
+	toc_cache_valid = 0;
 
 	return 0;
 }
@@ -178,78 +320,61 @@ static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 			 io_entity_t *entity)
 {
 	int result;
-	uintptr_t backend_handle;
 	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)spec;
-	size_t bytes_read;
-	int found_file = 0;
+	const fip_toc_entry_t *toc_entry;
+	file_state_t *fp = NULL;
+	unsigned int i;
 
 	assert(uuid_spec != NULL);
 	assert(entity != NULL);
 
-	/* Can only have one file open at a time for the moment. We need to
-	 * track state like file cursor position. We know the header lives at
-	 * offset zero, so this entry should never be zero for an active file.
-	 * When the system supports dynamic memory allocation we can allow more
-	 * than one open file at a time if needed.
+	/* Find a free file state. We know the header lives at offset zero, so
+	 * the entry offset should never be zero for an active file.
 	 */
-	if (current_file.entry.offset_address != 0) {
-		WARN("fip_file_open : Only one open file at a time.\n");
+	for (i = 0; i < FIP_MAX_OPEN_FILES; i++) {
+		if (file_state_pool[i].entry.offset_address == 0) {
+			fp = &file_state_pool[i];
+			break;
+		}
+	}
+
+	if (fp == NULL) {
+		WARN("fip_file_open: Too many open files.\n");
 		return -ENOMEM;
 	}
 
-	/* Attempt to access the FIP image */
-	result = io_open(backend_dev_handle, backend_image_spec,
-			 &backend_handle);
-	if (result != 0) {
-		WARN("Failed to open Firmware Image Package (%i)\n", result);
-		result = -ENOENT;
-		goto fip_file_open_exit;
+	if (toc_cache_valid == 0) {
+		WARN("fip_file_open: device not initialised\n");
+		return -ENOENT;
 	}
 
-	/* Seek past the FIP header into the Table of Contents */
-	result = io_seek(backend_handle, IO_SEEK_SET, sizeof(fip_toc_header_t));
-	if (result != 0) {
-		WARN("fip_file_open: failed to seek\n");
-		result = -ENOENT;
-		goto fip_file_open_close;
+	toc_entry = toc_cache_lookup(&uuid_spec->uuid);
+	if (toc_entry == NULL) {
+		/* Did not find the file in the FIP. */
+		return -ENOENT;
 	}
 
-	found_file = 0;
-	do {
-		result = io_read(backend_handle,
-				 (uintptr_t)&current_file.entry,
-				 sizeof(current_file.entry),
-				 &bytes_read);
-		if (result == 0) {
-			if (compare_uuids(&current_file.entry.uuid,
-					  &uuid_spec->uuid) == 0) {
-				found_file = 1;
-				break;
-			}
-		} else {
-			WARN("Failed to read FIP (%i)\n", result);
-			goto fip_file_open_close;
+	if (fip_open_files == 0) {
+		/* Attempt to access the FIP image */
+		result = io_open(backend_dev_handle, backend_image_spec,
+				 &fip_backend_handle);
+		if (result != 0) {
+			WARN("Failed to open Firmware Image Package (%i)\n",
+				result);
+			return -ENOENT;
 		}
-	} while (compare_uuids(&current_file.entry.uuid, &uuid_null) != 0);
-
-	if (found_file == 1) {
-		/* All fine. Update entity info with file state and return. Set
-		 * the file position to 0. The 'current_file.entry' holds the
-		 * base and size of the file.
-		 */
-		current_file.file_pos = 0;
-		entity->info = (uintptr_t)&current_file;
-	} else {
-		/* Did not find the file in the FIP. */
-		current_file.entry.offset_address = 0;
-		result = -ENOENT;
+		fip_backend_pos = 0;
 	}
 
- fip_file_open_close:
-	io_close(backend_handle);
+	/* All fine. Update entity info with file state and return. Set the
+	 * file position to 0. The 'entry' holds the base and size of the file.
+	 */
+	fp->entry = *toc_entry;
+	fp->file_pos = 0;
+	fip_open_files++;
+	entity->info = (uintptr_t)fp;
 
- fip_file_open_exit:
-	return result;
+	return 0;
 }
 
 
@@ -273,62 +398,61 @@ static int fip_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	file_state_t *fp;
 	size_t file_offset;
 	size_t bytes_read;
-	uintptr_t backend_handle;
 
 	assert(entity != NULL);
 	assert(buffer != (uintptr_t)NULL);
 	assert(length_read != NULL);
 	assert(entity->info != (uintptr_t)NULL);
 
-	/* Open the backend, attempt to access the blob image */
-	result = io_open(backend_dev_handle, backend_image_spec,
-			 &backend_handle);
-	if (result != 0) {
-		WARN("Failed to open FIP (%i)\n", result);
-		result = -ENOENT;
-		goto fip_file_read_exit;
-	}
-
 	fp = (file_state_t *)entity->info;
 
-	/* Seek to the position in the FIP where the payload lives */
+	/* Seek to the position in the FIP where the payload lives, unless
+	 * the backend is already there from the previous read of this file.
+	 */
 	file_offset = fp->entry.offset_address + fp->file_pos;
-	result = io_seek(backend_handle, IO_SEEK_SET, file_offset);
-	if (result != 0) {
-		WARN("fip_file_read: failed to seek\n");
-		result = -ENOENT;
-		goto fip_file_read_close;
+	if (file_offset != fip_backend_pos) {
+		result = io_seek(fip_backend_handle, IO_SEEK_SET, file_offset);
+		if (result != 0) {
+			WARN("fip_file_read: failed to seek\n");
+			return -ENOENT;
+		}
+		fip_backend_pos = file_offset;
 	}
 
-	result = io_read(backend_handle, buffer, length, &bytes_read);
+	result = io_read(fip_backend_handle, buffer, length, &bytes_read);
 	if (result != 0) {
-		/* We cannot read our data. Fail. */
+		/* We cannot read our data. Fail. The backend position is now
+		 * unknown, so force a seek on the next read.
+		 */
 		WARN("Failed to read payload (%i)\n", result);
-		result = -ENOENT;
-		goto fip_file_read_close;
-	} else {
-		/* Set caller length and new file position. */
-		*length_read = bytes_read;
-		fp->file_pos += bytes_read;
+		fip_backend_pos = 0;
+		return -ENOENT;
 	}
 
-/* Close the backend. */
- fip_file_read_close:
-	io_close(backend_handle);
+	/* Set caller length and new file position. */
+	*length_read = bytes_read;
+	fp->file_pos += bytes_read;
+	fip_backend_pos += bytes_read;
 
- fip_file_read_exit:
-	return result;
+	return 0;
 }
 
 
 /* Close a file in package */
 static int fip_file_close(io_entity_t *entity)
 {
-	/* Clear our current file pointer.
+	file_state_t *fp = (file_state_t *)entity->info;
+
+	/* Release the file state and close the backend with the last file.
 	 * If we had malloc() we would free() here.
 	 */
-	if (current_file.entry.offset_address != 0) {
-		zeromem(&current_file, sizeof(current_file));
+	if ((fp != NULL) && (fp->entry.offset_address != 0)) {
+		zeromem(fp, sizeof(*fp));
+
+		assert(fip_open_files > 0);
+		fip_open_files--;
+		if (fip_open_files == 0)
+			io_close(fip_backend_handle);
 	}
 
 	/* Clear the Entity info. */
@@ -339,6 +463,32 @@ static int fip_file_close(io_entity_t *entity)
 
 /* Exported functions */
 
+/*
+ * Return the offset in the package and the length of the file described by
+ * the io_uuid_spec_t `spec`, e.g. for a platform to prefetch it from memory
+ * mapped storage. The device must have been initialised.
+ */
+int fip_get_file_region(const uintptr_t spec, size_t *offset, size_t *length)
+{
+	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)spec;
+	const fip_toc_entry_t *toc_entry;
+
+	assert(uuid_spec != NULL);
+	assert((offset != NULL) && (length != NULL));
+
+	if (toc_cache_valid == 0)
+		return -ENOENT;
+
+	toc_entry = toc_cache_lookup(&uuid_spec->uuid);
+	if (toc_entry == NULL)
+		return -ENOENT;
+
+	*offset = toc_entry->offset_address;
+	*length = toc_entry->size;
+
+	return 0;
+}
+
 /* Register the Firmware Image Package driver with the IO abstraction */
 int register_io_dev_fip(const io_dev_connector_t **dev_con)
 {
@@ -207,6 +207,8 @@ int is_mem_free(uintptr_t free_base, size_t free_size,
 
 int load_image(unsigned int image_id, image_info_t *image_data);
 int load_auth_image(unsigned int image_id, image_info_t *image_data);
+int load_auth_image_pipelined(unsigned int image_id, image_info_t *image_data,
+			      unsigned int next_image_id);
 
 #else
 
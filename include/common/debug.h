@@ -25,6 +25,9 @@
 
 #ifndef __ASSEMBLY__
 #include <stdio.h>
+#if ENABLE_CONSOLE_BUFFER && defined(IMAGE_BL31)
+#include <console.h>
+#endif
 
 #if LOG_LEVEL >= LOG_LEVEL_NOTICE
 # define NOTICE(...)	tf_printf("NOTICE:  " __VA_ARGS__)
@@ -33,7 +36,16 @@
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_ERROR
-# define ERROR(...)	tf_printf("ERROR:   " __VA_ARGS__)
+# if ENABLE_CONSOLE_BUFFER && defined(IMAGE_BL31)
+/* Error messages are not buffered as they may precede a panic */
+#  define ERROR(...)	do {					\
+		console_buffer_sync_start();			\
+		tf_printf("ERROR:   " __VA_ARGS__);		\
+		console_buffer_sync_end();			\
+	} while (0)
+# else
+#  define ERROR(...)	tf_printf("ERROR:   " __VA_ARGS__)
+# endif
 #else
 # define ERROR(...)
 #endif
@@ -58,7 +70,15 @@
 
 
 void __dead2 do_panic(void);
+#if ENABLE_CONSOLE_BUFFER && defined(IMAGE_BL31)
+/* Print the output buffered by the cpu before the crash report */
+#define panic()	do {						\
+		console_buffer_drain();				\
+		do_panic();					\
+	} while (0)
+#else
 #define panic()	do_panic()
+#endif
 
 /* Function called when stack protection check code detects a corrupted stack */
 void __dead2 __stack_chk_fail(void);
@@ -38,6 +38,35 @@
  */
 #define MAX_RT_SVCS		128
 
+/*
+ * Constants to allow the assembler access an entry of the direct SMC function
+ * id table used by the fast dispatch path. The number of entries must be a
+ * power of 2 as the table is indexed by a hash of the function id.
+ */
+#define RT_SVC_FID_TABLE_SIZE		64
+#define RT_SVC_FID_ENTRY_SIZE_LOG2	4
+#define RT_SVC_FID_ENTRY_FID		0
+#define RT_SVC_FID_ENTRY_FLAGS		4
+#define RT_SVC_FID_ENTRY_HANDLE		8
+#define SIZEOF_RT_SVC_FID_ENTRY		(1 << RT_SVC_FID_ENTRY_SIZE_LOG2)
+
+/*
+ * Flags of a leaf handler. A light leaf handler is entered with only the
+ * registers which are not preserved by the AAPCS saved in the context (see
+ * DECLARE_RT_SVC_FID_LIGHT()).
+ */
+#define RT_SVC_FID_FLAG_LIGHT_BIT	0
+#define RT_SVC_FID_FLAG_LIGHT		(1 << RT_SVC_FID_FLAG_LIGHT_BIT)
+
+/*
+ * Hash of an SMC function id used to index the direct function id table. The
+ * OEN and calling convention bits are folded into the function number so that
+ * the SMC32 and SMC64 variants of a call from the same service do not collide.
+ */
+#define RT_SVC_FID_HASH(fid)	(((fid) ^ ((fid) >> FUNCID_OEN_SHIFT) ^	\
+				((fid) >> (FUNCID_CC_SHIFT - 4))) &	\
+				(RT_SVC_FID_TABLE_SIZE - 1))
+
 #ifndef __ASSEMBLY__
 
 /* Prototype for runtime service initializing function */
@@ -88,12 +117,79 @@ typedef struct rt_svc_desc {
  * 3. ensure that the assembler and the compiler see the handler
  *    routine at the same offset.
  */
+/*
+ * Descriptor for a leaf handler of a single SMC function id. When
+ * RT_SVC_FAST_DISPATCH is enabled, SMCs matching `smc_fid` are routed straight
+ * to `handle` without going through the top level handler of the runtime
+ * service which owns the function id. The leaf handler has the same signature
+ * and return semantics as the top level handler.
+ */
+typedef struct rt_svc_fid_desc {
+	uint32_t smc_fid;
+	uint32_t flags;
+	const char *name;
+	rt_svc_handle_t handle;
+} rt_svc_fid_desc_t;
+
+/*
+ * Entry in the direct function id table populated at runtime_svc_init() from
+ * the registered `rt_svc_fid_desc_t` descriptors.
+ */
+typedef struct rt_svc_fid_entry {
+	uint32_t smc_fid;
+	uint32_t flags;
+	rt_svc_handle_t handle;
+#ifdef AARCH32
+	uint32_t pad;
+#endif
+} rt_svc_fid_entry_t;
+
+#if RT_SVC_FAST_DISPATCH
+/*
+ * Convenience macro to declare a leaf handler for a single SMC function id.
+ * The runtime service which owns the function id must also be registered
+ * using DECLARE_RT_SVC(). The leaf handler is only installed if the
+ * initialisation of the owning service succeeded.
+ */
+#define DECLARE_RT_SVC_FID_FLAGS(_name, _fid, _smch, _flags) \
+	static const rt_svc_fid_desc_t __svc_fid_desc_ ## _name \
+		__section("rt_svc_fid_descs") __used = { \
+			.smc_fid = _fid, \
+			.flags = _flags, \
+			.name = #_name, \
+			.handle = _smch }
+#else
+#define DECLARE_RT_SVC_FID_FLAGS(_name, _fid, _smch, _flags)
+#endif
+
+#define DECLARE_RT_SVC_FID(_name, _fid, _smch) \
+	DECLARE_RT_SVC_FID_FLAGS(_name, _fid, _smch, 0)
+
+/*
+ * Convenience macro to declare a light leaf handler. In addition to the rules
+ * for leaf handlers, a light leaf handler must only return its results using
+ * the SMC_RETx() macros on `handle` and must not modify any other part of the
+ * context, switch the security state or enter a lower exception level. On
+ * AArch64, BL31 then skips saving and restoring the callee saved registers
+ * and the EL3 state around the call.
+ */
+#define DECLARE_RT_SVC_FID_LIGHT(_name, _fid, _smch) \
+	DECLARE_RT_SVC_FID_FLAGS(_name, _fid, _smch, RT_SVC_FID_FLAG_LIGHT)
+
 CASSERT((sizeof(rt_svc_desc_t) == SIZEOF_RT_SVC_DESC), \
 	assert_sizeof_rt_svc_desc_mismatch);
 CASSERT(RT_SVC_DESC_INIT == __builtin_offsetof(rt_svc_desc_t, init), \
 	assert_rt_svc_desc_init_offset_mismatch);
 CASSERT(RT_SVC_DESC_HANDLE == __builtin_offsetof(rt_svc_desc_t, handle), \
 	assert_rt_svc_desc_handle_offset_mismatch);
+CASSERT((sizeof(rt_svc_fid_entry_t) == SIZEOF_RT_SVC_FID_ENTRY), \
+	assert_sizeof_rt_svc_fid_entry_mismatch);
+CASSERT(RT_SVC_FID_ENTRY_FLAGS == \
+	__builtin_offsetof(rt_svc_fid_entry_t, flags), \
+	assert_rt_svc_fid_entry_flags_offset_mismatch);
+CASSERT(RT_SVC_FID_ENTRY_HANDLE == \
+	__builtin_offsetof(rt_svc_fid_entry_t, handle), \
+	assert_rt_svc_fid_entry_handle_offset_mismatch);
 
 
 /*
@@ -120,10 +216,15 @@ CASSERT(RT_SVC_DESC_HANDLE == __builtin_offsetof(rt_svc_desc_t, handle), \
  * Function & variable prototypes
  ******************************************************************************/
 void runtime_svc_init(void);
+extern uint8_t rt_svc_descs_indices[MAX_RT_SVCS];
 uintptr_t handle_runtime_svc(uint32_t smc_fid, void *cookie, void *handle,
 						unsigned int flags);
 extern uintptr_t __RT_SVC_DESCS_START__;
 extern uintptr_t __RT_SVC_DESCS_END__;
+#if RT_SVC_FAST_DISPATCH
+extern uintptr_t __RT_SVC_FID_DESCS_START__;
+extern uintptr_t __RT_SVC_FID_DESCS_END__;
+#endif
 void init_crash_reporting(void);
 
 #endif /*__ASSEMBLY__*/
@@ -27,11 +27,14 @@ typedef enum auth_param_type_enum {
 
 /*
  * Defines an authentication parameter. The cookie will be interpreted by the
- * image parser module.
+ * image parser module. The slot is the index of the parameter in the
+ * 'authenticated_data' array of the image that provides it, so it can be
+ * retrieved without searching the array.
  */
 typedef struct auth_param_type_desc_s {
 	auth_param_type_t type;
 	void *cookie;
+	unsigned int slot;
 } auth_param_type_desc_t;
 
 /*
@@ -108,6 +111,17 @@ typedef struct auth_method_desc_s {
 		.cookie = (void *)_cookie \
 	}
 
+/*
+ * Helper macro to define an authentication parameter type descriptor for a
+ * parameter stored at a fixed slot of the 'authenticated_data' array
+ */
+#define AUTH_PARAM_TYPE_DESC_SLOT(_type, _cookie, _slot) \
+	{ \
+		.type = _type, \
+		.cookie = (void *)_cookie, \
+		.slot = _slot \
+	}
+
 /*
  * Helper macro to define an authentication parameter data descriptor
  */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -36,6 +36,14 @@ int auth_mod_get_parent_id(unsigned int img_id, unsigned int *parent_id);
 int auth_mod_verify_img(unsigned int img_id,
 			void *img_ptr,
 			unsigned int img_len);
+#if AUTH_IMAGE_CACHE
+void auth_mod_get_cache_stats(unsigned int *hits, unsigned int *misses);
+#endif
+#if STREAM_IMAGE_HASH
+int auth_mod_hash_stream_start(unsigned int img_id);
+int auth_mod_hash_stream_active(unsigned int img_id);
+void auth_mod_hash_stream_update(void *data_ptr, unsigned int data_len);
+#endif
 
 /* Macro to register a CoT defined as an array of auth_img_desc_t */
 #define REGISTER_COT(_cot) \
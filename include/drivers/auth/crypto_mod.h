@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,13 +7,17 @@
 #ifndef __CRYPTO_MOD_H__
 #define __CRYPTO_MOD_H__
 
+/* Size of the digest returned by crypto_mod_calc_hash() (SHA-256) */
+#define CRYPTO_DIGEST_SIZE	32
+
 /* Return values */
 enum crypto_ret_value {
 	CRYPTO_SUCCESS = 0,
 	CRYPTO_ERR_INIT,
 	CRYPTO_ERR_HASH,
 	CRYPTO_ERR_SIGNATURE,
-	CRYPTO_ERR_UNKNOWN
+	CRYPTO_ERR_UNKNOWN,
+	CRYPTO_ERR_BUSY
 };
 
 /*
@@ -37,8 +41,49 @@ typedef struct crypto_lib_desc_s {
 	/* Verify a hash. Return one of the 'enum crypto_ret_value' options */
 	int (*verify_hash)(void *data_ptr, unsigned int data_len,
 			   void *digest_info_ptr, unsigned int digest_info_len);
+
+	/* Calculate the CRYPTO_DIGEST_SIZE bytes SHA-256 digest of some data.
+	 * This is optional. Return one of the 'enum crypto_ret_value'
+	 * options */
+	int (*calc_hash)(void *data_ptr, unsigned int data_len,
+			 unsigned char *output);
+
+	/* Verify a hash calculated over data supplied in several chunks. Only
+	 * one such hash can be in progress at a time. These are optional and
+	 * return one of the 'enum crypto_ret_value' options */
+	int (*verify_hash_start)(void *digest_info_ptr,
+				 unsigned int digest_info_len);
+	int (*verify_hash_update)(void *data_ptr, unsigned int data_len);
+	int (*verify_hash_finish)(void);
 } crypto_lib_desc_t;
 
+/*
+ * Hash engine descriptor
+ *
+ * A platform may provide a hash engine (e.g. a hardware accelerator) to verify
+ * the hashes calculated over several chunks of data instead of the library.
+ * Data is handed to the engine with submit(), which may return before the data
+ * has been consumed. The data must not be modified until poll() stops
+ * returning CRYPTO_ERR_BUSY, and nothing else may be submitted in the
+ * meantime. All functions return one of the 'enum crypto_ret_value' options.
+ */
+typedef struct crypto_hash_engine_desc_s {
+	const char *name;
+
+	/* Start a hash to be compared with the given DigestInfo. Any hash in
+	 * progress is discarded */
+	int (*start)(void *digest_info_ptr, unsigned int digest_info_len);
+
+	/* Add a chunk of data to the hash */
+	int (*submit)(void *data_ptr, unsigned int data_len);
+
+	/* Check whether the data submitted last has been consumed */
+	int (*poll)(void);
+
+	/* Finish the hash and compare it. Called once no data is pending */
+	int (*finish)(void);
+} crypto_hash_engine_desc_t;
+
 /* Public functions */
 void crypto_mod_init(void);
 int crypto_mod_verify_signature(void *data_ptr, unsigned int data_len,
@@ -47,6 +92,13 @@ int crypto_mod_verify_signature(void *data_ptr, unsigned int data_len,
 				void *pk_ptr, unsigned int pk_len);
 int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 			   void *digest_info_ptr, unsigned int digest_info_len);
+int crypto_mod_calc_hash(void *data_ptr, unsigned int data_len,
+			 unsigned char *output);
+int crypto_mod_verify_hash_start(void *digest_info_ptr,
+				 unsigned int digest_info_len);
+int crypto_mod_verify_hash_update(void *data_ptr, unsigned int data_len);
+int crypto_mod_verify_hash_poll(void);
+int crypto_mod_verify_hash_finish(void);
 
 /* Macro to register a cryptographic library */
 #define REGISTER_CRYPTO_LIB(_name, _init, _verify_signature, _verify_hash) \
@@ -57,4 +109,23 @@ int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 		.verify_hash = _verify_hash \
 	}
 
+/* Macro to register a cryptographic library which also provides the optional
+ * hash functions: the calculation of a digest and the verification of a hash
+ * calculated over several chunks of data. Any of them may be NULL */
+#define REGISTER_CRYPTO_LIB_HASH_STREAM(_name, _init, _verify_signature, \
+					_verify_hash, _calc_hash, \
+					_verify_hash_start, \
+					_verify_hash_update, \
+					_verify_hash_finish) \
+	const crypto_lib_desc_t crypto_lib_desc = { \
+		.name = _name, \
+		.init = _init, \
+		.verify_signature = _verify_signature, \
+		.verify_hash = _verify_hash, \
+		.calc_hash = _calc_hash, \
+		.verify_hash_start = _verify_hash_start, \
+		.verify_hash_update = _verify_hash_update, \
+		.verify_hash_finish = _verify_hash_finish \
+	}
+
 #endif /* __CRYPTO_MOD_H__ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,6 +7,34 @@
 #ifndef __MBEDTLS_COMMON_H__
 #define __MBEDTLS_COMMON_H__
 
+#include <stddef.h>
+
+/* Usage statistics of the mbed TLS heap */
+typedef struct mbedtls_heap_stats {
+	size_t heap_size;	/* Size of the heap */
+	size_t heap_top;	/* Bytes of the heap ever handed out as blocks */
+	size_t in_use;		/* Bytes currently allocated */
+	size_t peak;		/* Peak of 'in_use' since the last reset */
+	unsigned int allocs;	/* Allocations since the last reset */
+	unsigned int frees;	/* Frees since the last reset */
+	unsigned int failed;	/* Failed allocations since the last reset */
+} mbedtls_heap_stats_t;
+
+#if MBEDTLS_PK_CACHE
+/*
+ * Number of parsed public keys kept between signature verifications. Platforms
+ * may define a different number in their makefiles.
+ */
+#ifndef MBEDTLS_PK_CACHE_ENTRIES
+#define MBEDTLS_PK_CACHE_ENTRIES	2
+#endif
+#endif
+
 void mbedtls_init(void);
 
+#if MBEDTLS_HEAP_ARENA
+void mbedtls_heap_get_stats(mbedtls_heap_stats_t *stats);
+void mbedtls_heap_reset_stats(void);
+#endif
+
 #endif /* __MBEDTLS_COMMON_H__ */
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __MBEDTLS_HASH_ENGINE_H__
+#define __MBEDTLS_HASH_ENGINE_H__
+
+#include <crypto_mod.h>
+
+/*
+ * Software hash engine based on the mbed TLS SHA-256. A platform may return it
+ * from plat_get_crypto_hash_engine(), e.g. to exercise the asynchronous hash
+ * path of the crypto module without a hardware engine.
+ */
+extern const crypto_hash_engine_desc_t mbedtls_hash_engine;
+
+#endif /* __MBEDTLS_HASH_ENGINE_H__ */
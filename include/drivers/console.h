@@ -16,5 +16,28 @@ int console_putc(int c);
 int console_getc(void);
 int console_flush(void);
 
+/* Buffering of the runtime console output of BL31 (ENABLE_CONSOLE_BUFFER) */
+#if ENABLE_CONSOLE_BUFFER && defined(IMAGE_BL31)
+int console_buffer_putc(int c);
+void console_buffer_drain(void);
+void console_buffer_sync_start(void);
+void console_buffer_sync_end(void);
+void console_buffer_set_sync(unsigned int sync);
+void console_buffer_start(void);
+void console_buffer_smc_return(void);
+#else
+static inline void console_buffer_drain(void)
+{
+}
+
+static inline void console_buffer_sync_start(void)
+{
+}
+
+static inline void console_buffer_sync_end(void)
+{
+}
+#endif
+
 #endif /* __CONSOLE_H__ */
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -19,10 +19,26 @@ typedef struct io_block_dev_spec {
 	io_block_spec_t	buffer;
 	io_block_ops_t	ops;
 	size_t		block_size;
+	/*
+	 * Optional memory for a LRU cache of single block reads. The cache is
+	 * disabled when its length is zero. On a miss, up to
+	 * cache_readahead following blocks are read in the same request and
+	 * cached too, bounded by the size of the block buffer.
+	 */
+	io_block_spec_t	cache;
+	unsigned int	cache_readahead;
 } io_block_dev_spec_t;
 
+/* Block cache statistics */
+typedef struct io_block_cache_stats {
+	unsigned int	hits;
+	unsigned int	misses;
+} io_block_cache_stats_t;
+
 struct io_dev_connector;
 
 int register_io_dev_block(const struct io_dev_connector **dev_con);
+int io_block_get_cache_stats(const io_block_dev_spec_t *dev_spec,
+			     io_block_cache_stats_t *stats);
 
 #endif /* __IO_BLOCK_H__ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2014-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,8 +7,12 @@
 #ifndef __IO_FIP_H__
 #define __IO_FIP_H__
 
+#include <stddef.h>
+#include <stdint.h>
+
 struct io_dev_connector;
 
 int register_io_dev_fip(const struct io_dev_connector **dev_con);
+int fip_get_file_region(const uintptr_t spec, size_t *offset, size_t *length);
 
 #endif /* __IO_FIP_H__ */
@@ -197,6 +197,12 @@ void flush_dcache_range(uintptr_t addr, size_t size);
 void clean_dcache_range(uintptr_t addr, size_t size);
 void inv_dcache_range(uintptr_t addr, size_t size);
 
+/* Hint that the cache line at `addr` will be read */
+static inline void prefetch_dcache_line(uintptr_t addr)
+{
+	__asm__ volatile ("pld [%0]" : : "r" (addr));
+}
+
 void dcsw_op_louis(u_register_t op_type);
 void dcsw_op_all(u_register_t op_type);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -74,6 +74,8 @@ typedef bakery_info_t bakery_lock_t;
 
 static inline void bakery_lock_init(bakery_lock_t *bakery) {}
 void bakery_lock_get(bakery_lock_t *bakery);
+void bakery_lock_get_range(bakery_lock_t *bakery, unsigned int first_cpu,
+			   unsigned int ncpus);
 void bakery_lock_release(bakery_lock_t *bakery);
 
 #define DEFINE_BAKERY_LOCK(_name) bakery_lock_t _name __section("bakery_lock")
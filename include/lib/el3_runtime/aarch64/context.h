@@ -56,7 +56,12 @@
 #define CTX_RUNTIME_SP		U(0x8)
 #define CTX_SPSR_EL3		U(0x10)
 #define CTX_ELR_EL3		U(0x18)
+#if CTX_LAZY_FPREGS
+#define CTX_CPTR_EL3		U(0x20)
+#define CTX_EL3STATE_END	U(0x30) /* Align to the next 16 byte boundary */
+#else
 #define CTX_EL3STATE_END	U(0x20)
+#endif
 
 /*******************************************************************************
  * Constants that allow assembler code to access members of and the
@@ -120,6 +125,38 @@
 #define CTX_SYSREGS_END		CTX_TIMER_SYSREGS_OFF
 #endif /* __NS_TIMER_SWITCH__ */
 
+/*******************************************************************************
+ * Groups of EL1 system registers which can be saved independently of each other
+ * by el1_sysregs_context_save_groups(). A Secure Payload Dispatcher can use them
+ * to only save the registers that its Secure Payload is expected to modify
+ * while servicing a request, the others being unchanged since the last full
+ * save of the context.
+ *
+ * VOLATILE : SPSR_EL1, ELR_EL1, SP_EL1, ESR_EL1, FAR_EL1, PAR_EL1, AFSR0_EL1,
+ *            AFSR1_EL1 and CSSELR_EL1.
+ * THREAD   : TPIDR_EL1, TPIDR_EL0 and TPIDRRO_EL0.
+ * CONFIG   : SCTLR_EL1, ACTLR_EL1, CPACR_EL1, TTBR0_EL1, TTBR1_EL1, MAIR_EL1,
+ *            AMAIR_EL1, TCR_EL1, CONTEXTIDR_EL1 and VBAR_EL1.
+ * AARCH32  : AArch32 system registers, if CTX_INCLUDE_AARCH32_REGS is set.
+ * TIMER    : Non-secure timer registers, if NS_TIMER_SWITCH is set.
+ ******************************************************************************/
+#define CTX_EL1_SYSREGS_VOLATILE_BIT	U(0)
+#define CTX_EL1_SYSREGS_THREAD_BIT	U(1)
+#define CTX_EL1_SYSREGS_CONFIG_BIT	U(2)
+#define CTX_EL1_SYSREGS_AARCH32_BIT	U(3)
+#define CTX_EL1_SYSREGS_TIMER_BIT	U(4)
+
+#define CTX_EL1_SYSREGS_VOLATILE	(U(1) << CTX_EL1_SYSREGS_VOLATILE_BIT)
+#define CTX_EL1_SYSREGS_THREAD		(U(1) << CTX_EL1_SYSREGS_THREAD_BIT)
+#define CTX_EL1_SYSREGS_CONFIG		(U(1) << CTX_EL1_SYSREGS_CONFIG_BIT)
+#define CTX_EL1_SYSREGS_AARCH32		(U(1) << CTX_EL1_SYSREGS_AARCH32_BIT)
+#define CTX_EL1_SYSREGS_TIMER		(U(1) << CTX_EL1_SYSREGS_TIMER_BIT)
+#define CTX_EL1_SYSREGS_ALL		(CTX_EL1_SYSREGS_VOLATILE |	\
+					 CTX_EL1_SYSREGS_THREAD |	\
+					 CTX_EL1_SYSREGS_CONFIG |	\
+					 CTX_EL1_SYSREGS_AARCH32 |	\
+					 CTX_EL1_SYSREGS_TIMER)
+
 /*******************************************************************************
  * Constants that allow assembler code to access members of and the 'fp_regs'
  * structure at their correct offsets.
@@ -308,6 +345,8 @@ CASSERT(CTX_EL3STATE_OFFSET == __builtin_offsetof(cpu_context_t, el3state_ctx),
  * Function prototypes
  ******************************************************************************/
 void el1_sysregs_context_save(el1_sys_regs_t *regs);
+void el1_sysregs_context_save_groups(el1_sys_regs_t *regs,
+				     unsigned int groups);
 void el1_sysregs_context_save_post_ops(void);
 void el1_sysregs_context_restore(el1_sys_regs_t *regs);
 #if CTX_INCLUDE_FPREGS
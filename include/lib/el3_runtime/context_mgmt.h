@@ -36,7 +36,13 @@ void cm_prepare_el3_exit(uint32_t security_state);
 
 #ifndef AARCH32
 void cm_el1_sysregs_context_save(uint32_t security_state);
+void cm_el1_sysregs_context_save_groups(uint32_t security_state,
+					unsigned int groups);
 void cm_el1_sysregs_context_restore(uint32_t security_state);
+#if CTX_LAZY_FPREGS
+void cm_fpregs_context_save_live(void);
+void cm_fpregs_access_trap_handler(void);
+#endif
 void cm_set_elr_el3(uint32_t security_state, uintptr_t entrypoint);
 void cm_set_elr_spsr_el3(uint32_t security_state,
 			uintptr_t entrypoint, uint32_t spsr);
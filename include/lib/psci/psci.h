@@ -84,6 +84,34 @@
 #define is_psci_fid(_fid) \
 	(((_fid) & PSCI_FID_MASK) == PSCI_FID_VALUE)
 
+/*******************************************************************************
+ * SiP calls reading the PSCI stat histograms (ENABLE_PSCI_STAT_HIST). They take
+ * the same `target_cpu` and `power_state` arguments as PSCI_STAT_COUNT,
+ * followed by the histogram and the bucket to read.
+ ******************************************************************************/
+#define PSCI_STAT_HIST_AARCH32		U(0x82000040)
+#define PSCI_STAT_HIST_AARCH64		U(0xc2000040)
+#define PSCI_STAT_HIST_NUM_CALLS	U(2)
+
+#define PSCI_STAT_HIST_FID_MASK		U(0xffe0)
+#define PSCI_STAT_HIST_FID_VALUE	U(0x40)
+#define is_psci_stat_hist_fid(_fid) \
+	(((_fid) & PSCI_STAT_HIST_FID_MASK) == PSCI_STAT_HIST_FID_VALUE)
+
+/* Histograms which can be read */
+#define PSCI_STAT_HIST_RESIDENCY	U(0)
+#define PSCI_STAT_HIST_ENTRY_LATENCY	U(1)
+#define PSCI_STAT_HIST_EXIT_LATENCY	U(2)
+
+/*
+ * Number of buckets per histogram. The values are in microseconds. Bucket 0
+ * counts the values lower than 1, bucket n the values in [2^(n-1), 2^n) and the
+ * last bucket all the bigger ones.
+ */
+#ifndef PSCI_STAT_HIST_BUCKETS
+#define PSCI_STAT_HIST_BUCKETS		U(20)
+#endif
+
 /*******************************************************************************
  * PSCI Migrate and friends
  ******************************************************************************/
@@ -310,6 +338,10 @@ long psci_migrate_info_up_cpu(void);
 int psci_node_hw_state(u_register_t target_cpu,
 		       unsigned int power_level);
 int psci_features(unsigned int psci_fid);
+#if ENABLE_PSCI_STAT_HIST
+u_register_t psci_stat_hist(u_register_t target_cpu, unsigned int power_state,
+			    unsigned int hist, unsigned int bucket);
+#endif
 void __dead2 psci_power_down_wfi(void);
 void psci_arch_setup(void);
 
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __RUNTIME_TRACE_H__
+#define __RUNTIME_TRACE_H__
+
+#ifndef __ASSEMBLY__
+#include <runtime_trace_format.h>
+#include <stdint.h>
+
+/* Runtime tracing is only supported in BL31 */
+#if ENABLE_RUNTIME_TRACE && defined(IMAGE_BL31)
+void runtime_trace_init(void);
+void runtime_trace_event(unsigned int event, unsigned int info,
+			 uint32_t data);
+void runtime_trace_smc(uint32_t smc_fid, unsigned long long start,
+		       unsigned int flags);
+void runtime_trace_intr(uint32_t type);
+
+#define RUNTIME_TRACE(_event, _info, _data)		\
+	runtime_trace_event((_event), (_info), (_data))
+#else
+#define RUNTIME_TRACE(_event, _info, _data)
+#endif /* ENABLE_RUNTIME_TRACE && defined(IMAGE_BL31) */
+
+#endif /* __ASSEMBLY__ */
+#endif /* __RUNTIME_TRACE_H__ */
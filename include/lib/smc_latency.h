@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __SMC_LATENCY_H__
+#define __SMC_LATENCY_H__
+
+/*
+ * Number of latency buckets per histogram. Bucket 0 counts SMCs handled in
+ * less than 2 system counter ticks, bucket n counts SMCs handled in [2^n,
+ * 2^(n+1)) ticks and the last bucket counts all the longer ones.
+ */
+#define SMC_LAT_NUM_BUCKETS		16
+
+/*
+ * Maximum number of runtime services, i.e. of DECLARE_RT_SVC() descriptors,
+ * for which histograms are kept. SMCs owned by services beyond this are not
+ * recorded.
+ */
+#ifndef SMC_LAT_MAX_SVCS
+#define SMC_LAT_MAX_SVCS		8
+#endif
+
+/*
+ * Layout of the PMF timestamp id used to read a histogram bucket. Bits[7:0]
+ * hold the unique OEN (OEN[5:0] and the call type in bit 6) of the SMCs and
+ * bits[23:16] the bucket number.
+ */
+#define SMC_LAT_TID_BUCKET_SHIFT	16
+#define SMC_LAT_TID_BUCKET_MASK		(0xFF << SMC_LAT_TID_BUCKET_SHIFT)
+
+#ifndef __ASSEMBLY__
+#include <stdint.h>
+
+void smc_latency_record(uint32_t smc_fid, unsigned long long start);
+#endif /* __ASSEMBLY__ */
+
+#endif /* __SMC_LATENCY_H__ */
@@ -11,6 +11,11 @@
 
 #include <types.h>
 
+/*
+ * With USE_TICKET_SPINLOCKS, the low half of the lock word holds the ticket
+ * being served and the high half the next ticket to be handed out. In either
+ * case a zero-initialised lock is unlocked.
+ */
 typedef struct spinlock {
 	volatile uint32_t lock;
 } spinlock_t;
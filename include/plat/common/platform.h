@@ -16,6 +16,7 @@
  * Forward declarations
  ******************************************************************************/
 struct auth_img_desc_s;
+struct crypto_hash_engine_desc_s;
 struct meminfo;
 struct image_info;
 struct entry_point_info;
@@ -79,6 +80,9 @@ int plat_crash_console_putc(int c);
 int plat_crash_console_flush(void);
 void plat_error_handler(int err) __dead2;
 void plat_panic_handler(void) __dead2;
+#if LOAD_IMAGE_V2
+void plat_prefetch_image(unsigned int image_id);
+#endif
 
 /*******************************************************************************
  * Mandatory BL1 functions
@@ -269,6 +273,7 @@ int plat_get_nv_ctr(void *cookie, unsigned int *nv_ctr);
 int plat_set_nv_ctr(void *cookie, unsigned int nv_ctr);
 int plat_set_nv_ctr2(void *cookie, const struct auth_img_desc_s *img_desc,
 		unsigned int nv_ctr);
+const struct crypto_hash_engine_desc_s *plat_get_crypto_hash_engine(void);
 
 #if LOAD_IMAGE_V2
 /*******************************************************************************
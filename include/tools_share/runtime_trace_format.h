@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __RUNTIME_TRACE_FORMAT_H__
+#define __RUNTIME_TRACE_FORMAT_H__
+
+#include <stdint.h>
+
+/*
+ * Layout of the runtime trace buffer shared by BL31 and the trace decoder.
+ *
+ * The trace region is divided into one ring per CPU. Each ring starts with a
+ * runtime_trace_hdr_t and holds `num_recs` records from offset
+ * RUNTIME_TRACE_RECS_OFFSET. All fields are little endian. BL31 writes the
+ * record for the n-th event of a CPU in slot (n % num_recs), then updates
+ * `head` to n + 1. A reader must read `head` before and after copying the
+ * records. Only the records with sequence numbers in
+ * [head_after + 1 - num_recs, head_before) are then valid.
+ */
+#define RUNTIME_TRACE_MAGIC		0x43525452	/* "RTRC" */
+#define RUNTIME_TRACE_VERSION		1
+
+/* Offset of the first record from the start of a ring */
+#define RUNTIME_TRACE_RECS_OFFSET	64
+
+/* Events */
+#define RUNTIME_TRACE_SMC_ENTRY		1
+#define RUNTIME_TRACE_SMC_EXIT		2
+#define RUNTIME_TRACE_INTR_ENTRY	3
+#define RUNTIME_TRACE_PWR_DOWN		4
+#define RUNTIME_TRACE_PWR_UP		5
+#define RUNTIME_TRACE_WORLD_SWITCH	6
+
+/*
+ * Meaning of the `info` and `data` fields of a record for each event:
+ *
+ * SMC_ENTRY:	 info: security state of the caller (0 secure, 1 non-secure)
+ *		 data: SMC function id
+ * SMC_EXIT:	 info: 0
+ *		 data: SMC function id
+ * INTR_ENTRY:	 info: 0
+ *		 data: interrupt type (INTR_TYPE_S_EL1, INTR_TYPE_EL3 or
+ *		       INTR_TYPE_NS)
+ * PWR_DOWN:	 info: highest power level being powered down or put in
+ *		       retention
+ *		 data: local power state of levels 0 to 3 in bits[8n+7:8n]
+ * PWR_UP:	 info, data: as for PWR_DOWN, for the state woken up from
+ * WORLD_SWITCH: info: security state of the context the next ERET returns to
+ *		 data: 0
+ */
+
+typedef struct runtime_trace_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t rec_size;
+	/* Size of this ring in bytes, header included */
+	uint32_t ring_size;
+	/* Linear index of the CPU owning this ring */
+	uint32_t cpu;
+	uint64_t num_recs;
+	/* Frequency of the system counter used for the timestamps */
+	uint64_t cntfrq;
+	/* Number of records written since the ring was initialised */
+	volatile uint64_t head;
+} runtime_trace_hdr_t;
+
+typedef struct runtime_trace_rec {
+	/* System counter value when the event occurred */
+	uint64_t timestamp;
+	uint32_t data;
+	uint16_t event;
+	uint16_t info;
+} runtime_trace_rec_t;
+
+#endif /* __RUNTIME_TRACE_FORMAT_H__ */
@@ -13,6 +13,7 @@
 #include <interrupt_mgmt.h>
 #include <platform.h>
 #include <platform_def.h>
+#include <runtime_trace.h>
 #include <smcc_helpers.h>
 #include <string.h>
 #include <utils.h>
@@ -175,6 +176,19 @@ static void cm_init_context_common(cpu_context_t *ctx, const entry_point_info_t
 	write_ctx_reg(state, CTX_ELR_EL3, ep->pc);
 	write_ctx_reg(state, CTX_SPSR_EL3, ep->spsr);
 
+#if CTX_LAZY_FPREGS
+	/*
+	 * The floating point context is only switched lazily by BL31. Until the
+	 * context has been restored on first use, accesses to the FP/SIMD
+	 * registers from the next EL trap to EL3.
+	 */
+#ifdef IMAGE_BL31
+	write_ctx_reg(state, CTX_CPTR_EL3, read_cptr_el3() | TFP_BIT);
+#else
+	write_ctx_reg(state, CTX_CPTR_EL3, read_cptr_el3() & ~TFP_BIT);
+#endif
+#endif
+
 	/*
 	 * Store the X0-X7 value from the entrypoint into the context
 	 * Use memcpy as we are in control of the layout of the structures
@@ -418,6 +432,25 @@ void cm_el1_sysregs_context_save(uint32_t security_state)
 	el1_sysregs_context_save_post_ops();
 }
 
+/*******************************************************************************
+ * This function saves only the groups of EL1 system registers specified in
+ * 'groups' (a mask of CTX_EL1_SYSREGS_* values) on the 'cpu_context' structure
+ * for the specified security state. The caller must ensure that the registers
+ * of the other groups have not been modified since they were last saved or
+ * restored, as their saved values will be used on the next restore.
+ ******************************************************************************/
+void cm_el1_sysregs_context_save_groups(uint32_t security_state,
+					unsigned int groups)
+{
+	cpu_context_t *ctx;
+
+	ctx = cm_get_context(security_state);
+	assert(ctx);
+
+	el1_sysregs_context_save_groups(get_sysregs_ctx(ctx), groups);
+	el1_sysregs_context_save_post_ops();
+}
+
 void cm_el1_sysregs_context_restore(uint32_t security_state)
 {
 	cpu_context_t *ctx;
@@ -526,5 +559,7 @@ void cm_set_next_eret_context(uint32_t security_state)
 	ctx = cm_get_context(security_state);
 	assert(ctx);
 
+	RUNTIME_TRACE(RUNTIME_TRACE_WORLD_SWITCH, security_state, 0);
+
 	cm_set_next_context(ctx);
 }
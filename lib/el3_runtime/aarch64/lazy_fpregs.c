@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <assert.h>
+#include <context.h>
+#include <context_mgmt.h>
+#include <ep_info.h>
+
+/*******************************************************************************
+ * Lazy switching of the floating point context (CTX_LAZY_FPREGS). BL31 never
+ * saves or restores the FP/SIMD registers on a world switch. Instead, el3_exit()
+ * programs CPTR_EL3 from the 'cpu_context' being entered, in which CPTR_EL3.TFP
+ * is only clear if the FP/SIMD registers hold the floating point context of
+ * that security state. The first access from any other security state traps to
+ * EL3, where cm_fpregs_access_trap_handler() moves the registers over.
+ *
+ * As a result, neither the SPD world switch paths nor CPU_OFF need to save the
+ * FP/SIMD registers:
+ * - A world switch only changes the 'cpu_context' that el3_exit() programs
+ *   CPTR_EL3 from. The registers stay with their owner until another security
+ *   state traps, and the trap handler saves them into the owner's context
+ *   before restoring the caller's.
+ * - After CPU_OFF, the normal world restarts from the CPU_ON entry point and
+ *   the SPD initialises a new secure context, both through
+ *   cm_init_my_context(), which sets CPTR_EL3.TFP in them. The floating point
+ *   context held by the CPU before it was powered down is never used again.
+ * Only a power down suspend, after which the secure context is resumed, has to
+ * save the live context (see psci_suspend_to_pwrdown_start()).
+ ******************************************************************************/
+
+/*******************************************************************************
+ * The floating point registers of the current CPU hold the floating point
+ * context of at most one of its 'cpu_context' structures: the one in which
+ * CPTR_EL3.TFP is clear. This function saves that context, if any, and sets
+ * CPTR_EL3.TFP in it so that the next access to the FP/SIMD registers from its
+ * security state restores it. It must be called before the floating point
+ * registers are lost, e.g. when the CPU is powered down.
+ ******************************************************************************/
+void cm_fpregs_context_save_live(void)
+{
+	cpu_context_t *ctx;
+	el3_state_t *state;
+	uint64_t cptr_el3;
+	uint32_t security_state;
+
+	for (security_state = SECURE; security_state <= NON_SECURE;
+							security_state++) {
+		ctx = cm_get_context(security_state);
+		if (ctx == NULL)
+			continue;
+
+		state = get_el3state_ctx(ctx);
+		cptr_el3 = read_ctx_reg(state, CTX_CPTR_EL3);
+		if (cptr_el3 & TFP_BIT)
+			continue;
+
+		/* Allow accesses to the FP/SIMD registers from EL3 */
+		write_cptr_el3(read_cptr_el3() & ~TFP_BIT);
+		isb();
+
+		fpregs_context_save(get_fpregs_ctx(ctx));
+		write_ctx_reg(state, CTX_CPTR_EL3, cptr_el3 | TFP_BIT);
+	}
+}
+
+/*******************************************************************************
+ * This function is called from the exception vectors when a lower EL accesses
+ * the FP/SIMD registers while CPTR_EL3.TFP is set. It moves the floating point
+ * registers over to the security state that caused the trap and clears
+ * CPTR_EL3.TFP in its 'cpu_context' so that the access is retried without
+ * trapping once el3_exit() restores CPTR_EL3.
+ ******************************************************************************/
+void cm_fpregs_access_trap_handler(void)
+{
+	cpu_context_t *ctx;
+	el3_state_t *state;
+	uint32_t security_state;
+
+	security_state = (read_scr_el3() & SCR_NS_BIT) ? NON_SECURE : SECURE;
+	ctx = cm_get_context(security_state);
+	assert(ctx);
+
+	cm_fpregs_context_save_live();
+
+	/* Allow accesses to the FP/SIMD registers from EL3 */
+	write_cptr_el3(read_cptr_el3() & ~TFP_BIT);
+	isb();
+
+	fpregs_context_restore(get_fpregs_ctx(ctx));
+
+	state = get_el3state_ctx(ctx);
+	write_ctx_reg(state, CTX_CPTR_EL3,
+		      read_ctx_reg(state, CTX_CPTR_EL3) & ~TFP_BIT);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -40,7 +40,8 @@
 } while (0)
 
 /* Obtain a ticket for a given CPU */
-static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
+static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me,
+				      unsigned int first, unsigned int last)
 {
 	unsigned int my_ticket, their_ticket;
 	unsigned int they;
@@ -60,7 +61,7 @@ static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
 	 */
 	my_ticket = 0;
 	bakery->lock_data[me] = make_bakery_data(CHOOSING_TICKET, my_ticket);
-	for (they = 0; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first; they < last; they++) {
 		their_ticket = bakery_ticket_number(bakery->lock_data[they]);
 		if (their_ticket > my_ticket)
 			my_ticket = their_ticket;
@@ -87,26 +88,33 @@ static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
  * (and priority) value as 0. The contending CPU compares its priority with that
  * of others'. The CPU with the highest priority (lowest numerical value)
  * acquires the lock
+ *
+ * Only the CPUs in the range [first_cpu, first_cpu + ncpus) are considered as
+ * contenders, which must include the calling CPU.
  */
-void bakery_lock_get(bakery_lock_t *bakery)
+void bakery_lock_get_range(bakery_lock_t *bakery, unsigned int first_cpu,
+			   unsigned int ncpus)
 {
-	unsigned int they, me;
+	unsigned int they, me, last_cpu;
 	unsigned int my_ticket, my_prio, their_ticket;
 	unsigned int their_bakery_data;
 
 	me = plat_my_core_pos();
+	last_cpu = first_cpu + ncpus;
 
 	assert_bakery_entry_valid(me, bakery);
+	assert((me >= first_cpu) && (me < last_cpu));
+	assert(last_cpu <= BAKERY_LOCK_MAX_CPUS);
 
 	/* Get a ticket */
-	my_ticket = bakery_get_ticket(bakery, me);
+	my_ticket = bakery_get_ticket(bakery, me, first_cpu, last_cpu);
 
 	/*
 	 * Now that we got our ticket, compute our priority value, then compare
 	 * with that of others, and proceed to acquire the lock
 	 */
 	my_prio = PRIORITY(my_ticket, me);
-	for (they = 0; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first_cpu; they < last_cpu; they++) {
 		if (me == they)
 			continue;
 
@@ -136,6 +144,11 @@ void bakery_lock_get(bakery_lock_t *bakery)
 	/* Lock acquired */
 }
 
+void bakery_lock_get(bakery_lock_t *bakery)
+{
+	bakery_lock_get_range(bakery, 0, BAKERY_LOCK_MAX_CPUS);
+}
+
 
 /* Release the lock and signal contenders */
 void bakery_lock_release(bakery_lock_t *bakery)
@@ -83,7 +83,9 @@ static inline int is_lock_acquired(const bakery_info_t *my_bakery_info,
 }
 
 static unsigned int bakery_get_ticket(bakery_lock_t *lock,
-						unsigned int me, int is_cached)
+						unsigned int me, int is_cached,
+						unsigned int first,
+						unsigned int last)
 {
 	unsigned int my_ticket, their_ticket;
 	unsigned int they;
@@ -110,9 +112,11 @@ static unsigned int bakery_get_ticket(bakery_lock_t *lock,
 
 	/*
 	 * Iterate through the bakery information of each contender to allocate
-	 * the highest ticket number for this cpu.
+	 * the highest ticket number for this cpu. Only the cpus that can contend
+	 * for the lock are visited, which saves a cache maintenance operation
+	 * for each cpu outside the range.
 	 */
-	for (they = 0; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first; they < last; they++) {
 		if (me == they)
 			continue;
 
@@ -146,14 +150,26 @@ static unsigned int bakery_get_ticket(bakery_lock_t *lock,
 	return my_ticket;
 }
 
-void bakery_lock_get(bakery_lock_t *lock)
+/*
+ * Acquire the lock, considering only the cpus in the range [first_cpu,
+ * first_cpu + ncpus) as contenders. The range must include the calling cpu, and
+ * every cpu that takes the lock must pass the same range. This lets users such
+ * as PSCI, whose locks are only taken by the cpus in one power domain, avoid
+ * reading the bakery information of cpus that can never contend.
+ */
+void bakery_lock_get_range(bakery_lock_t *lock, unsigned int first_cpu,
+			   unsigned int ncpus)
 {
-	unsigned int they, me, is_cached;
+	unsigned int they, me, is_cached, last_cpu;
 	unsigned int my_ticket, my_prio, their_ticket;
 	bakery_info_t *their_bakery_info;
 	unsigned int their_bakery_data;
 
 	me = plat_my_core_pos();
+	last_cpu = first_cpu + ncpus;
+
+	assert((me >= first_cpu) && (me < last_cpu));
+	assert(last_cpu <= BAKERY_LOCK_MAX_CPUS);
 #ifdef AARCH32
 	is_cached = read_sctlr() & SCTLR_C_BIT;
 #else
@@ -161,14 +177,14 @@ void bakery_lock_get(bakery_lock_t *lock)
 #endif
 
 	/* Get a ticket */
-	my_ticket = bakery_get_ticket(lock, me, is_cached);
+	my_ticket = bakery_get_ticket(lock, me, is_cached, first_cpu, last_cpu);
 
 	/*
 	 * Now that we got our ticket, compute our priority value, then compare
 	 * with that of others, and proceed to acquire the lock
 	 */
 	my_prio = PRIORITY(my_ticket, me);
-	for (they = 0; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first_cpu; they < last_cpu; they++) {
 		if (me == they)
 			continue;
 
@@ -207,6 +223,11 @@ void bakery_lock_get(bakery_lock_t *lock)
 	/* Lock acquired */
 }
 
+void bakery_lock_get(bakery_lock_t *lock)
+{
+	bakery_lock_get_range(lock, 0, BAKERY_LOCK_MAX_CPUS);
+}
+
 void bakery_lock_release(bakery_lock_t *lock)
 {
 	bakery_info_t *my_bakery_info;
@@ -384,14 +384,20 @@ void psci_set_pwr_domains_to_run(unsigned int end_pwrlvl)
  * The 'state_info' is updated with the target state for each level between the
  * CPU and the 'end_pwrlvl' and returned to the caller.
  *
+ * If 'take_locks' is set, the lock of each power domain is acquired when the
+ * coordination reaches its level. Otherwise, the caller must hold the locks of
+ * all the levels until 'end_pwrlvl'. The highest level whose target state has
+ * been set in the power domain nodes is returned.
+ *
  * This function will only be invoked with data cache enabled and while
  * powering down a core.
  *****************************************************************************/
-void psci_do_state_coordination(unsigned int end_pwrlvl,
-				psci_power_state_t *state_info)
+static unsigned int do_state_coordination(unsigned int end_pwrlvl,
+					  psci_power_state_t *state_info,
+					  int take_locks)
 {
 	unsigned int lvl, parent_idx, cpu_idx = plat_my_core_pos();
-	unsigned int start_idx, ncpus;
+	unsigned int start_idx, ncpus, last_pwrlvl;
 	plat_local_state_t target_state, *req_states;
 
 	assert(end_pwrlvl <= PLAT_MAX_PWR_LVL);
@@ -401,6 +407,9 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 	   to target state */
 	for (lvl = PSCI_CPU_PWR_LVL + 1; lvl <= end_pwrlvl; lvl++) {
 
+		if (take_locks)
+			psci_lock_get(&psci_non_cpu_pd_nodes[parent_idx]);
+
 		/* First update the requested power state */
 		psci_set_req_local_pwr_state(lvl, cpu_idx,
 					     state_info->pwr_domain_state[lvl]);
@@ -427,6 +436,14 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 	}
 
+	/*
+	 * When the locks are acquired on the way up, the domains above the
+	 * level where the target state is RUN are left untouched: they are
+	 * running already since this cpu is, and the last cpu to power them
+	 * down will coordinate their state holding their locks.
+	 */
+	last_pwrlvl = take_locks ? MIN(lvl, end_pwrlvl) : end_pwrlvl;
+
 	/*
 	 * This is for cases when we break out of the above loop early because
 	 * the target power state is RUN at a power level < end_pwlvl.
@@ -441,9 +458,33 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 	}
 
 	/* Update the target state in the power domain nodes */
-	psci_set_target_local_pwr_states(end_pwrlvl, state_info);
+	psci_set_target_local_pwr_states(last_pwrlvl, state_info);
+
+	return last_pwrlvl;
 }
 
+void psci_do_state_coordination(unsigned int end_pwrlvl,
+				psci_power_state_t *state_info)
+{
+	(void)do_state_coordination(end_pwrlvl, state_info, 0);
+}
+
+#if PSCI_INCREMENTAL_LOCKING
+/******************************************************************************
+ * Variant of psci_do_state_coordination() which acquires the power domain
+ * locks itself, level by level, and stops at the first level whose target
+ * state is RUN. A cpu that is not the last one running in its cluster thus only
+ * takes the cluster lock, instead of the locks of every ancestor up to the
+ * system. It returns the highest level whose lock has been acquired, which
+ * must be passed to psci_release_pwr_domain_locks().
+ *****************************************************************************/
+unsigned int psci_do_state_coordination_locked(unsigned int end_pwrlvl,
+					       psci_power_state_t *state_info)
+{
+	return do_state_coordination(end_pwrlvl, state_info, 1);
+}
+#endif
+
 /******************************************************************************
  * This function validates a suspend request by making sure that if a standby
  * state is requested then no power level is turned off and the highest power
@@ -762,10 +803,15 @@ void psci_warmboot_entrypoint(void)
 
 #if ENABLE_PSCI_STAT
 	plat_psci_stat_accounting_stop(&state_info);
+	psci_stats_mark_wakeup();
 #endif
 
 	psci_get_target_local_pwr_states(end_pwrlvl, &state_info);
 
+#if ENABLE_RUNTIME_TRACE
+	psci_trace_pwr_event(RUNTIME_TRACE_PWR_UP, end_pwrlvl, &state_info);
+#endif
+
 	/*
 	 * This CPU could be resuming from suspend or it could have just been
 	 * turned on. To distinguish between these 2 cases, we examine the
@@ -1020,3 +1066,22 @@ void psci_do_pwrdown_sequence(unsigned int power_level)
 	psci_do_pwrdown_cache_maintenance(power_level);
 #endif
 }
+
+#if ENABLE_RUNTIME_TRACE
+/*******************************************************************************
+ * Record a power down or power up `event` of this cpu in the runtime trace,
+ * along with the local states of the power levels up to `end_pwrlvl`.
+ ******************************************************************************/
+void psci_trace_pwr_event(unsigned int event, unsigned int end_pwrlvl,
+			  const psci_power_state_t *state_info)
+{
+	unsigned int lvl;
+	uint32_t states = 0;
+
+	for (lvl = PSCI_CPU_PWR_LVL; (lvl <= end_pwrlvl) && (lvl < 4); lvl++)
+		states |= (uint32_t)state_info->pwr_domain_state[lvl] <<
+								(lvl * 8);
+
+	RUNTIME_TRACE(event, end_pwrlvl, states);
+}
+#endif
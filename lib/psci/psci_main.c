@@ -7,6 +7,7 @@
 #include <arch.h>
 #include <arch_helpers.h>
 #include <assert.h>
+#include <console.h>
 #include <debug.h>
 #include <platform.h>
 #include <pmf.h>
@@ -80,6 +81,9 @@ int psci_cpu_suspend(unsigned int power_state,
 		panic();
 	}
 
+	/* This CPU is going idle, so print its buffered console output */
+	console_buffer_drain();
+
 	/* Fast path for CPU standby.*/
 	if (is_cpu_standby_req(is_power_down_state, target_pwrlvl)) {
 		if  (!psci_plat_pm_ops->cpu_standby)
@@ -93,9 +97,16 @@ int psci_cpu_suspend(unsigned int power_state,
 		psci_set_cpu_local_state(cpu_pd_state);
 
 #if ENABLE_PSCI_STAT
+		/* Update PSCI stats */
+		psci_stats_update_pwr_down(PSCI_CPU_PWR_LVL, &state_info);
 		plat_psci_stat_accounting_start(&state_info);
 #endif
 
+#if ENABLE_RUNTIME_TRACE
+		psci_trace_pwr_event(RUNTIME_TRACE_PWR_DOWN, PSCI_CPU_PWR_LVL,
+				     &state_info);
+#endif
+
 #if ENABLE_RUNTIME_INSTRUMENTATION
 		PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
 		    RT_INSTR_ENTER_HW_LOW_PWR,
@@ -107,6 +118,11 @@ int psci_cpu_suspend(unsigned int power_state,
 		/* Upon exit from standby, set the state back to RUN. */
 		psci_set_cpu_local_state(PSCI_LOCAL_STATE_RUN);
 
+#if ENABLE_RUNTIME_TRACE
+		psci_trace_pwr_event(RUNTIME_TRACE_PWR_UP, PSCI_CPU_PWR_LVL,
+				     &state_info);
+#endif
+
 #if ENABLE_RUNTIME_INSTRUMENTATION
 		PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
 		    RT_INSTR_EXIT_HW_LOW_PWR,
@@ -115,6 +131,7 @@ int psci_cpu_suspend(unsigned int power_state,
 
 #if ENABLE_PSCI_STAT
 		plat_psci_stat_accounting_stop(&state_info);
+		psci_stats_mark_wakeup();
 
 		/* Update PSCI stats */
 		psci_stats_update_pwr_up(PSCI_CPU_PWR_LVL, &state_info);
@@ -190,6 +207,9 @@ int psci_cpu_off(void)
 	int rc;
 	unsigned int target_pwrlvl = PLAT_MAX_PWR_LVL;
 
+	/* Print the buffered console output of this CPU before it goes off */
+	console_buffer_drain();
+
 	/*
 	 * Do what is needed to power off this CPU and possible higher power
 	 * levels if it able to do so. Upon success, enter the final wfi
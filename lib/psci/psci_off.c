@@ -41,6 +41,7 @@ static void psci_set_power_off_state(psci_power_state_t *state_info)
 int psci_do_cpu_off(unsigned int end_pwrlvl)
 {
 	int rc = PSCI_E_SUCCESS, idx = plat_my_core_pos();
+	unsigned int lock_pwrlvl = end_pwrlvl;
 	psci_power_state_t state_info;
 
 	/*
@@ -49,6 +50,10 @@ int psci_do_cpu_off(unsigned int end_pwrlvl)
 	 */
 	assert(psci_plat_pm_ops->pwr_domain_off);
 
+#if PSCI_INCREMENTAL_LOCKING
+	/* The locks are acquired during the state coordination below */
+	lock_pwrlvl = PSCI_CPU_PWR_LVL;
+#else
 	/*
 	 * This function acquires the lock corresponding to each power
 	 * level so that by the time all locks are taken, the system topology
@@ -56,6 +61,7 @@ int psci_do_cpu_off(unsigned int end_pwrlvl)
 	 */
 	psci_acquire_pwr_domain_locks(end_pwrlvl,
 				      idx);
+#endif
 
 	/*
 	 * Call the cpu off handler registered by the Secure Payload Dispatcher
@@ -76,13 +82,22 @@ int psci_do_cpu_off(unsigned int end_pwrlvl)
 	 * it returns the negotiated state info for each power level upto
 	 * the end level specified.
 	 */
+#if PSCI_INCREMENTAL_LOCKING
+	lock_pwrlvl = psci_do_state_coordination_locked(end_pwrlvl,
+							&state_info);
+#else
 	psci_do_state_coordination(end_pwrlvl, &state_info);
+#endif
 
 #if ENABLE_PSCI_STAT
 	/* Update the last cpu for each level till end_pwrlvl */
 	psci_stats_update_pwr_down(end_pwrlvl, &state_info);
 #endif
 
+#if ENABLE_RUNTIME_TRACE
+	psci_trace_pwr_event(RUNTIME_TRACE_PWR_DOWN, end_pwrlvl, &state_info);
+#endif
+
 #if ENABLE_RUNTIME_INSTRUMENTATION
 
 	/*
@@ -120,7 +135,7 @@ exit:
 	 * Release the locks corresponding to each power level in the
 	 * reverse order to which they were acquired.
 	 */
-	psci_release_pwr_domain_locks(end_pwrlvl,
+	psci_release_pwr_domain_locks(lock_pwrlvl,
 				      idx);
 
 	/*
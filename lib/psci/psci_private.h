@@ -12,6 +12,7 @@
 #include <bl_common.h>
 #include <cpu_data.h>
 #include <psci.h>
+#include <runtime_trace.h>
 #include <spinlock.h>
 
 #if HW_ASSISTED_COHERENCY
@@ -53,13 +54,16 @@
 
 /*
  * Use bakery locks for state coordination as not all PSCI participants are
- * cache coherent.
+ * cache coherent. A power domain lock is only taken by the CPUs in that power
+ * domain, so only those CPUs are considered as contenders.
  */
 #define DEFINE_PSCI_LOCK(_name)		DEFINE_BAKERY_LOCK(_name)
 #define DECLARE_PSCI_LOCK(_name)	DECLARE_BAKERY_LOCK(_name)
 
 #define psci_lock_get(non_cpu_pd_node)				\
-	bakery_lock_get(&psci_locks[(non_cpu_pd_node)->lock_index])
+	bakery_lock_get_range(&psci_locks[(non_cpu_pd_node)->lock_index], \
+			      (non_cpu_pd_node)->cpu_start_idx,		\
+			      (non_cpu_pd_node)->ncpus)
 #define psci_lock_release(non_cpu_pd_node)			\
 	bakery_lock_release(&psci_locks[(non_cpu_pd_node)->lock_index])
 
@@ -211,6 +215,10 @@ void psci_get_parent_pwr_domain_nodes(unsigned int cpu_idx,
 				      unsigned int node_index[]);
 void psci_do_state_coordination(unsigned int end_pwrlvl,
 				psci_power_state_t *state_info);
+#if PSCI_INCREMENTAL_LOCKING
+unsigned int psci_do_state_coordination_locked(unsigned int end_pwrlvl,
+					       psci_power_state_t *state_info);
+#endif
 void psci_acquire_pwr_domain_locks(unsigned int end_pwrlvl,
 				   unsigned int cpu_idx);
 void psci_release_pwr_domain_locks(unsigned int end_pwrlvl,
@@ -224,6 +232,10 @@ void psci_print_power_domain_map(void);
 unsigned int psci_is_last_on_cpu(void);
 int psci_spd_migrate_info(u_register_t *mpidr);
 void psci_do_pwrdown_sequence(unsigned int power_level);
+#if ENABLE_RUNTIME_TRACE
+void psci_trace_pwr_event(unsigned int event, unsigned int end_pwrlvl,
+			  const psci_power_state_t *state_info);
+#endif
 
 /*
  * CPU power down is directly called only when HW_ASSISTED_COHERENCY is
@@ -268,5 +280,12 @@ u_register_t psci_stat_residency(u_register_t target_cpu,
 			unsigned int power_state);
 u_register_t psci_stat_count(u_register_t target_cpu,
 			unsigned int power_state);
+#if ENABLE_PSCI_STAT_HIST
+void psci_stats_mark_wakeup(void);
+#else
+static inline void psci_stats_mark_wakeup(void)
+{
+}
+#endif
 
 #endif /* __PSCI_PRIVATE_H__ */
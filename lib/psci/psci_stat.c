@@ -35,6 +35,92 @@ static psci_stat_t psci_cpu_stat[PLATFORM_CORE_COUNT]
 static psci_stat_t psci_non_cpu_stat[PSCI_NUM_NON_CPU_PWR_DOMAINS]
 				[PLAT_MAX_PWR_LVL_STATES];
 
+#if ENABLE_PSCI_STAT_HIST
+/* Ticks elapsed in one second by a signal of 1 MHz */
+#define MHZ_TICKS_PER_SEC 1000000
+
+typedef struct psci_stat_hist {
+	uint32_t count[PSCI_STAT_HIST_BUCKETS];
+} psci_stat_hist_t;
+
+/*
+ * Following structure holds the histograms of a CPU. The latencies are
+ * accounted against the highest power level entered by the CPU. Each CPU only
+ * updates its own histograms.
+ */
+typedef struct psci_cpu_hist {
+	/* System counter when the CPU started to power down and woke up */
+	unsigned long long pwr_down_ts;
+	unsigned long long wakeup_ts;
+	psci_stat_hist_t residency[PLAT_MAX_PWR_LVL_STATES];
+	psci_stat_hist_t entry_lat[PLAT_MAX_PWR_LVL + 1]
+				  [PLAT_MAX_PWR_LVL_STATES];
+	psci_stat_hist_t exit_lat[PLAT_MAX_PWR_LVL + 1]
+				 [PLAT_MAX_PWR_LVL_STATES];
+} __aligned(CACHE_WRITEBACK_GRANULE) psci_cpu_hist_t;
+
+static psci_cpu_hist_t psci_cpu_hist[PLATFORM_CORE_COUNT];
+static psci_stat_hist_t psci_non_cpu_hist[PSCI_NUM_NON_CPU_PWR_DOMAINS]
+					 [PLAT_MAX_PWR_LVL_STATES];
+
+/* Add a value in microseconds to a histogram */
+static void psci_hist_add(psci_stat_hist_t *hist, u_register_t val)
+{
+	unsigned int bucket = 0;
+
+	if (val != 0)
+		bucket = 64 - __builtin_clzll(val);
+
+	hist->count[MIN(bucket, PSCI_STAT_HIST_BUCKETS - 1U)]++;
+}
+
+static u_register_t psci_ticks_to_us(unsigned long long ticks)
+{
+	u_register_t div = read_cntfrq_el0() / MHZ_TICKS_PER_SEC;
+
+	assert(div);
+	return ticks / div;
+}
+
+/*******************************************************************************
+ * This function records the entry and exit latencies of the transition of the
+ * calling CPU which has just woken up from the local state with index
+ * `stat_idx` at power level `lvl`. `residency` is the residency of the CPU
+ * power domain in that transition. The entry latency is the time between the
+ * start of the power down and the entry in the low power state, i.e. the time
+ * which was not accounted as residency. The exit latency is the time from the
+ * wake up of the CPU until now.
+ ******************************************************************************/
+static void psci_stats_update_latency(unsigned int cpu_idx, unsigned int lvl,
+				      int stat_idx, u_register_t residency)
+{
+	psci_cpu_hist_t *hist = &psci_cpu_hist[cpu_idx];
+	unsigned long long now = read_cntpct_el0();
+	u_register_t transition;
+
+	/* The start of the power down is unknown on the first power on */
+	if (hist->pwr_down_ts == 0)
+		return;
+
+	transition = psci_ticks_to_us(hist->wakeup_ts - hist->pwr_down_ts);
+	psci_hist_add(&hist->entry_lat[lvl][stat_idx],
+		      (transition > residency) ? transition - residency : 0);
+	psci_hist_add(&hist->exit_lat[lvl][stat_idx],
+		      psci_ticks_to_us(now - hist->wakeup_ts));
+
+	hist->pwr_down_ts = 0;
+}
+
+/*******************************************************************************
+ * This function is called right after plat_psci_stat_accounting_stop(), with
+ * the data cache enabled, to mark the wake up of the calling CPU.
+ ******************************************************************************/
+void psci_stats_mark_wakeup(void)
+{
+	psci_cpu_hist[plat_my_core_pos()].wakeup_ts = read_cntpct_el0();
+}
+#endif /* ENABLE_PSCI_STAT_HIST */
+
 /*
  * This functions returns the index into the `psci_stat_t` array given the
  * local power state and power domain level. If the platform implements the
@@ -64,7 +150,8 @@ static int get_stat_idx(plat_local_state_t local_state, int pwr_lvl)
  * the target power level (end_pwrlvl).
  *
  * Then, for each level (apart from the CPU level) until the 'end_pwrlvl', it
- * updates the `last_cpu_in_non_cpu_pd[]` with last power down cpu id.
+ * updates the `last_cpu_in_non_cpu_pd[]` with last power down cpu id. If
+ * ENABLE_PSCI_STAT_HIST is set, it also records the start of the power down.
  *
  * This function will only be invoked with data cache enabled and while
  * powering down a core.
@@ -77,6 +164,10 @@ void psci_stats_update_pwr_down(unsigned int end_pwrlvl,
 	assert(end_pwrlvl <= PLAT_MAX_PWR_LVL);
 	assert(state_info);
 
+#if ENABLE_PSCI_STAT_HIST
+	psci_cpu_hist[cpu_idx].pwr_down_ts = read_cntpct_el0();
+#endif
+
 	parent_idx = psci_cpu_pd_nodes[cpu_idx].parent_node;
 
 	for (lvl = PSCI_CPU_PWR_LVL + 1; lvl <= end_pwrlvl; lvl++) {
@@ -108,6 +199,9 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 	int stat_idx;
 	plat_local_state_t local_state;
 	u_register_t residency;
+#if ENABLE_PSCI_STAT_HIST
+	u_register_t cpu_residency;
+#endif
 
 	assert(end_pwrlvl <= PLAT_MAX_PWR_LVL);
 	assert(state_info);
@@ -124,6 +218,11 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 	psci_cpu_stat[cpu_idx][stat_idx].residency += residency;
 	psci_cpu_stat[cpu_idx][stat_idx].count++;
 
+#if ENABLE_PSCI_STAT_HIST
+	psci_hist_add(&psci_cpu_hist[cpu_idx].residency[stat_idx], residency);
+	cpu_residency = residency;
+#endif
+
 	/*
 	 * Check what power domains above CPU were off
 	 * prior to this CPU powering on.
@@ -152,21 +251,35 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 		psci_non_cpu_stat[parent_idx][stat_idx].residency += residency;
 		psci_non_cpu_stat[parent_idx][stat_idx].count++;
 
+#if ENABLE_PSCI_STAT_HIST
+		psci_hist_add(&psci_non_cpu_hist[parent_idx][stat_idx],
+			      residency);
+#endif
+
 		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 	}
 
+#if ENABLE_PSCI_STAT_HIST
+	/* `lvl - 1` is the highest power level this CPU woke up from */
+	psci_stats_update_latency(cpu_idx, lvl - 1,
+		get_stat_idx(state_info->pwr_domain_state[lvl - 1], lvl - 1),
+		cpu_residency);
+#endif
 }
 
 /*******************************************************************************
- * This function returns the appropriate count and residency time of the
- * local state for the highest power level expressed in the `power_state`
- * for the node represented by `target_cpu`.
+ * This function finds the node and the index into the stats arrays of the
+ * local state for the highest power level expressed in the `power_state` for
+ * the node represented by `target_cpu`. `*node_idx` is the index of the cpu if
+ * `*pwrlvl` is the CPU power level or the index of its ancestor at `*pwrlvl`
+ * otherwise.
  ******************************************************************************/
-static int psci_get_stat(u_register_t target_cpu, unsigned int power_state,
-			 psci_stat_t *psci_stat)
+static int psci_get_stat_node(u_register_t target_cpu, unsigned int power_state,
+			      unsigned int *pwrlvl, unsigned int *node_idx,
+			      int *stat_idx)
 {
 	int rc;
-	unsigned int pwrlvl, lvl, parent_idx, stat_idx, target_idx;
+	unsigned int lvl, parent_idx, target_idx;
 	psci_power_state_t state_info = { {PSCI_LOCAL_STATE_RUN} };
 	plat_local_state_t local_state;
 
@@ -186,27 +299,52 @@ static int psci_get_stat(u_register_t target_cpu, unsigned int power_state,
 		return PSCI_E_INVALID_PARAMS;
 
 	/* Find the highest power level */
-	pwrlvl = psci_find_target_suspend_lvl(&state_info);
-	if (pwrlvl == PSCI_INVALID_PWR_LVL) {
+	*pwrlvl = psci_find_target_suspend_lvl(&state_info);
+	if (*pwrlvl == PSCI_INVALID_PWR_LVL) {
 		ERROR("Invalid target power level for PSCI statistics operation\n");
 		panic();
 	}
 
 	/* Get the index into the stats array */
-	local_state = state_info.pwr_domain_state[pwrlvl];
-	stat_idx = get_stat_idx(local_state, pwrlvl);
+	local_state = state_info.pwr_domain_state[*pwrlvl];
+	*stat_idx = get_stat_idx(local_state, *pwrlvl);
 
-	if (pwrlvl > PSCI_CPU_PWR_LVL) {
+	if (*pwrlvl > PSCI_CPU_PWR_LVL) {
 		/* Get the power domain index */
 		parent_idx = psci_cpu_pd_nodes[target_idx].parent_node;
-		for (lvl = PSCI_CPU_PWR_LVL + 1; lvl < pwrlvl; lvl++)
+		for (lvl = PSCI_CPU_PWR_LVL + 1; lvl < *pwrlvl; lvl++)
 			parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 
+		*node_idx = parent_idx;
+	} else {
+		*node_idx = target_idx;
+	}
+
+	return PSCI_E_SUCCESS;
+}
+
+/*******************************************************************************
+ * This function returns the appropriate count and residency time of the
+ * local state for the highest power level expressed in the `power_state`
+ * for the node represented by `target_cpu`.
+ ******************************************************************************/
+static int psci_get_stat(u_register_t target_cpu, unsigned int power_state,
+			 psci_stat_t *psci_stat)
+{
+	int rc, stat_idx;
+	unsigned int pwrlvl, node_idx;
+
+	rc = psci_get_stat_node(target_cpu, power_state, &pwrlvl, &node_idx,
+				&stat_idx);
+	if (rc != PSCI_E_SUCCESS)
+		return rc;
+
+	if (pwrlvl > PSCI_CPU_PWR_LVL) {
 		/* Get the non cpu power domain stats */
-		*psci_stat = psci_non_cpu_stat[parent_idx][stat_idx];
+		*psci_stat = psci_non_cpu_stat[node_idx][stat_idx];
 	} else {
 		/* Get the cpu power domain stats */
-		*psci_stat = psci_cpu_stat[target_idx][stat_idx];
+		*psci_stat = psci_cpu_stat[node_idx][stat_idx];
 	}
 
 	return PSCI_E_SUCCESS;
@@ -237,3 +375,48 @@ u_register_t psci_stat_count(u_register_t target_cpu,
 	else
 		return 0;
 }
+
+#if ENABLE_PSCI_STAT_HIST
+/*******************************************************************************
+ * This is the top level function for the PSCI_STAT_HIST SiP call. It returns
+ * the count of `bucket` in the histogram `hist` of the local state for the
+ * highest power level expressed in the `power_state`, for the node represented
+ * by `target_cpu`. The latency histograms are those of `target_cpu`, for the
+ * transitions in which that power level was the highest one entered.
+ ******************************************************************************/
+u_register_t psci_stat_hist(u_register_t target_cpu, unsigned int power_state,
+			    unsigned int hist, unsigned int bucket)
+{
+	int stat_idx;
+	unsigned int pwrlvl, node_idx, target_idx;
+	const psci_stat_hist_t *stat_hist;
+
+	if (bucket >= PSCI_STAT_HIST_BUCKETS)
+		return 0;
+
+	if (psci_get_stat_node(target_cpu, power_state, &pwrlvl, &node_idx,
+			       &stat_idx) != PSCI_E_SUCCESS)
+		return 0;
+
+	target_idx = plat_core_pos_by_mpidr(target_cpu);
+
+	switch (hist) {
+	case PSCI_STAT_HIST_RESIDENCY:
+		if (pwrlvl > PSCI_CPU_PWR_LVL)
+			stat_hist = &psci_non_cpu_hist[node_idx][stat_idx];
+		else
+			stat_hist = &psci_cpu_hist[node_idx].residency[stat_idx];
+		break;
+	case PSCI_STAT_HIST_ENTRY_LATENCY:
+		stat_hist = &psci_cpu_hist[target_idx].entry_lat[pwrlvl][stat_idx];
+		break;
+	case PSCI_STAT_HIST_EXIT_LATENCY:
+		stat_hist = &psci_cpu_hist[target_idx].exit_lat[pwrlvl][stat_idx];
+		break;
+	default:
+		return 0;
+	}
+
+	return stat_hist->count[bucket];
+}
+#endif /* ENABLE_PSCI_STAT_HIST */
@@ -80,6 +80,14 @@ static void psci_suspend_to_pwrdown_start(unsigned int end_pwrlvl,
 	if (psci_spd_pm && psci_spd_pm->svc_suspend)
 		psci_spd_pm->svc_suspend(max_off_lvl);
 
+#if CTX_LAZY_FPREGS
+	/*
+	 * Save the floating point context which is still live in the FP/SIMD
+	 * registers as they will be lost when the CPU is powered down.
+	 */
+	cm_fpregs_context_save_live();
+#endif
+
 #if !HW_ASSISTED_COHERENCY
 	/*
 	 * Plat. management: Allow the platform to perform any early
@@ -146,6 +154,7 @@ void psci_cpu_suspend_start(entry_point_info_t *ep,
 {
 	int skip_wfi = 0;
 	unsigned int idx = plat_my_core_pos();
+	unsigned int lock_pwrlvl = end_pwrlvl;
 
 	/*
 	 * This function must only be called on platforms where the
@@ -154,6 +163,23 @@ void psci_cpu_suspend_start(entry_point_info_t *ep,
 	assert(psci_plat_pm_ops->pwr_domain_suspend &&
 			psci_plat_pm_ops->pwr_domain_suspend_finish);
 
+#if PSCI_INCREMENTAL_LOCKING
+	/* No lock is held yet, so a pending interrupt can be checked now */
+	if (read_isr_el1()) {
+		skip_wfi = 1;
+		lock_pwrlvl = PSCI_CPU_PWR_LVL;
+		goto exit;
+	}
+
+	/*
+	 * This function is passed the requested state info and it returns
+	 * the negotiated state info for each power level upto the end level
+	 * specified. It acquires the locks only up to the first level that
+	 * stays at RUN, and returns that level.
+	 */
+	lock_pwrlvl = psci_do_state_coordination_locked(end_pwrlvl,
+							state_info);
+#else
 	/*
 	 * This function acquires the lock corresponding to each power
 	 * level so that by the time all locks are taken, the system topology
@@ -178,12 +204,17 @@ void psci_cpu_suspend_start(entry_point_info_t *ep,
 	 * the end level specified.
 	 */
 	psci_do_state_coordination(end_pwrlvl, state_info);
+#endif
 
 #if ENABLE_PSCI_STAT
 	/* Update the last cpu for each level till end_pwrlvl */
 	psci_stats_update_pwr_down(end_pwrlvl, state_info);
 #endif
 
+#if ENABLE_RUNTIME_TRACE
+	psci_trace_pwr_event(RUNTIME_TRACE_PWR_DOWN, end_pwrlvl, state_info);
+#endif
+
 	if (is_power_down_state)
 		psci_suspend_to_pwrdown_start(end_pwrlvl, ep, state_info);
 
@@ -204,7 +235,7 @@ exit:
 	 * Release the locks corresponding to each power level in the
 	 * reverse order to which they were acquired.
 	 */
-	psci_release_pwr_domain_locks(end_pwrlvl,
+	psci_release_pwr_domain_locks(lock_pwrlvl,
 				  idx);
 	if (skip_wfi)
 		return;
@@ -249,9 +280,14 @@ exit:
 
 #if ENABLE_PSCI_STAT
 	plat_psci_stat_accounting_stop(state_info);
+	psci_stats_mark_wakeup();
 	psci_stats_update_pwr_up(end_pwrlvl, state_info);
 #endif
 
+#if ENABLE_RUNTIME_TRACE
+	psci_trace_pwr_event(RUNTIME_TRACE_PWR_UP, end_pwrlvl, state_info);
+#endif
+
 #if ENABLE_RUNTIME_INSTRUMENTATION
 	PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
 	    RT_INSTR_EXIT_HW_LOW_PWR,
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <assert.h>
+#include <cassert.h>
+#include <ep_info.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <runtime_trace.h>
+#include <smcc.h>
+
+/*******************************************************************************
+ * The runtime trace region, provided by the platform in Non-secure memory, is
+ * split into one ring of records per cpu. Each cpu is the only writer of its
+ * ring, so recording an event needs no lock. The position of the next record
+ * is kept in secure memory so that the normal world, which may map the region
+ * to drain it, cannot make BL31 write outside of the region.
+ ******************************************************************************/
+#define RT_TRACE_RING_SIZE	((PLAT_RUNTIME_TRACE_SIZE / PLATFORM_CORE_COUNT) \
+				 & ~(CACHE_WRITEBACK_GRANULE - 1))
+#define RT_TRACE_NUM_RECS	((RT_TRACE_RING_SIZE - \
+				  RUNTIME_TRACE_RECS_OFFSET) / \
+				 sizeof(runtime_trace_rec_t))
+
+CASSERT((PLAT_RUNTIME_TRACE_BASE & (CACHE_WRITEBACK_GRANULE - 1)) == 0,
+	assert_runtime_trace_base_not_cacheline_aligned);
+CASSERT(sizeof(runtime_trace_hdr_t) <= RUNTIME_TRACE_RECS_OFFSET,
+	assert_runtime_trace_hdr_too_big);
+CASSERT(RT_TRACE_RING_SIZE > RUNTIME_TRACE_RECS_OFFSET,
+	assert_runtime_trace_size_too_small);
+
+typedef struct rt_trace_cpu {
+	/* Number of records written */
+	uint64_t head;
+	/* Slot of the next record */
+	uint64_t slot;
+} __aligned(CACHE_WRITEBACK_GRANULE) rt_trace_cpu_t;
+
+static rt_trace_cpu_t rt_trace_cpus[PLATFORM_CORE_COUNT];
+static unsigned int rt_trace_ready;
+
+static runtime_trace_hdr_t *get_ring(unsigned int cpu_idx)
+{
+	return (runtime_trace_hdr_t *)(PLAT_RUNTIME_TRACE_BASE +
+					cpu_idx * RT_TRACE_RING_SIZE);
+}
+
+static void rt_trace_write(unsigned long long ts, unsigned int event,
+			   unsigned int info, uint32_t data)
+{
+	unsigned int cpu_idx;
+	runtime_trace_hdr_t *ring;
+	runtime_trace_rec_t *rec;
+	rt_trace_cpu_t *cpu;
+
+	/*
+	 * The region is mapped as cacheable memory, so don't write to it with
+	 * the data cache disabled, e.g. late in the power down sequence.
+	 */
+	if (!rt_trace_ready || !(read_sctlr_el3() & SCTLR_C_BIT))
+		return;
+
+	cpu_idx = plat_my_core_pos();
+	assert(cpu_idx < PLATFORM_CORE_COUNT);
+
+	cpu = &rt_trace_cpus[cpu_idx];
+	ring = get_ring(cpu_idx);
+	rec = (runtime_trace_rec_t *)((uintptr_t)ring +
+			RUNTIME_TRACE_RECS_OFFSET) + cpu->slot;
+
+	rec->timestamp = ts;
+	rec->data = data;
+	rec->event = event;
+	rec->info = info;
+
+	/* Publish the record only once it has been written */
+	dmbishst();
+	ring->head = ++cpu->head;
+
+	if (++cpu->slot == RT_TRACE_NUM_RECS)
+		cpu->slot = 0;
+}
+
+/*******************************************************************************
+ * Record an event of the calling cpu.
+ ******************************************************************************/
+void runtime_trace_event(unsigned int event, unsigned int info, uint32_t data)
+{
+	rt_trace_write(read_cntpct_el0(), event, info, data);
+}
+
+/*******************************************************************************
+ * Called from the SMC handler on the runtime stack once the handler of the SMC
+ * `smc_fid` has returned. `start` is the value of the system counter when the
+ * SMC was dispatched and `flags` the flags passed to the handler. The entry of
+ * the SMC is therefore recorded after the events which occurred while it was
+ * handled.
+ ******************************************************************************/
+void runtime_trace_smc(uint32_t smc_fid, unsigned long long start,
+		       unsigned int flags)
+{
+	rt_trace_write(start, RUNTIME_TRACE_SMC_ENTRY,
+		       is_caller_non_secure(flags) ? NON_SECURE : SECURE,
+		       smc_fid);
+	runtime_trace_event(RUNTIME_TRACE_SMC_EXIT, 0, smc_fid);
+}
+
+/*******************************************************************************
+ * Called from the interrupt exception handler for an interrupt of `type`.
+ ******************************************************************************/
+void runtime_trace_intr(uint32_t type)
+{
+	runtime_trace_event(RUNTIME_TRACE_INTR_ENTRY, 0, type);
+}
+
+/*******************************************************************************
+ * Initialise the rings of all cpus. This must be called by the primary cpu
+ * before the secondary cpus are powered on.
+ ******************************************************************************/
+void runtime_trace_init(void)
+{
+	unsigned int cpu_idx;
+	runtime_trace_hdr_t *ring;
+
+	for (cpu_idx = 0; cpu_idx < PLATFORM_CORE_COUNT; cpu_idx++) {
+		ring = get_ring(cpu_idx);
+
+		ring->magic = RUNTIME_TRACE_MAGIC;
+		ring->version = RUNTIME_TRACE_VERSION;
+		ring->rec_size = sizeof(runtime_trace_rec_t);
+		ring->ring_size = RT_TRACE_RING_SIZE;
+		ring->cpu = cpu_idx;
+		ring->num_recs = RT_TRACE_NUM_RECS;
+		ring->cntfrq = read_cntfrq_el0();
+		ring->head = 0;
+
+		rt_trace_cpus[cpu_idx].head = 0;
+		rt_trace_cpus[cpu_idx].slot = 0;
+	}
+
+	dmbishst();
+	rt_trace_ready = 1;
+}
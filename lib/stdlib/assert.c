@@ -12,25 +12,32 @@
 /*
 * Only print the output if PLAT_LOG_LEVEL_ASSERT is higher or equal to
 * LOG_LEVEL_INFO, which is the default value for builds with DEBUG=1.
+* With ENABLE_CONSOLE_BUFFER, the output buffered by the cpu is printed first.
 */
 
 #if PLAT_LOG_LEVEL_ASSERT >= LOG_LEVEL_VERBOSE
 void __assert(const char *file, unsigned int line, const char *assertion)
 {
+	console_buffer_sync_start();
 	tf_printf("ASSERT: %s:%d:%s\n", file, line, assertion);
 	console_flush();
+	console_buffer_sync_end();
 	plat_panic_handler();
 }
 #elif PLAT_LOG_LEVEL_ASSERT >= LOG_LEVEL_INFO
 void __assert(const char *file, unsigned int line)
 {
+	console_buffer_sync_start();
 	tf_printf("ASSERT: %s:%d\n", file, line);
 	console_flush();
+	console_buffer_sync_end();
 	plat_panic_handler();
 }
 #else
 void __assert(void)
 {
+	console_buffer_drain();
+	console_flush();
 	plat_panic_handler();
 }
 #endif
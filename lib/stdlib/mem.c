@@ -6,6 +6,11 @@
 
 #include <stddef.h> /* size_t */
 
+/*
+ * When USE_ASM_MEM_FUNCS is set, memset, memcmp, memcpy and memmove are
+ * provided by the architecture specific implementations in memfuncs.S.
+ */
+#if !USE_ASM_MEM_FUNCS
 /*
  * Fill @count bytes of memory pointed to by @dst with @val
  */
@@ -79,6 +84,7 @@ void *memmove(void *dst, const void *src, size_t len)
 	}
 	return dst;
 }
+#endif /* !USE_ASM_MEM_FUNCS */
 
 /*
  * Scan @len bytes of @src for value @c
@@ -15,7 +15,11 @@
 int putchar(int c)
 {
 	int res;
+#if ENABLE_CONSOLE_BUFFER && defined(IMAGE_BL31)
+	if (console_buffer_putc((unsigned char)c) >= 0)
+#else
 	if (console_putc((unsigned char)c) >= 0)
+#endif
 		res = c;
 	else
 		res = EOF;
@@ -19,7 +19,8 @@ STDLIB_SRCS	:=	$(addprefix lib/stdlib/,	\
 			strncmp.c			\
 			strnlen.c			\
 			subr_prf.c			\
-			timingsafe_bcmp.c)
+			timingsafe_bcmp.c		\
+			${ARCH}/memfuncs.S)
 
 INCLUDES	+=	-Iinclude/lib/stdlib		\
 			-Iinclude/lib/stdlib/sys
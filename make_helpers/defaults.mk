@@ -27,6 +27,10 @@ ARM_GIC_ARCH			:= 2
 # Flag used to indicate if ASM_ASSERTION should be enabled for the build.
 ASM_ASSERTION			:= 0
 
+# Flag to skip the signature checks of certificates whose exact contents have
+# already been authenticated by the current boot stage
+AUTH_IMAGE_CACHE		:= 0
+
 # Base commit to perform code check on
 BASE_COMMIT			:= origin/master
 
@@ -44,21 +48,40 @@ CTX_INCLUDE_AARCH32_REGS	:= 1
 # Include FP registers in cpu context
 CTX_INCLUDE_FPREGS		:= 0
 
+# Switch the FP registers in cpu context lazily, on first use after a world
+# switch
+CTX_LAZY_FPREGS			:= 0
+
 # Debug build
 DEBUG				:= 0
 
 # Build platform
 DEFAULT_PLAT			:= fvp
 
+# Flag to buffer the runtime console output of BL31 in per-cpu rings
+ENABLE_CONSOLE_BUFFER		:= 0
+
+# Flag to print the time taken to load and authenticate each image
+ENABLE_IMAGE_LOAD_TIMING	:= 0
+
 # Flag to enable Performance Measurement Framework
 ENABLE_PMF			:= 0
 
 # Flag to enable PSCI STATs functionality
 ENABLE_PSCI_STAT		:= 0
 
+# Flag to enable residency and latency histograms on top of the PSCI STATs
+ENABLE_PSCI_STAT_HIST		:= 0
+
 # Flag to enable runtime instrumentation using PMF
 ENABLE_RUNTIME_INSTRUMENTATION	:= 0
 
+# Flag to enable recording of EL3 events in a per-cpu trace buffer
+ENABLE_RUNTIME_TRACE		:= 0
+
+# Flag to enable per-cpu histograms of the SMC handling latency using PMF
+ENABLE_SMC_LATENCY_HIST		:= 0
+
 # Flag to enable stack corruption protection
 ENABLE_STACK_PROTECTOR		:= 0
 
@@ -84,6 +107,12 @@ HW_ASSISTED_COHERENCY		:= 0
 # Flag to enable new version of image loading
 LOAD_IMAGE_V2			:= 0
 
+# Use the arena allocator for the mbed TLS heap and report its use
+MBEDTLS_HEAP_ARENA		:= 0
+
+# Keep the public keys parsed by mbed TLS between signature verifications
+MBEDTLS_PK_CACHE		:= 0
+
 # NS timer register save and restore
 NS_TIMER_SWITCH			:= 0
 
@@ -98,9 +127,15 @@ PROGRAMMABLE_RESET_ADDRESS	:= 0
 # Original format.
 PSCI_EXTENDED_STATE_ID		:= 0
 
+# Acquire the PSCI power domain locks only as far up as state coordination needs
+PSCI_INCREMENTAL_LOCKING	:= 0
+
 # By default, BL1 acts as the reset handler, not BL31
 RESET_TO_BL31			:= 0
 
+# Flag to route registered SMC function ids directly to their leaf handlers
+RT_SVC_FAST_DISPATCH		:= 0
+
 # For Chain of Trust
 SAVE_KEYS			:= 0
 
@@ -115,15 +150,26 @@ SPD				:= none
 # image. This is meant to help debugging the post-BL2 phase.
 SPIN_ON_BL1_EXIT		:= 0
 
+# Flag to calculate the hash of images authenticated by hash while they are
+# loaded, instead of in a second pass over the loaded image
+STREAM_IMAGE_HASH		:= 0
+
 # Flags to build TF with Trusted Boot support
 TRUSTED_BOARD_BOOT		:= 0
 
 # Build option to choose whether Trusted firmware uses Coherent memory or not.
 USE_COHERENT_MEM		:= 1
 
+# Use the architecture specific assembly implementations of memcpy, memmove,
+# memset and memcmp instead of the generic C ones
+USE_ASM_MEM_FUNCS		:= 0
+
 # Use tbbr_oid.h instead of platform_oid.h
 USE_TBBR_DEFS			= $(ERROR_DEPRECATED)
 
+# Use ticket locks instead of test-and-set locks for spin_lock()
+USE_TICKET_SPINLOCKS		:= 0
+
 # Build verbosity
 V				:= 0
 
@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
+#include <arch_helpers.h>
 #include <assert.h>
 #include <debug.h>
 #include <firmware_image_package.h>
@@ -14,6 +15,15 @@
 #include <string.h>
 #include <utils.h>
 
+/*
+ * Largest part of an image prefetched from the memory mapped FIP while the
+ * previous image is authenticated. Platforms may override it in
+ * platform_def.h.
+ */
+#ifndef PLAT_ARM_PREFETCH_MAX_SIZE
+#define PLAT_ARM_PREFETCH_MAX_SIZE	0x40000
+#endif
+
 /* IO devices */
 static const io_dev_connector_t *fip_dev_con;
 static uintptr_t fip_dev_handle;
@@ -303,6 +313,40 @@ int plat_get_image_source(unsigned int image_id, uintptr_t *dev_handle,
 	return result;
 }
 
+#if LOAD_IMAGE_V2 && defined(IMAGE_BL2)
+/*
+ * The FIP is memory mapped, so ask the CPU to start reading the next image
+ * into its caches while the current one is authenticated. At most
+ * PLAT_ARM_PREFETCH_MAX_SIZE bytes are prefetched, so that the image does not
+ * evict itself. The hints have no effect when the FIP is mapped as Device
+ * memory.
+ */
+void plat_prefetch_image(unsigned int image_id)
+{
+	const struct plat_io_policy *policy;
+	size_t offset, length;
+	uintptr_t addr, end;
+
+	assert(image_id < ARRAY_SIZE(policies));
+
+	policy = &policies[image_id];
+	if (policy->dev_handle != &fip_dev_handle)
+		return;
+
+	/* This initialises the FIP device and caches its ToC for the load */
+	if ((open_fip(policy->image_spec) != 0) ||
+	    (fip_get_file_region(policy->image_spec, &offset, &length) != 0))
+		return;
+
+	addr = PLAT_ARM_FIP_BASE + offset;
+	end = addr + MIN(length, (size_t)PLAT_ARM_PREFETCH_MAX_SIZE);
+
+	for (addr = round_down(addr, CACHE_WRITEBACK_GRANULE); addr < end;
+	     addr += CACHE_WRITEBACK_GRANULE)
+		prefetch_dcache_line(addr);
+}
+#endif /* LOAD_IMAGE_V2 && IMAGE_BL2 */
+
 /*
  * See if a Firmware Image Package is available,
  * by checking if TOC is valid or not.
@@ -8,6 +8,7 @@
 #include <debug.h>
 #include <plat_arm.h>
 #include <pmf.h>
+#include <psci.h>
 #include <runtime_svc.h>
 #include <stdint.h>
 #include <uuid.h>
@@ -48,6 +49,24 @@ static uintptr_t arm_sip_handler(unsigned int smc_fid,
 				handle, flags);
 	}
 
+#if ENABLE_PSCI_STAT_HIST
+	/* Return the count of a PSCI stat histogram bucket */
+	if (is_psci_stat_hist_fid(smc_fid)) {
+		if (smc_fid == PSCI_STAT_HIST_AARCH32) {
+			x1 = (uint32_t)x1;
+			x2 = (uint32_t)x2;
+			x3 = (uint32_t)x3;
+			x4 = (uint32_t)x4;
+		} else if (smc_fid != PSCI_STAT_HIST_AARCH64) {
+			WARN("Unimplemented ARM SiP Service Call: 0x%x \n",
+			     smc_fid);
+			SMC_RET1(handle, SMC_UNK);
+		}
+
+		SMC_RET1(handle, psci_stat_hist(x1, x2, x3, x4));
+	}
+#endif
+
 	switch (smc_fid) {
 	case ARM_SIP_SVC_EXE_STATE_SWITCH: {
 		u_register_t pc;
@@ -76,6 +95,11 @@ static uintptr_t arm_sip_handler(unsigned int smc_fid,
 		/* State switch call */
 		call_count += 1;
 
+#if ENABLE_PSCI_STAT_HIST
+		/* PSCI stat histogram calls */
+		call_count += PSCI_STAT_HIST_NUM_CALLS;
+#endif
+
 		SMC_RET1(handle, call_count);
 
 	case ARM_SIP_SVC_UID:
@@ -93,6 +117,15 @@ static uintptr_t arm_sip_handler(unsigned int smc_fid,
 
 }
 
+/*
+ * PMF timestamp queries do not need to go through arm_sip_handler(). Register
+ * the PMF SMC handler as their leaf handler. It only reads the timestamps and
+ * returns them in registers, so it can be a light one.
+ */
+DECLARE_RT_SVC_FID_LIGHT(pmf_get_ts_32, PMF_SMC_GET_TIMESTAMP_32,
+		pmf_smc_handler);
+DECLARE_RT_SVC_FID_LIGHT(pmf_get_ts_64, PMF_SMC_GET_TIMESTAMP_64,
+		pmf_smc_handler);
 
 /* Define a runtime service descriptor for fast SMC calls */
 DECLARE_RT_SVC(
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <platform.h>
+
+/*
+ * The following platform functions are weakly defined. They
+ * provide typical implementations that may be re-used by
+ * multiple platforms but may also be overridden by a platform.
+ */
+#if LOAD_IMAGE_V2
+#pragma weak plat_prefetch_image
+
+/*
+ * Default hook to start fetching an image ahead of its load. It does nothing,
+ * the image is read when it is loaded.
+ */
+void plat_prefetch_image(unsigned int image_id)
+{
+}
+#endif /* LOAD_IMAGE_V2 */
@@ -45,3 +45,10 @@ endif
 
 $(eval $(call assert_boolean,TSP_NS_INTR_ASYNC_PREEMPT))
 $(eval $(call add_define,TSP_NS_INTR_ASYNC_PREEMPT))
+
+# Flag used to only save the Secure EL1 system registers that the TSP may modify
+# while servicing a request when it returns the result to the normal world.
+TSPD_LAZY_EL1_SYSREGS		:=	0
+
+$(eval $(call assert_boolean,TSPD_LAZY_EL1_SYSREGS))
+$(eval $(call add_define,TSPD_LAZY_EL1_SYSREGS))
@@ -19,9 +19,12 @@
 #include <bl31.h>
 #include <bl_common.h>
 #include <context_mgmt.h>
+#include <cpu_data.h>
 #include <debug.h>
 #include <errno.h>
 #include <platform.h>
+#include <pmf.h>
+#include <runtime_instr.h>
 #include <runtime_svc.h>
 #include <stddef.h>
 #include <string.h>
@@ -502,6 +505,18 @@ uint64_t tspd_smc_handler(uint32_t smc_fid,
 			if (get_yield_smc_active_flag(tsp_ctx->state))
 				SMC_RET1(handle, SMC_UNK);
 
+#if ENABLE_RUNTIME_INSTRUMENTATION
+			/*
+			 * Record the time at which the request entered EL3 so
+			 * that the cost of the round trip through the TSP,
+			 * including the world switches, can be measured.
+			 */
+			PMF_WRITE_TIMESTAMP(rt_instr_svc,
+			    RT_INSTR_ENTER_SPD_SMC,
+			    PMF_NO_CACHE_MAINT,
+			    get_cpu_data(cpu_data_pmf_ts[CPU_DATA_PMF_TS0_IDX]));
+#endif
+
 			cm_el1_sysregs_context_save(NON_SECURE);
 
 			/* Save x1 and x2 for use by TSP_GET_ARGS call below */
@@ -553,7 +568,12 @@ uint64_t tspd_smc_handler(uint32_t smc_fid,
 			 * and return to the non-secure state.
 			 */
 			assert(handle == cm_get_context(SECURE));
+#if TSPD_LAZY_EL1_SYSREGS
+			cm_el1_sysregs_context_save_groups(SECURE,
+						TSPD_SMC_EL1_SYSREGS);
+#else
 			cm_el1_sysregs_context_save(SECURE);
+#endif
 
 			/* Get a reference to the non-secure context */
 			ns_cpu_context = cm_get_context(NON_SECURE);
@@ -574,6 +594,12 @@ uint64_t tspd_smc_handler(uint32_t smc_fid,
 #endif
 			}
 
+#if ENABLE_RUNTIME_INSTRUMENTATION
+			PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
+			    RT_INSTR_EXIT_SPD_SMC,
+			    PMF_NO_CACHE_MAINT);
+#endif
+
 			SMC_RET3(ns_cpu_context, x1, x2, x3);
 		}
 
@@ -71,6 +71,16 @@
  ******************************************************************************/
 #define TSP_MIGRATE_INFO		TSP_TYPE_MP
 
+/*******************************************************************************
+ * Groups of Secure EL1 system registers that the TSP may modify while servicing
+ * a fast or yielding SMC. The TSP programs its translation regime and vector
+ * table during its initialisation and CPU_ON/resume entries, which are always
+ * followed by a full save of the context, so the remaining groups do not need
+ * to be saved when the TSP returns the result of a request.
+ ******************************************************************************/
+#define TSPD_SMC_EL1_SYSREGS	(CTX_EL1_SYSREGS_VOLATILE |		\
+				 CTX_EL1_SYSREGS_THREAD)
+
 /*******************************************************************************
  * Number of cpus that the present on this platform. TODO: Rely on a topology
  * tree to determine this in the future to avoid assumptions about mpidr
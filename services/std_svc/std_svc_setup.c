@@ -102,6 +102,48 @@ uintptr_t std_svc_smc_handler(uint32_t smc_fid,
 	}
 }
 
+#if RT_SVC_FAST_DISPATCH && !ENABLE_RUNTIME_INSTRUMENTATION
+/*
+ * Leaf handlers for the PSCI discovery calls, which are frequently issued by
+ * the normal world. They are bypassed when runtime instrumentation is enabled
+ * so that every PSCI call is timestamped by std_svc_smc_handler().
+ */
+static uintptr_t std_svc_psci_version_handler(uint32_t smc_fid,
+			     u_register_t x1,
+			     u_register_t x2,
+			     u_register_t x3,
+			     u_register_t x4,
+			     void *cookie,
+			     void *handle,
+			     u_register_t flags)
+{
+	if (is_caller_secure(flags))
+		SMC_RET1(handle, SMC_UNK);
+
+	SMC_RET1(handle, psci_version());
+}
+
+static uintptr_t std_svc_psci_features_handler(uint32_t smc_fid,
+			     u_register_t x1,
+			     u_register_t x2,
+			     u_register_t x3,
+			     u_register_t x4,
+			     void *cookie,
+			     void *handle,
+			     u_register_t flags)
+{
+	if (is_caller_secure(flags))
+		SMC_RET1(handle, SMC_UNK);
+
+	SMC_RET1(handle, psci_features((uint32_t)x1));
+}
+
+DECLARE_RT_SVC_FID_LIGHT(psci_version, PSCI_VERSION,
+		std_svc_psci_version_handler);
+DECLARE_RT_SVC_FID_LIGHT(psci_features, PSCI_FEATURES,
+		std_svc_psci_features_handler);
+#endif
+
 /* Register Standard Service Calls as runtime service */
 DECLARE_RT_SVC(
 		std_svc,
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "host_io.h"
+
+host_io_stats_t host_io_stats;
+
+static unsigned char *storage;
+static size_t storage_size;
+
+/* The single open file of the io device */
+static struct {
+	int in_use;
+	size_t base;
+	size_t size;
+	size_t pos;
+} file;
+
+#define HOST_IO_ERROR(...)						\
+	do {								\
+		printf("host_io: ");					\
+		printf(__VA_ARGS__);					\
+		putchar('\n');						\
+		host_io_stats.errors++;					\
+	} while (0)
+
+void host_io_init(void *mem, size_t size)
+{
+	storage = mem;
+	storage_size = size;
+	memset(&host_io_stats, 0, sizeof(host_io_stats));
+}
+
+static io_type_t host_dev_type(void)
+{
+	return IO_TYPE_DUMMY;
+}
+
+static int host_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
+			  io_entity_t *entity)
+{
+	const io_block_spec_t *block_spec = (const io_block_spec_t *)spec;
+
+	host_io_stats.opens++;
+
+	if (file.in_use)
+		return -ENOMEM;
+
+	if ((block_spec->offset > storage_size) ||
+	    (block_spec->length > storage_size - block_spec->offset)) {
+		HOST_IO_ERROR("open of %zu bytes at %zu", block_spec->length,
+			      block_spec->offset);
+		return -EINVAL;
+	}
+
+	file.in_use = 1;
+	file.base = block_spec->offset;
+	file.size = block_spec->length;
+	file.pos = 0;
+	entity->info = (uintptr_t)&file;
+	return 0;
+}
+
+static int host_file_seek(io_entity_t *entity, int mode, ssize_t offset)
+{
+	host_io_stats.seeks++;
+
+	if ((mode != IO_SEEK_SET) || (offset < 0) ||
+	    ((size_t)offset >= file.size)) {
+		HOST_IO_ERROR("seek to %zd, mode %d", offset, mode);
+		return -EINVAL;
+	}
+
+	file.pos = offset;
+	return 0;
+}
+
+static int host_file_size(io_entity_t *entity, size_t *length)
+{
+	*length = file.size;
+	return 0;
+}
+
+static int host_file_read(io_entity_t *entity, uintptr_t buffer,
+			  size_t length, size_t *length_read)
+{
+	host_io_stats.reads++;
+	host_io_stats.last_read_size = length;
+
+	if (length > file.size - file.pos) {
+		HOST_IO_ERROR("read of %zu bytes at %zu in a file of %zu",
+			      length, file.pos, file.size);
+		return -EINVAL;
+	}
+
+	memcpy((void *)buffer, storage + file.base + file.pos, length);
+	file.pos += length;
+	*length_read = length;
+	return 0;
+}
+
+static int host_file_write(io_entity_t *entity, const uintptr_t buffer,
+			   size_t length, size_t *length_written)
+{
+	host_io_stats.writes++;
+
+	if (length > file.size - file.pos) {
+		HOST_IO_ERROR("write of %zu bytes at %zu in a file of %zu",
+			      length, file.pos, file.size);
+		return -EINVAL;
+	}
+
+	memcpy(storage + file.base + file.pos, (const void *)buffer, length);
+	file.pos += length;
+	*length_written = length;
+	return 0;
+}
+
+static int host_file_close(io_entity_t *entity)
+{
+	file.in_use = 0;
+	entity->info = 0;
+	return 0;
+}
+
+static const io_dev_funcs_t host_dev_funcs = {
+	.type = host_dev_type,
+	.open = host_file_open,
+	.seek = host_file_seek,
+	.size = host_file_size,
+	.read = host_file_read,
+	.write = host_file_write,
+	.close = host_file_close,
+};
+
+static const io_dev_info_t host_dev_info = {
+	.funcs = &host_dev_funcs,
+};
+
+static int host_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info)
+{
+	*dev_info = (io_dev_info_t *)&host_dev_info;
+	return 0;
+}
+
+static const io_dev_connector_t host_dev_connector = {
+	.dev_open = host_dev_open,
+};
+
+int register_io_dev_host(const io_dev_connector_t **dev_con)
+{
+	int result = io_register_device(&host_dev_info);
+
+	if (result == 0)
+		*dev_con = &host_dev_connector;
+	return result;
+}
+
+/*
+ * The block device transfers whole blocks by DMA, so the requests must be
+ * block aligned in size and in memory.
+ */
+static int check_block_request(int lba, uintptr_t buf, size_t size)
+{
+	if ((lba < 0) || (size == 0) || ((size % HOST_IO_BLOCK_SIZE) != 0) ||
+	    ((buf % HOST_IO_BLOCK_SIZE) != 0) ||
+	    ((size_t)lba * HOST_IO_BLOCK_SIZE + size > storage_size)) {
+		HOST_IO_ERROR("block request: lba %d buf %p size %zu", lba,
+			      (void *)buf, size);
+		return 0;
+	}
+	return 1;
+}
+
+size_t host_io_block_read(int lba, uintptr_t buf, size_t size)
+{
+	host_io_stats.reads++;
+	host_io_stats.last_read_size = size;
+
+	if (!check_block_request(lba, buf, size))
+		return 0;
+
+	memcpy((void *)buf, storage + (size_t)lba * HOST_IO_BLOCK_SIZE, size);
+	return size;
+}
+
+size_t host_io_block_write(int lba, const uintptr_t buf, size_t size)
+{
+	host_io_stats.writes++;
+
+	if (!check_block_request(lba, buf, size))
+		return 0;
+
+	memcpy(storage + (size_t)lba * HOST_IO_BLOCK_SIZE, (const void *)buf,
+	       size);
+	return size;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __HOST_IO_H__
+#define __HOST_IO_H__
+
+#include <io_driver.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Storage emulated in host memory for the tests of the io drivers. It is
+ * accessed either as an io device, which like io_memmap has a single open
+ * file given by an io_block_spec_t within the storage, or through the block
+ * device operations of io_block, which only accept whole block transfers to
+ * and from block aligned buffers. The requests are counted, and the ones the
+ * real devices would reject are reported and counted as errors.
+ */
+
+#define HOST_IO_BLOCK_SIZE	512
+
+typedef struct host_io_stats {
+	unsigned int opens;
+	unsigned int seeks;
+	unsigned int reads;
+	unsigned int writes;
+	size_t last_read_size;
+	unsigned int errors;
+} host_io_stats_t;
+
+extern host_io_stats_t host_io_stats;
+
+/* Use `size` bytes at `mem` as the storage, and reset the statistics */
+void host_io_init(void *mem, size_t size);
+
+int register_io_dev_host(const io_dev_connector_t **dev_con);
+
+/* Block device operations, for io_block_ops_t */
+size_t host_io_block_read(int lba, uintptr_t buf, size_t size);
+size_t host_io_block_write(int lba, const uintptr_t buf, size_t size);
+
+#endif /* __HOST_IO_H__ */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host implementations of the firmware library functions used by the
+ * firmware sources built for the tests.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <sched.h>
+#include <spinlock.h>
+#include <utils.h>
+
+void tf_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+}
+
+int tf_snprintf(char *s, size_t n, const char *fmt, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, fmt);
+	ret = vsnprintf(s, n, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+void zeromem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+void zero_normalmem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+void do_panic(void)
+{
+	printf("PANIC\n");
+	abort();
+}
+
+/* The host tests run with coherent caches */
+void flush_dcache_range(uintptr_t addr, size_t size)
+{
+}
+
+void clean_dcache_range(uintptr_t addr, size_t size)
+{
+}
+
+void inv_dcache_range(uintptr_t addr, size_t size)
+{
+}
+
+void dmbishst(void)
+{
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* The waiters yield, as the tests may run more threads than host cpus */
+void spin_lock(spinlock_t *lock)
+{
+	while (__atomic_exchange_n(&lock->lock, 1, __ATOMIC_ACQUIRE) != 0)
+		sched_yield();
+}
+
+void spin_unlock(spinlock_t *lock)
+{
+	__atomic_store_n(&lock->lock, 0, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __HOST_ARCH_HELPERS_H__
+#define __HOST_ARCH_HELPERS_H__
+
+/*
+ * Replaces the firmware <arch_helpers.h>. The system registers accessed by the
+ * firmware sources built for the tests are emulated by the tests. The cache
+ * maintenance functions have nothing to do on the host and the barriers are
+ * those of the host compiler.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+uint64_t read_scr_el3(void);
+uint64_t read_cptr_el3(void);
+void write_cptr_el3(uint64_t val);
+uint64_t read_tpidr_el3(void);
+uint64_t read_sctlr_el1(void);
+uint64_t read_sctlr_el2(void);
+uint64_t read_sctlr_el3(void);
+uint64_t read_cntpct_el0(void);
+uint64_t read_cntfrq_el0(void);
+void isb(void);
+void dmbishst(void);
+
+void flush_dcache_range(uintptr_t addr, size_t size);
+void clean_dcache_range(uintptr_t addr, size_t size);
+void inv_dcache_range(uintptr_t addr, size_t size);
+
+#endif /* __HOST_ARCH_HELPERS_H__ */
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __HOST_COMPAT_H__
+#define __HOST_COMPAT_H__
+
+/*
+ * Included before every firmware source built for the host tests. It provides
+ * the definitions which the firmware gets from its own C library headers and
+ * which the host C library does not have.
+ */
+#define __dead2			__attribute__((__noreturn__))
+#define __deprecated		__attribute__((__deprecated__))
+#define __printflike(fmtarg, firstvararg)				\
+		__attribute__((__format__ (__printf__, fmtarg, firstvararg)))
+#define __unused		__attribute__((__unused__))
+#define __used			__attribute__((__used__))
+#define __aligned(x)		__attribute__((__aligned__(x)))
+#define __section(x)		__attribute__((__section__(x)))
+
+#endif /* __HOST_COMPAT_H__ */
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __PLATFORM_DEF_H__
+#define __PLATFORM_DEF_H__
+
+/* Platform definitions used by the firmware sources built for the tests */
+#define PLAT_MAX_PWR_LVL	2
+
+#define MAX_IO_DEVICES		4
+#define MAX_IO_HANDLES		8
+#define MAX_IO_BLOCK_DEVICES	2
+
+/* Small enough for the tests to fill the FIP ToC cache */
+#define FIP_TOC_CACHE_ENTRIES	16
+
+/* PSCI topology of the state coordination test: 4 clusters of 4 cpus */
+#define PLATFORM_CLUSTER_COUNT		4
+#define PLATFORM_CORES_PER_CLUSTER	4
+#define PLATFORM_CORE_COUNT		(PLATFORM_CLUSTER_COUNT *	\
+					 PLATFORM_CORES_PER_CLUSTER)
+#define PLAT_NUM_PWR_DOMAINS		(PLATFORM_CORE_COUNT +		\
+					 PLATFORM_CLUSTER_COUNT + 1)
+#define PLAT_MAX_RET_STATE		1
+#define PLAT_MAX_OFF_STATE		2
+
+#define CACHE_WRITEBACK_GRANULE		64
+
+/* Runtime trace region, mapped by the runtime trace test */
+#define PLAT_RUNTIME_TRACE_BASE		0x40000000UL
+#define PLAT_RUNTIME_TRACE_SIZE		0x4000
+
+#endif /* __PLATFORM_DEF_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __HOST_TYPES_H__
+#define __HOST_TYPES_H__
+
+/* Replaces the firmware <types.h> on top of the host C library */
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef uintptr_t u_register_t;
+
+#endif /* __HOST_TYPES_H__ */
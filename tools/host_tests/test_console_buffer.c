@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the buffered runtime console of BL31
+ * (drivers/console/console_buffer.c with ENABLE_CONSOLE_BUFFER=1). The
+ * characters written to the console are kept by the test, which also plays the
+ * role of the cpus and of the data cache enable bit.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <arch.h>
+#include <console.h>
+
+#define CONSOLE_BUFFER_SIZE	1024
+#define DRAIN_LEVEL		(CONSOLE_BUFFER_SIZE / 2)
+
+static char out[4 * CONSOLE_BUFFER_SIZE];
+static unsigned int out_len;
+static unsigned int this_cpu;
+static uint64_t sctlr_el3 = SCTLR_C_BIT;
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+int console_putc(int c)
+{
+	if (out_len < sizeof(out))
+		out[out_len++] = c;
+	return c;
+}
+
+unsigned int plat_my_core_pos(void)
+{
+	return this_cpu;
+}
+
+uint64_t read_sctlr_el3(void)
+{
+	return sctlr_el3;
+}
+
+static void puts_cpu(unsigned int cpu, const char *s)
+{
+	this_cpu = cpu;
+	while (*s != '\0')
+		(void)console_buffer_putc(*s++);
+}
+
+/* Check and forget the characters written to the console */
+static int printed(const char *s)
+{
+	int ok = (out_len == strlen(s)) && (memcmp(out, s, out_len) == 0);
+
+	if (!ok)
+		printf("printed \"%.*s\" instead of \"%s\"\n", out_len, out, s);
+	out_len = 0;
+	return ok;
+}
+
+/* The output is only buffered once started, and with the data cache enabled */
+static void test_start(void)
+{
+	puts_cpu(0, "boot");
+	CHECK(printed("boot"), "output of the cold boot buffered");
+
+	console_buffer_start();
+	puts_cpu(0, "a");
+	CHECK(printed(""), "runtime output not buffered");
+
+	sctlr_el3 = 0;
+	puts_cpu(0, "b");
+	CHECK(printed("b"), "output buffered with the data cache disabled");
+	sctlr_el3 = SCTLR_C_BIT;
+
+	console_buffer_drain();
+	CHECK(printed("a"), "buffered output not drained");
+}
+
+/* Each cpu drains its own ring only */
+static void test_cpus(void)
+{
+	puts_cpu(1, "one");
+	puts_cpu(2, "two");
+
+	this_cpu = 2;
+	console_buffer_drain();
+	CHECK(printed("two"), "cpu 2 drained");
+
+	this_cpu = 1;
+	console_buffer_drain();
+	CHECK(printed("one"), "cpu 1 drained");
+}
+
+/* Synchronous output comes after the buffered output of the cpu */
+static void test_sync(void)
+{
+	puts_cpu(0, "buffered ");
+
+	console_buffer_sync_start();
+	console_buffer_sync_start();
+	puts_cpu(0, "error ");
+	CHECK(printed("buffered error "), "error message out of order");
+	console_buffer_sync_end();
+	puts_cpu(0, "nested ");
+	CHECK(printed("nested "), "nested synchronous output buffered");
+	console_buffer_sync_end();
+
+	puts_cpu(0, "later");
+	CHECK(printed(""), "output after the error message not buffered");
+
+	console_buffer_set_sync(1);
+	puts_cpu(3, "debug");
+	CHECK(printed("debug"), "output buffered while synchronous");
+	console_buffer_set_sync(0);
+
+	this_cpu = 0;
+	console_buffer_drain();
+	CHECK(printed("later"), "output of cpu 0 lost");
+}
+
+/* The characters which do not fit in the ring are dropped and counted */
+static void test_full(void)
+{
+	char expected[CONSOLE_BUFFER_SIZE + 1];
+	unsigned int i;
+
+	this_cpu = 0;
+	for (i = 0; i < CONSOLE_BUFFER_SIZE + 10; i++)
+		(void)console_buffer_putc('a' + i % 26);
+	for (i = 0; i < CONSOLE_BUFFER_SIZE; i++)
+		expected[i] = 'a' + i % 26;
+	expected[CONSOLE_BUFFER_SIZE] = '\0';
+
+	console_buffer_drain();
+	CHECK(printed(expected), "full ring not drained in order");
+
+	console_buffer_drain();
+	CHECK(printed(""), "dropped characters reported twice");
+}
+
+/* SMC returns drain the ring of the cpu from the drain level */
+static void test_smc_return(void)
+{
+	char line[DRAIN_LEVEL + 1];
+	unsigned int i;
+
+	memset(line, 'x', DRAIN_LEVEL - 1);
+	line[DRAIN_LEVEL - 1] = '\0';
+	puts_cpu(0, line);
+	console_buffer_smc_return();
+	CHECK(printed(""), "ring drained below the drain level");
+
+	puts_cpu(0, "y");
+	console_buffer_smc_return();
+	line[DRAIN_LEVEL - 1] = 'y';
+	line[DRAIN_LEVEL] = '\0';
+	CHECK(printed(line), "ring not drained at the drain level");
+
+	/* A full ring of another cpu doesn't drain the one of this cpu */
+	puts_cpu(1, "z");
+	this_cpu = 0;
+	for (i = 0; i < CONSOLE_BUFFER_SIZE; i++)
+		(void)console_buffer_putc('w');
+	this_cpu = 1;
+	console_buffer_smc_return();
+	CHECK(printed(""), "cpu 1 drained on SMC return");
+	this_cpu = 0;
+	console_buffer_smc_return();
+	CHECK(out_len == CONSOLE_BUFFER_SIZE, "%u characters drained", out_len);
+	out_len = 0;
+
+	this_cpu = 1;
+	console_buffer_drain();
+	CHECK(printed("z"), "output of cpu 1 lost");
+}
+
+int main(void)
+{
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	test_start();
+	test_cpus();
+	test_sync();
+	test_full();
+	test_smc_return();
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("console_buffer: all tests passed\n");
+
+	return 0;
+}
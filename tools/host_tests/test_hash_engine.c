@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the software hash engine based on mbed TLS
+ * (drivers/auth/mbedtls/mbedtls_hash_engine.c), used as the crypto module uses
+ * a platform hash engine: the data is streamed in chunks, each chunk being
+ * polled until it has been consumed. The results are compared with the SHA-256
+ * digest calculated by mbed TLS in one go.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <crypto_mod.h>
+#include <mbedtls_common.h>
+#include <mbedtls_hash_engine.h>
+
+/* mbed TLS headers */
+#include <mbedtls/md.h>
+
+#define DATA_SIZE		(256 * 1024 + 3)
+#define DIGEST_SIZE		32
+
+/* DigestInfo of a SHA-256 hash, with and without the NULL parameters */
+#define DIGEST_INFO_SIZE	(19 + DIGEST_SIZE)
+
+static const unsigned char sha256_prefix[] = {
+	0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20
+};
+
+static const unsigned char sha256_prefix_no_params[] = {
+	0x30, 0x2f, 0x30, 0x0b, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x01, 0x04, 0x20
+};
+
+static const unsigned char sha1_prefix[] = {
+	0x30, 0x21, 0x30, 0x09, 0x06, 0x05, 0x2b, 0x0e, 0x03, 0x02,
+	0x1a, 0x05, 0x00, 0x04, 0x14
+};
+
+static const unsigned int chunk_sizes[] = {
+	1, 7, 64, 1000, 4095, 4096, 4097, 65536, DATA_SIZE
+};
+
+static const crypto_hash_engine_desc_t *engine = &mbedtls_hash_engine;
+static unsigned char data[DATA_SIZE];
+static unsigned char digest_info[DIGEST_INFO_SIZE];
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+/* Build the DigestInfo of the library digest of the first `len` bytes */
+static unsigned int make_digest_info(unsigned int len, int params)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned int prefix_len;
+
+	if (params) {
+		prefix_len = sizeof(sha256_prefix);
+		memcpy(digest_info, sha256_prefix, prefix_len);
+	} else {
+		prefix_len = sizeof(sha256_prefix_no_params);
+		memcpy(digest_info, sha256_prefix_no_params, prefix_len);
+	}
+
+	md_info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+	if ((md_info == NULL) ||
+	    (mbedtls_md(md_info, data, len, digest_info + prefix_len) != 0))
+		return 0;
+
+	return prefix_len + DIGEST_SIZE;
+}
+
+/*
+ * Stream the first `len` bytes through the engine in chunks of `chunk` bytes,
+ * as crypto_mod_verify_hash_update() and crypto_mod_verify_hash_finish() do.
+ * Return the result of the hash and the number of busy polls.
+ */
+static int stream(unsigned int len, unsigned int chunk,
+		  unsigned int digest_info_len, unsigned int *busy)
+{
+	unsigned int pos, n;
+	int rc;
+
+	*busy = 0;
+	rc = engine->start(digest_info, digest_info_len);
+	if (rc != CRYPTO_SUCCESS)
+		return rc;
+
+	for (pos = 0; pos < len; pos += n) {
+		n = (len - pos < chunk) ? len - pos : chunk;
+		rc = engine->submit(data + pos, n);
+		if (rc != CRYPTO_SUCCESS)
+			break;
+
+		/* A second chunk can't be submitted while one is pending */
+		if (n > 4096)
+			CHECK(engine->submit(data, 1) == CRYPTO_ERR_BUSY,
+			      "chunk of %u bytes accepted while busy", n);
+
+		while ((rc = engine->poll()) == CRYPTO_ERR_BUSY)
+			(*busy)++;
+		if (rc != CRYPTO_SUCCESS)
+			break;
+	}
+
+	if (rc != CRYPTO_SUCCESS) {
+		(void)engine->finish();
+		return rc;
+	}
+
+	return engine->finish();
+}
+
+/* The engine digest matches the library one, whatever the chunk size */
+static void test_chunks(void)
+{
+	static const unsigned int lens[] = { 1, 63, 64, 4097, DATA_SIZE };
+	unsigned int i, j, di_len, busy;
+	int rc;
+
+	for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+		di_len = make_digest_info(lens[i], i & 1);
+		for (j = 0; j < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]);
+		     j++) {
+			rc = stream(lens[i], chunk_sizes[j], di_len, &busy);
+			CHECK(rc == CRYPTO_SUCCESS, "len %u chunk %u returned "
+			      "%d", lens[i], chunk_sizes[j], rc);
+			/* Large chunks are consumed over several polls */
+			if (chunk_sizes[j] > 4096 && lens[i] > 4096)
+				CHECK(busy != 0, "len %u chunk %u never busy",
+				      lens[i], chunk_sizes[j]);
+		}
+	}
+}
+
+/* Any difference in the data or in the expected digest is detected */
+static void test_mismatch(void)
+{
+	unsigned int di_len, busy;
+	int rc;
+
+	di_len = make_digest_info(DATA_SIZE, 1);
+
+	digest_info[di_len - 1] ^= 1;
+	rc = stream(DATA_SIZE, 4096, di_len, &busy);
+	CHECK(rc == CRYPTO_ERR_HASH, "wrong digest returned %d", rc);
+	digest_info[di_len - 1] ^= 1;
+
+	data[DATA_SIZE / 2] ^= 0x80;
+	rc = stream(DATA_SIZE, 1000, di_len, &busy);
+	CHECK(rc == CRYPTO_ERR_HASH, "modified data returned %d", rc);
+	data[DATA_SIZE / 2] ^= 0x80;
+
+	rc = stream(DATA_SIZE - 1, 1000, di_len, &busy);
+	CHECK(rc == CRYPTO_ERR_HASH, "truncated data returned %d", rc);
+
+	rc = stream(DATA_SIZE, 1000, di_len, &busy);
+	CHECK(rc == CRYPTO_SUCCESS, "data returned %d", rc);
+}
+
+/* Only well formed SHA-256 DigestInfo are accepted */
+static void test_bad_digest_info(void)
+{
+	unsigned int di_len;
+	int rc;
+
+	di_len = make_digest_info(DATA_SIZE, 1);
+
+	rc = engine->start(digest_info, di_len - 1);
+	CHECK(rc == CRYPTO_ERR_HASH, "truncated DigestInfo returned %d", rc);
+
+	memcpy(digest_info, sha1_prefix, sizeof(sha1_prefix));
+	rc = engine->start(digest_info, sizeof(sha1_prefix) + 20);
+	CHECK(rc == CRYPTO_ERR_HASH, "SHA-1 DigestInfo returned %d", rc);
+
+	rc = engine->submit(data, 16);
+	CHECK(rc == CRYPTO_ERR_HASH, "submit without hash returned %d", rc);
+	rc = engine->finish();
+	CHECK(rc == CRYPTO_ERR_HASH, "finish without hash returned %d", rc);
+}
+
+/* Starting a hash discards the one in progress, even with data pending */
+static void test_restart(void)
+{
+	unsigned int di_len, busy;
+	int rc;
+
+	di_len = make_digest_info(DATA_SIZE, 0);
+
+	rc = engine->start(digest_info, di_len);
+	CHECK(rc == CRYPTO_SUCCESS, "start returned %d", rc);
+	rc = engine->submit(data + 1, 10000);
+	CHECK(rc == CRYPTO_SUCCESS, "submit returned %d", rc);
+	(void)engine->poll();
+
+	rc = stream(DATA_SIZE, 65536, di_len, &busy);
+	CHECK(rc == CRYPTO_SUCCESS, "restarted hash returned %d", rc);
+}
+
+int main(void)
+{
+	unsigned int i;
+
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	mbedtls_init();
+
+	for (i = 0; i < DATA_SIZE; i++)
+		data[i] = (unsigned char)((i * 7) ^ (i >> 9));
+
+	test_chunks();
+	test_mismatch();
+	test_bad_digest_info();
+	test_restart();
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("hash_engine: all tests passed\n");
+	return 0;
+}
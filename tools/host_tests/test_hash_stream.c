@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the hash calculated over several chunks of data by the mbed TLS
+ * crypto module (drivers/auth/mbedtls/mbedtls_crypto.c) with
+ * STREAM_IMAGE_HASH=1, through the crypto module interface. The expected
+ * digests are calculated with OpenSSL.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <openssl/sha.h>
+
+#include <crypto_mod.h>
+#include <utils_def.h>
+
+#define MAX_DATA_SIZE		(100 * 1024)
+
+/* DigestInfo of SHA-256, followed by the 32 bytes of the digest */
+static const unsigned char sha256_prefix[] = {
+	0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03,
+	0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20
+};
+
+#define DIGEST_INFO_SIZE	(sizeof(sha256_prefix) + SHA256_DIGEST_LENGTH)
+
+static unsigned char data[MAX_DATA_SIZE];
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+static void make_digest_info(unsigned char *digest_info, size_t len)
+{
+	memcpy(digest_info, sha256_prefix, sizeof(sha256_prefix));
+	SHA256(data, len, digest_info + sizeof(sha256_prefix));
+}
+
+/*
+ * Hash `len` bytes of data in chunks of `chunk` bytes and return the result
+ * of the comparison with the digest.
+ */
+static int stream_hash(unsigned char *digest_info, size_t len, size_t chunk)
+{
+	size_t pos, n;
+	int rc;
+
+	rc = crypto_mod_verify_hash_start(digest_info, DIGEST_INFO_SIZE);
+	if (rc != CRYPTO_SUCCESS)
+		return rc;
+
+	for (pos = 0; pos < len; pos += n) {
+		n = MIN(chunk, len - pos);
+		rc = crypto_mod_verify_hash_update(data + pos, n);
+		if (rc != CRYPTO_SUCCESS)
+			return rc;
+	}
+
+	return crypto_mod_verify_hash_finish();
+}
+
+/* The hash of the data is the same in any chunks and in one go */
+static void test_chunks(void)
+{
+	static const size_t lens[] = { 1, 63, 64, 65, 1000, 16 * 1024,
+				       16 * 1024 + 1, MAX_DATA_SIZE };
+	static const size_t chunks[] = { 1, 7, 64, 4096, 16 * 1024,
+					 MAX_DATA_SIZE };
+	unsigned char digest_info[DIGEST_INFO_SIZE];
+	unsigned int i, j;
+	int rc;
+
+	for (i = 0; i < ARRAY_SIZE(lens); i++) {
+		make_digest_info(digest_info, lens[i]);
+
+		rc = crypto_mod_verify_hash(data, lens[i], digest_info,
+					    sizeof(digest_info));
+		CHECK(rc == CRYPTO_SUCCESS, "hash of %zu bytes: %d", lens[i],
+		      rc);
+
+		for (j = 0; j < ARRAY_SIZE(chunks); j++) {
+			rc = stream_hash(digest_info, lens[i], chunks[j]);
+			CHECK(rc == CRYPTO_SUCCESS,
+			      "hash of %zu bytes in chunks of %zu: %d",
+			      lens[i], chunks[j], rc);
+		}
+	}
+}
+
+/* Wrong digests, modified and truncated data are detected */
+static void test_mismatch(void)
+{
+	unsigned char digest_info[DIGEST_INFO_SIZE];
+	size_t len = 5000;
+	int rc;
+
+	make_digest_info(digest_info, len);
+
+	digest_info[DIGEST_INFO_SIZE - 1] ^= 1;
+	rc = stream_hash(digest_info, len, 100);
+	CHECK(rc == CRYPTO_ERR_HASH, "wrong digest: %d", rc);
+	digest_info[DIGEST_INFO_SIZE - 1] ^= 1;
+
+	data[len / 2] ^= 0x80;
+	rc = stream_hash(digest_info, len, 100);
+	CHECK(rc == CRYPTO_ERR_HASH, "modified data: %d", rc);
+	data[len / 2] ^= 0x80;
+
+	rc = stream_hash(digest_info, len - 1, 100);
+	CHECK(rc == CRYPTO_ERR_HASH, "truncated data: %d", rc);
+	rc = stream_hash(digest_info, len + 1, 100);
+	CHECK(rc == CRYPTO_ERR_HASH, "extra data: %d", rc);
+
+	rc = stream_hash(digest_info, len, 100);
+	CHECK(rc == CRYPTO_SUCCESS, "hash after the mismatches: %d", rc);
+}
+
+/* Only a started hash can be updated and finished */
+static void test_sequence(void)
+{
+	unsigned char digest_info[DIGEST_INFO_SIZE];
+	size_t len = 3000;
+	int rc;
+
+	make_digest_info(digest_info, len);
+
+	rc = crypto_mod_verify_hash_update(data, len);
+	CHECK(rc == CRYPTO_ERR_HASH, "update without start: %d", rc);
+	rc = crypto_mod_verify_hash_finish();
+	CHECK(rc == CRYPTO_ERR_HASH, "finish without start: %d", rc);
+
+	/* A finished hash can't be updated */
+	CHECK(stream_hash(digest_info, len, len) == CRYPTO_SUCCESS,
+	      "hash of %zu bytes", len);
+	rc = crypto_mod_verify_hash_update(data, len);
+	CHECK(rc == CRYPTO_ERR_HASH, "update after finish: %d", rc);
+
+	/* A start discards the hash in progress */
+	rc = crypto_mod_verify_hash_start(digest_info, sizeof(digest_info));
+	CHECK(rc == CRYPTO_SUCCESS, "first start: %d", rc);
+	rc = crypto_mod_verify_hash_update(data + 1, 100);
+	CHECK(rc == CRYPTO_SUCCESS, "first update: %d", rc);
+	rc = stream_hash(digest_info, len, 1000);
+	CHECK(rc == CRYPTO_SUCCESS, "hash after a discarded one: %d", rc);
+}
+
+/* Bad DigestInfo structures are rejected when the hash is started */
+static void test_bad_digest_info(void)
+{
+	unsigned char digest_info[DIGEST_INFO_SIZE];
+	size_t len = 100;
+	int rc;
+
+	make_digest_info(digest_info, len);
+
+	rc = crypto_mod_verify_hash_start(digest_info, DIGEST_INFO_SIZE - 1);
+	CHECK(rc == CRYPTO_ERR_HASH, "truncated DigestInfo: %d", rc);
+	rc = crypto_mod_verify_hash_update(data, len);
+	CHECK(rc == CRYPTO_ERR_HASH, "update after a failed start: %d", rc);
+
+	/* Digest shorter than the SHA-256 size */
+	digest_info[1] -= 1;
+	digest_info[sizeof(sha256_prefix) - 1] -= 1;
+	rc = crypto_mod_verify_hash_start(digest_info, DIGEST_INFO_SIZE - 1);
+	CHECK(rc == CRYPTO_ERR_HASH, "short digest: %d", rc);
+
+	/* Unknown hash algorithm */
+	make_digest_info(digest_info, len);
+	digest_info[14] = 0x7f;
+	rc = crypto_mod_verify_hash_start(digest_info, DIGEST_INFO_SIZE);
+	CHECK(rc == CRYPTO_ERR_HASH, "unknown algorithm: %d", rc);
+}
+
+int main(void)
+{
+	size_t i;
+
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = (unsigned char)((i * 131) ^ (i >> 7));
+
+	crypto_mod_init();
+
+	test_chunks();
+	test_mismatch();
+	test_sequence();
+	test_bad_digest_info();
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("hash_stream: all tests passed\n");
+	return 0;
+}
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the block device driver (drivers/io/io_block.c) on top of the block
+ * device operations of the host io device.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <io_block.h>
+#include <io_driver.h>
+#include <io_storage.h>
+#include <platform_def.h>
+#include <utils.h>
+
+#include "host_io.h"
+
+#define BLOCK_SIZE		HOST_IO_BLOCK_SIZE
+#define DISK_BLOCKS		256
+#define DISK_SIZE		(DISK_BLOCKS * BLOCK_SIZE)
+#define BUF_BLOCKS		4
+
+#define CACHE_BLOCKS		8
+#define CACHE_READAHEAD		5
+
+#define RANDOM_READS		20000
+#define RANDOM_WRITES		5000
+
+static unsigned char ram_disk[DISK_SIZE];
+static unsigned char block_buf[BUF_BLOCKS * BLOCK_SIZE]
+	__attribute__((aligned(BLOCK_SIZE)));
+static unsigned char dst_buf[DISK_SIZE + BLOCK_SIZE]
+	__attribute__((aligned(BLOCK_SIZE)));
+static unsigned char src_buf[DISK_SIZE + BLOCK_SIZE];
+/* Cached blocks, followed by their tags which take less than 64 bytes each */
+static unsigned char cache_mem[CACHE_BLOCKS * (BLOCK_SIZE + 64)]
+	__attribute__((aligned(BLOCK_SIZE)));
+
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+static io_block_dev_spec_t uncached_spec = {
+	.buffer = {
+		.offset = (uintptr_t)block_buf,
+		.length = sizeof(block_buf),
+	},
+	.ops = {
+		.read = host_io_block_read,
+		.write = host_io_block_write,
+	},
+	.block_size = BLOCK_SIZE,
+};
+
+static io_block_dev_spec_t cached_spec = {
+	.buffer = {
+		.offset = (uintptr_t)block_buf,
+		.length = sizeof(block_buf),
+	},
+	.ops = {
+		.read = host_io_block_read,
+		.write = host_io_block_write,
+	},
+	.block_size = BLOCK_SIZE,
+	.cache = {
+		.offset = (uintptr_t)cache_mem,
+		.length = sizeof(cache_mem),
+	},
+	.cache_readahead = CACHE_READAHEAD,
+};
+
+/* Deterministic pseudo random numbers, so that failures can be reproduced */
+static uint32_t rand_state = 1;
+
+static uint32_t next_rand(void)
+{
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static void fill_disk(unsigned int seed)
+{
+	size_t i;
+
+	for (i = 0; i < DISK_SIZE; i++)
+		ram_disk[i] = (unsigned char)((i * 13) ^ (i >> 9) ^ seed);
+}
+
+/* Region of the disk opened by the tests, which skips the first 8 blocks */
+static io_block_spec_t region = {
+	.offset = 8 * BLOCK_SIZE,
+	.length = DISK_SIZE - 8 * BLOCK_SIZE,
+};
+
+/*
+ * Read `len` bytes at `pos` in the region into the destination buffer at
+ * `dst_off`, and check them. Return the number of device read requests.
+ */
+static unsigned int read_check(uintptr_t handle, size_t pos, size_t len,
+			       size_t dst_off)
+{
+	unsigned char *dst = dst_buf + dst_off;
+	unsigned int reads = host_io_stats.reads;
+	size_t len_read;
+	int ret;
+
+	memset(dst_buf, 0xa5, sizeof(dst_buf));
+
+	ret = io_seek(handle, IO_SEEK_SET, pos);
+	CHECK(ret == 0, "seek to %zu: %d", pos, ret);
+	ret = io_read(handle, (uintptr_t)dst, len, &len_read);
+	CHECK((ret == 0) && (len_read == len), "read of %zu at %zu: %d", len,
+	      pos, ret);
+
+	CHECK(memcmp(dst, ram_disk + region.offset + pos, len) == 0,
+	      "data of read of %zu at %zu to +%zu", len, pos, dst_off);
+	/* Nothing is written around the destination */
+	CHECK((dst_off == 0) || (dst[-1] == 0xa5),
+	      "byte before the read of %zu at %zu to +%zu", len, pos,
+	      dst_off);
+	CHECK((dst_off + len == sizeof(dst_buf)) || (dst[len] == 0xa5),
+	      "byte after the read of %zu at %zu to +%zu", len, pos,
+	      dst_off);
+
+	return host_io_stats.reads - reads;
+}
+
+/*
+ * Reads of random offsets, lengths and destination alignments return the
+ * device data. When the destination and the file position are mutually
+ * aligned, the whole blocks in the middle of the read go to the destination
+ * in a single device request, so that no read takes more than three.
+ */
+static void test_random_reads(uintptr_t dev)
+{
+	uintptr_t handle;
+	size_t pos, len, dst_off;
+	unsigned int i, reads;
+	int ret;
+
+	fill_disk(0x3c);
+	ret = io_open(dev, (uintptr_t)&region, &handle);
+	CHECK(ret == 0, "open: %d", ret);
+	if (ret != 0)
+		return;
+
+	for (i = 0; i < RANDOM_READS; i++) {
+		pos = next_rand() % region.length;
+		/* Mostly small reads, with some over many blocks */
+		if ((i % 4) == 0)
+			len = 1 + next_rand() % (region.length - pos);
+		else
+			len = 1 + next_rand() % MIN((size_t)3 * BLOCK_SIZE,
+						    region.length - pos);
+		if ((i % 3) == 0)
+			dst_off = next_rand() % BLOCK_SIZE;
+		else
+			dst_off = pos % BLOCK_SIZE;
+
+		reads = read_check(handle, pos, len, dst_off);
+		if (dst_off == pos % BLOCK_SIZE)
+			CHECK(reads <= 3, "%u requests for a read of %zu at %zu",
+			      reads, len, pos);
+	}
+
+	io_close(handle);
+}
+
+/* Boundary cases of the head, middle and tail split */
+static void test_edge_reads(uintptr_t dev)
+{
+	static const size_t lens[] = { 1, BLOCK_SIZE - 1, BLOCK_SIZE,
+				       BLOCK_SIZE + 1, 2 * BLOCK_SIZE,
+				       BUF_BLOCKS * BLOCK_SIZE,
+				       BUF_BLOCKS * BLOCK_SIZE + 1,
+				       5 * BUF_BLOCKS * BLOCK_SIZE + 3 };
+	static const size_t pos[] = { 0, 1, BLOCK_SIZE - 1, BLOCK_SIZE,
+				      3 * BLOCK_SIZE + 7 };
+	static const size_t dst_off[] = { 0, 1, 8, BLOCK_SIZE - 1 };
+	uintptr_t handle;
+	unsigned int i, j, k;
+	int ret;
+
+	fill_disk(0x81);
+	ret = io_open(dev, (uintptr_t)&region, &handle);
+	CHECK(ret == 0, "open: %d", ret);
+	if (ret != 0)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(lens); i++)
+		for (j = 0; j < ARRAY_SIZE(pos); j++)
+			for (k = 0; k < ARRAY_SIZE(dst_off); k++)
+				read_check(handle, pos[j], lens[i],
+					   dst_off[k]);
+
+	/* The last byte of the region */
+	read_check(handle, region.length - 1, 1, 0);
+	read_check(handle, region.length - BLOCK_SIZE - 1, BLOCK_SIZE + 1, 3);
+
+	io_close(handle);
+}
+
+static void get_stats(io_block_cache_stats_t *stats)
+{
+	int ret = io_block_get_cache_stats(&cached_spec, stats);
+
+	CHECK(ret == 0, "get_cache_stats: %d", ret);
+}
+
+/*
+ * Single block reads are served from the cache, which reads ahead within
+ * the block buffer and the open region.
+ */
+static void test_cache_hits(uintptr_t dev)
+{
+	io_block_cache_stats_t before, after;
+	uintptr_t handle;
+	unsigned int reads;
+	size_t pos;
+	int ret;
+
+	fill_disk(0x5e);
+	ret = io_open(dev, (uintptr_t)&region, &handle);
+	CHECK(ret == 0, "open: %d", ret);
+	if (ret != 0)
+		return;
+
+	/* A miss reads the block and the read-ahead, up to the buffer size */
+	pos = 20 * BLOCK_SIZE + 100;
+	get_stats(&before);
+	reads = read_check(handle, pos, 10, 0);
+	get_stats(&after);
+	CHECK((reads == 1) && (after.misses == before.misses + 1),
+	      "first read: %u requests, %u misses", reads,
+	      after.misses - before.misses);
+	CHECK(host_io_stats.last_read_size == BUF_BLOCKS * BLOCK_SIZE,
+	      "read-ahead of %zu bytes", host_io_stats.last_read_size);
+
+	/* The same block and the read-ahead ones are then hits */
+	reads = read_check(handle, pos + 50, 10, 0);
+	reads += read_check(handle, pos + (BUF_BLOCKS - 1) * BLOCK_SIZE, 7,
+			    3);
+	get_stats(&before);
+	CHECK((reads == 0) && (before.hits == after.hits + 2),
+	      "cached reads: %u requests, %u hits", reads,
+	      before.hits - after.hits);
+
+	/*
+	 * A hit makes a block the most recently used one. After reading two
+	 * groups of blocks, the cache is full and the first block is the
+	 * oldest but for its own read-ahead. Reading it again keeps it cached
+	 * when a third group is read.
+	 */
+	pos = 60 * BLOCK_SIZE;
+	read_check(handle, pos + 1, 1, 0);
+	read_check(handle, pos + 30 * BLOCK_SIZE + 1, 1, 0);
+	read_check(handle, pos + 2, 1, 0);
+	read_check(handle, pos + 60 * BLOCK_SIZE + 1, 1, 0);
+	reads = read_check(handle, pos + 3, 1, 0);
+	CHECK(reads == 0, "recently used block evicted");
+
+	/* The read-ahead stops at the end of the open region */
+	reads = read_check(handle, region.length - 5, 5, 0);
+	CHECK((reads == 1) && (host_io_stats.last_read_size == BLOCK_SIZE),
+	      "read at the end of the region: %u requests of %zu bytes",
+	      reads, host_io_stats.last_read_size);
+
+	/* Whole block reads bypass the cache */
+	get_stats(&before);
+	reads = read_check(handle, 40 * BLOCK_SIZE, 2 * BLOCK_SIZE, 0);
+	get_stats(&after);
+	CHECK((reads == 1) && (after.hits == before.hits) &&
+	      (after.misses == before.misses),
+	      "aligned read: %u requests", reads);
+
+	io_close(handle);
+}
+
+/*
+ * Write `len` bytes at `pos` in the region, and check them with the rest of
+ * the disk against `expected`.
+ */
+static void write_check(uintptr_t handle, size_t pos, size_t len,
+			size_t src_off, const unsigned char *expected)
+{
+	size_t i, len_written;
+	int ret;
+
+	for (i = 0; i < len; i++)
+		src_buf[src_off + i] = (unsigned char)next_rand();
+
+	ret = io_seek(handle, IO_SEEK_SET, pos);
+	CHECK(ret == 0, "seek to %zu: %d", pos, ret);
+	ret = io_write(handle, (uintptr_t)(src_buf + src_off), len,
+		       &len_written);
+	CHECK((ret == 0) && (len_written == len), "write of %zu at %zu: %d",
+	      len, pos, ret);
+
+	CHECK(memcmp(ram_disk + region.offset + pos, src_buf + src_off,
+		     len) == 0, "data of write of %zu at %zu", len, pos);
+	CHECK((memcmp(ram_disk, expected, region.offset + pos) == 0) &&
+	      (memcmp(ram_disk + region.offset + pos + len,
+		      expected + region.offset + pos + len,
+		      DISK_SIZE - region.offset - pos - len) == 0),
+	      "write of %zu at %zu changed other data", len, pos);
+}
+
+/*
+ * Random reads and writes through the cache: writes drop the cached copies
+ * of the blocks they touch, so reads never return stale data.
+ */
+static void test_cache_writes(uintptr_t dev)
+{
+	static unsigned char expected[DISK_SIZE];
+	uintptr_t handle;
+	size_t pos, len, src_off;
+	unsigned int i;
+	int ret;
+
+	fill_disk(0x17);
+	ret = io_open(dev, (uintptr_t)&region, &handle);
+	CHECK(ret == 0, "open: %d", ret);
+	if (ret != 0)
+		return;
+
+	for (i = 0; i < RANDOM_WRITES; i++) {
+		/* Small accesses within a few blocks, so that they overlap */
+		pos = next_rand() % (16 * BLOCK_SIZE);
+		len = 1 + next_rand() % (2 * BLOCK_SIZE);
+
+		if ((i % 2) == 0) {
+			/* Cache the blocks first */
+			read_check(handle, pos, MIN(len, (size_t)BLOCK_SIZE),
+				   0);
+			read_check(handle, pos + len - 1, 1, 0);
+		}
+
+		memcpy(expected, ram_disk, DISK_SIZE);
+		src_off = ((i % 3) == 0) ? 0 : next_rand() % BLOCK_SIZE;
+		write_check(handle, pos, len, src_off, expected);
+
+		read_check(handle, pos, len, next_rand() % BLOCK_SIZE);
+	}
+
+	io_close(handle);
+}
+
+int main(void)
+{
+	const io_dev_connector_t *block_dev_con;
+	uintptr_t uncached_dev, cached_dev;
+
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	host_io_init(ram_disk, sizeof(ram_disk));
+	if ((register_io_dev_block(&block_dev_con) != 0) ||
+	    (io_dev_open(block_dev_con, (uintptr_t)&uncached_spec,
+			 &uncached_dev) != 0) ||
+	    (io_dev_open(block_dev_con, (uintptr_t)&cached_spec,
+			 &cached_dev) != 0)) {
+		printf("Failed to set up the io devices\n");
+		return 1;
+	}
+
+	test_edge_reads(uncached_dev);
+	test_random_reads(uncached_dev);
+
+	test_cache_hits(cached_dev);
+	test_edge_reads(cached_dev);
+	test_random_reads(cached_dev);
+	test_cache_writes(cached_dev);
+
+	failures += host_io_stats.errors;
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("io_block: all tests passed\n");
+	return 0;
+}
@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the FIP driver (drivers/io/io_fip.c), with the packages built in
+ * the storage of the host io device.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <firmware_image_package.h>
+#include <io_driver.h>
+#include <io_fip.h>
+#include <io_storage.h>
+#include <platform_def.h>
+
+#include "host_io.h"
+
+#define FIP_SIZE		(64 * 1024)
+#define MAX_FIP_IMAGES		32
+
+/* Image ids of the packages, as passed to io_dev_init() */
+#define NUM_FIPS		2
+
+static unsigned char fip_buf[NUM_FIPS][FIP_SIZE];
+static io_block_spec_t fip_spec[NUM_FIPS];
+
+static fip_toc_entry_t toc[NUM_FIPS][MAX_FIP_IMAGES];
+static unsigned int toc_entries[NUM_FIPS];
+
+static uintptr_t host_dev;
+static uintptr_t fip_dev;
+static const io_dev_connector_t *fip_dev_con;
+
+static unsigned int image_source_calls;
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+/* Called by the FIP driver to find the package of an image id */
+int plat_get_image_source(unsigned int image_id, uintptr_t *dev_handle,
+			  uintptr_t *image_spec)
+{
+	image_source_calls++;
+
+	if (image_id >= NUM_FIPS)
+		return -ENOENT;
+
+	*dev_handle = host_dev;
+	*image_spec = (uintptr_t)&fip_spec[image_id];
+	return 0;
+}
+
+/*
+ * UUID of the image `n` of the package `fip`. Odd images only differ from the
+ * previous one by their node, so that they hash to the same cache slot.
+ */
+static uuid_t make_uuid(unsigned int fip, unsigned int n)
+{
+	uuid_t uuid;
+	unsigned int base = n & ~1U;
+
+	memset(&uuid, 0, sizeof(uuid));
+	uuid.time_low = 0x9e3779b9U * (base + 1) + fip;
+	uuid.time_mid = (uint16_t)(0x7f4a + base * 13);
+	uuid.time_hi_and_version = (uint16_t)(0x4000 | base);
+	uuid.clock_seq_hi_and_reserved = 0x80;
+	uuid.node[0] = (uint8_t)fip;
+	uuid.node[5] = (uint8_t)(n + 1);
+	return uuid;
+}
+
+static unsigned char payload_byte(unsigned int fip, unsigned int n, size_t off)
+{
+	return (unsigned char)((off * 31) ^ (n * 7) ^ (fip * 101) ^ (off >> 8));
+}
+
+/*
+ * Build the package `fip` with `num` images. The image `n` has `n * 97 + 1`
+ * bytes. If `dup` is set, the last image has the UUID of the first one.
+ */
+static void build_fip(unsigned int fip, unsigned int num, int dup)
+{
+	fip_toc_header_t *hdr = (fip_toc_header_t *)fip_buf[fip];
+	fip_toc_entry_t *entry = (fip_toc_entry_t *)(hdr + 1);
+	size_t off, i;
+	unsigned int n;
+
+	memset(fip_buf[fip], 0, FIP_SIZE);
+	hdr->name = TOC_HEADER_NAME;
+	hdr->serial_number = 0x12345678;
+
+	/* Payloads follow the ToC and its terminating null entry */
+	off = sizeof(*hdr) + (num + 1) * sizeof(*entry);
+	for (n = 0; n < num; n++) {
+		entry[n].uuid = make_uuid(fip, n);
+		if (dup && (n == num - 1))
+			entry[n].uuid = entry[0].uuid;
+		entry[n].offset_address = off;
+		entry[n].size = n * 97 + 1;
+		for (i = 0; i < entry[n].size; i++)
+			fip_buf[fip][off + i] = payload_byte(fip, n, i);
+		toc[fip][n] = entry[n];
+		off += entry[n].size;
+	}
+
+	toc_entries[fip] = num;
+	fip_spec[fip].offset = fip * FIP_SIZE;
+	fip_spec[fip].length = off;
+}
+
+/* Read the whole image `n` of the package `fip` and check its content */
+static void check_image(unsigned int fip, unsigned int n)
+{
+	static unsigned char buf[FIP_SIZE];
+	io_uuid_spec_t spec = { .uuid = toc[fip][n].uuid };
+	uintptr_t handle;
+	size_t len, len_read, i;
+	unsigned int reads = host_io_stats.reads;
+	int ret;
+
+	/* The image is found in the cached ToC */
+	ret = io_open(fip_dev, (uintptr_t)&spec, &handle);
+	CHECK(ret == 0, "open image %u of FIP %u: %d", n, fip, ret);
+	if (ret != 0)
+		return;
+	CHECK(host_io_stats.reads == reads,
+	      "open of image %u of FIP %u read the ToC", n, fip);
+
+	ret = io_size(handle, &len);
+	CHECK((ret == 0) && (len == toc[fip][n].size),
+	      "size of image %u of FIP %u: %zu", n, fip, len);
+
+	ret = io_read(handle, (uintptr_t)buf, toc[fip][n].size, &len_read);
+	CHECK((ret == 0) && (len_read == toc[fip][n].size),
+	      "read image %u of FIP %u: %d", n, fip, ret);
+	CHECK(host_io_stats.reads == reads + 1,
+	      "read of image %u of FIP %u took %u backend reads", n, fip,
+	      host_io_stats.reads - reads);
+	for (i = 0; i < toc[fip][n].size; i++) {
+		if (buf[i] != payload_byte(fip, n, i)) {
+			CHECK(0, "image %u of FIP %u differs at %zu", n, fip,
+			      i);
+			break;
+		}
+	}
+
+	io_close(handle);
+}
+
+static int open_uuid(uuid_t uuid)
+{
+	io_uuid_spec_t spec = { .uuid = uuid };
+	uintptr_t handle;
+	int ret;
+
+	ret = io_open(fip_dev, (uintptr_t)&spec, &handle);
+	if (ret == 0)
+		io_close(handle);
+	return ret;
+}
+
+/* Every image of the package is found through the cached ToC */
+static void test_toc_lookup(void)
+{
+	uuid_t uuid;
+	unsigned int n;
+	int ret;
+
+	build_fip(0, FIP_TOC_CACHE_ENTRIES - 1, 0);
+	ret = io_dev_init(fip_dev, 0);
+	CHECK(ret == 0, "init: %d", ret);
+
+	for (n = 0; n < toc_entries[0]; n++)
+		check_image(0, n);
+
+	/* Same hash as the first image, but a different UUID */
+	uuid = make_uuid(0, 0);
+	uuid.node[5] = 0xff;
+	ret = open_uuid(uuid);
+	CHECK(ret == -ENOENT, "open of a missing image: %d", ret);
+	ret = open_uuid(make_uuid(1, 0));
+	CHECK(ret == -ENOENT, "open of an image of another FIP: %d", ret);
+
+	io_dev_close(fip_dev);
+}
+
+/* The ToC is only read again for another package or after a close */
+static void test_toc_reuse(void)
+{
+	unsigned int calls;
+	int ret;
+
+	build_fip(0, 5, 0);
+	build_fip(1, 7, 0);
+
+	calls = image_source_calls;
+	ret = io_dev_init(fip_dev, 0);
+	CHECK((ret == 0) && (image_source_calls == calls + 1),
+	      "first init: %d", ret);
+	ret = io_dev_init(fip_dev, 0);
+	CHECK((ret == 0) && (image_source_calls == calls + 1),
+	      "init of the same FIP read the ToC again");
+	check_image(0, 4);
+
+	ret = io_dev_init(fip_dev, 1);
+	CHECK((ret == 0) && (image_source_calls == calls + 2),
+	      "init of another FIP: %d", ret);
+	check_image(1, 6);
+	CHECK(open_uuid(toc[0][4].uuid) == -ENOENT,
+	      "image of the previous FIP still found");
+
+	io_dev_close(fip_dev);
+	CHECK(open_uuid(toc[1][6].uuid) == -ENOENT,
+	      "image found after the device was closed");
+	ret = io_dev_init(fip_dev, 1);
+	CHECK((ret == 0) && (image_source_calls == calls + 3),
+	      "init after close: %d", ret);
+	check_image(1, 0);
+
+	io_dev_close(fip_dev);
+}
+
+/* A package with more images than the cache can hold is rejected */
+static void test_toc_full(void)
+{
+	int ret;
+
+	build_fip(0, FIP_TOC_CACHE_ENTRIES, 0);
+	ret = io_dev_init(fip_dev, 0);
+	CHECK(ret == -ENOMEM, "init of an oversized FIP: %d", ret);
+	CHECK(open_uuid(toc[0][0].uuid) == -ENOENT,
+	      "image found in a rejected FIP");
+
+	io_dev_close(fip_dev);
+}
+
+/* As with a linear search of the ToC, the first of two duplicates wins */
+static void test_toc_duplicate(void)
+{
+	int ret;
+
+	build_fip(0, 4, 1);
+	ret = io_dev_init(fip_dev, 0);
+	CHECK(ret == 0, "init: %d", ret);
+	check_image(0, 0);
+
+	io_dev_close(fip_dev);
+}
+
+static void test_bad_header(void)
+{
+	int ret;
+
+	build_fip(0, 4, 0);
+	((fip_toc_header_t *)fip_buf[0])->name = 0;
+	ret = io_dev_init(fip_dev, 0);
+	CHECK(ret == -ENOENT, "init with a bad header: %d", ret);
+	CHECK(open_uuid(toc[0][0].uuid) == -ENOENT,
+	      "image found in a FIP with a bad header");
+
+	ret = io_dev_init(fip_dev, NUM_FIPS);
+	CHECK(ret == -ENOENT, "init of an unknown image id: %d", ret);
+
+	io_dev_close(fip_dev);
+}
+
+static int open_image(unsigned int fip, unsigned int n, uintptr_t *handle)
+{
+	io_uuid_spec_t spec = { .uuid = toc[fip][n].uuid };
+
+	return io_open(fip_dev, (uintptr_t)&spec, handle);
+}
+
+/*
+ * Read `len` bytes of the image `n` of the package `fip`, from `*pos`, and
+ * check them.
+ */
+static void read_chunk(uintptr_t handle, unsigned int fip, unsigned int n,
+		       size_t *pos, size_t len)
+{
+	unsigned char buf[64];
+	size_t len_read, i;
+	int ret;
+
+	ret = io_read(handle, (uintptr_t)buf, len, &len_read);
+	CHECK((ret == 0) && (len_read == len),
+	      "read of image %u at %zu: %d", n, *pos, ret);
+	for (i = 0; i < len; i++) {
+		if (buf[i] != payload_byte(fip, n, *pos + i)) {
+			CHECK(0, "image %u differs at %zu", n, *pos + i);
+			break;
+		}
+	}
+	*pos += len;
+}
+
+/*
+ * Files of the package can be open at the same time, up to
+ * FIP_MAX_OPEN_FILES, and keep their own position.
+ */
+static void test_open_many(void)
+{
+	io_block_spec_t *spec = &fip_spec[0];
+	uintptr_t h1, h2, h3, backend;
+	size_t pos1 = 0, pos2 = 0;
+	unsigned int opens, seeks;
+	int ret;
+
+	build_fip(0, 8, 0);
+	ret = io_dev_init(fip_dev, 0);
+	CHECK(ret == 0, "init: %d", ret);
+
+	opens = host_io_stats.opens;
+	CHECK(open_image(0, 3, &h1) == 0, "open of the first file");
+	CHECK(open_image(0, 7, &h2) == 0, "open of the second file");
+	CHECK(open_image(0, 5, &h3) == -ENOMEM,
+	      "open of more than FIP_MAX_OPEN_FILES files");
+	CHECK(host_io_stats.opens == opens + 1,
+	      "%u backend opens for two files", host_io_stats.opens - opens);
+
+	/* Interleaved reads, each of which needs a seek of the backend */
+	while (pos1 + 37 <= toc[0][3].size) {
+		read_chunk(h1, 0, 3, &pos1, 37);
+		read_chunk(h2, 0, 7, &pos2, 61);
+	}
+
+	/* Sequential reads of one file */
+	read_chunk(h2, 0, 7, &pos2, 64);
+	seeks = host_io_stats.seeks;
+	read_chunk(h2, 0, 7, &pos2, 64);
+	CHECK(host_io_stats.seeks == seeks,
+	      "backend seek for a sequential read");
+	read_chunk(h1, 0, 3, &pos1, toc[0][3].size - pos1);
+
+	/* The backend stays open, and shared, while a file is open */
+	io_close(h1);
+	CHECK(io_open(host_dev, (uintptr_t)spec, &backend) != 0,
+	      "backend closed while a file is still open");
+	read_chunk(h2, 0, 7, &pos2, 10);
+
+	/* The released file state can be reused */
+	CHECK(open_image(0, 5, &h3) == 0, "open after a close");
+	pos1 = 0;
+	read_chunk(h3, 0, 5, &pos1, 50);
+	read_chunk(h2, 0, 7, &pos2, 10);
+	io_close(h3);
+	io_close(h2);
+
+	/* The backend is closed with the last file */
+	ret = io_open(host_dev, (uintptr_t)spec, &backend);
+	CHECK(ret == 0, "backend still open after the last close: %d", ret);
+	if (ret == 0)
+		io_close(backend);
+
+	io_dev_close(fip_dev);
+}
+
+/* The region of a file in the package is only known once it is initialised */
+static void test_file_region(void)
+{
+	io_uuid_spec_t spec = { .uuid = make_uuid(0, 3) };
+	io_uuid_spec_t missing = { .uuid = make_uuid(1, 3) };
+	size_t offset, length;
+	unsigned int n;
+	int ret;
+
+	build_fip(0, 6, 0);
+	ret = fip_get_file_region((uintptr_t)&spec, &offset, &length);
+	CHECK(ret == -ENOENT, "region before init: %d", ret);
+
+	ret = io_dev_init(fip_dev, 0);
+	CHECK(ret == 0, "init: %d", ret);
+	for (n = 0; n < toc_entries[0]; n++) {
+		io_uuid_spec_t image = { .uuid = toc[0][n].uuid };
+
+		ret = fip_get_file_region((uintptr_t)&image, &offset, &length);
+		CHECK((ret == 0) && (offset == toc[0][n].offset_address) &&
+		      (length == toc[0][n].size),
+		      "region of image %u: %d, %zu, %zu", n, ret, offset,
+		      length);
+	}
+
+	ret = fip_get_file_region((uintptr_t)&missing, &offset, &length);
+	CHECK(ret == -ENOENT, "region of a missing image: %d", ret);
+
+	io_dev_close(fip_dev);
+}
+
+int main(void)
+{
+	const io_dev_connector_t *host_dev_con;
+
+	host_io_init(fip_buf, sizeof(fip_buf));
+	if ((register_io_dev_host(&host_dev_con) != 0) ||
+	    (io_dev_open(host_dev_con, 0, &host_dev) != 0) ||
+	    (register_io_dev_fip(&fip_dev_con) != 0) ||
+	    (io_dev_open(fip_dev_con, 0, &fip_dev) != 0)) {
+		printf("Failed to set up the io devices\n");
+		return 1;
+	}
+
+	test_toc_lookup();
+	test_toc_reuse();
+	test_toc_full();
+	test_toc_duplicate();
+	test_bad_header();
+	test_open_many();
+	test_file_region();
+
+	failures += host_io_stats.errors;
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("io_fip: all tests passed\n");
+	return 0;
+}
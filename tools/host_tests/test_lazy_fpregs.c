@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the lazy switching of the floating point context between the
+ * security states (lib/el3_runtime/aarch64/lazy_fpregs.c with
+ * CTX_LAZY_FPREGS=1). The FP/SIMD registers, SCR_EL3 and CPTR_EL3 of one CPU
+ * are emulated, as well as el3_exit() and the trap taken to EL3 when a lower EL
+ * accesses the FP/SIMD registers with CPTR_EL3.TFP set.
+ *
+ *   test_lazy_fpregs
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arch.h>
+#include <context.h>
+#include <context_mgmt.h>
+#include <ep_info.h>
+#include <utils_def.h>
+
+#define RANDOM_SWITCHES		100000
+
+static cpu_context_t contexts[2];
+static const char * const state_names[2] = { "Secure", "Normal" };
+
+/* Emulated CPU */
+static uint64_t scr_el3, cptr_el3;
+static fp_regs_t fp_regs;
+static unsigned int traps;
+
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+uint64_t read_scr_el3(void)
+{
+	return scr_el3;
+}
+
+uint64_t read_cptr_el3(void)
+{
+	return cptr_el3;
+}
+
+void write_cptr_el3(uint64_t val)
+{
+	cptr_el3 = val;
+}
+
+void isb(void)
+{
+}
+
+void *cm_get_context(uint32_t security_state)
+{
+	return &contexts[security_state];
+}
+
+/* CPTR_EL3.TFP also traps the accesses to the FP/SIMD registers from EL3 */
+void fpregs_context_save(fp_regs_t *regs)
+{
+	CHECK((cptr_el3 & TFP_BIT) == 0, "FP registers saved while trapped");
+	*regs = fp_regs;
+}
+
+void fpregs_context_restore(fp_regs_t *regs)
+{
+	CHECK((cptr_el3 & TFP_BIT) == 0, "FP registers restored while trapped");
+	fp_regs = *regs;
+}
+
+static uint32_t current_state(void)
+{
+	return (scr_el3 & SCR_NS_BIT) ? NON_SECURE : SECURE;
+}
+
+/* Return to the lower EL of a security state, as el3_exit() does */
+static void el3_exit(uint32_t security_state)
+{
+	el3_state_t *state = get_el3state_ctx(&contexts[security_state]);
+
+	scr_el3 = (security_state == NON_SECURE) ? SCR_NS_BIT : 0;
+	cptr_el3 = read_ctx_reg(state, CTX_CPTR_EL3);
+}
+
+/*
+ * Access the FP/SIMD registers from the current security state, taking the
+ * trap to EL3 and retrying the access as the CPU does.
+ */
+static fp_regs_t *fp_access(void)
+{
+	uint32_t security_state = current_state();
+	unsigned int n = 0;
+
+	while (cptr_el3 & TFP_BIT) {
+		if (++n > 1) {
+			CHECK(0, "%s world access trapped again",
+			      state_names[security_state]);
+			break;
+		}
+		traps++;
+		cm_fpregs_access_trap_handler();
+		el3_exit(security_state);
+	}
+
+	return &fp_regs;
+}
+
+/* Values written to the FP/SIMD registers by a lower EL */
+static void fill(fp_regs_t *regs, unsigned int seed)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(regs->_regs); i++)
+		regs->_regs[i] = ((uint64_t)seed << 32) | i;
+}
+
+static int holds(const fp_regs_t *regs, unsigned int seed)
+{
+	fp_regs_t expected;
+
+	fill(&expected, seed);
+	return memcmp(regs, &expected, sizeof(expected)) == 0;
+}
+
+static unsigned int seed_of(const fp_regs_t *regs)
+{
+	return regs->_regs[0] >> 32;
+}
+
+/* Contexts as initialised by cm_init_context_common() in BL31 */
+static void init_contexts(void)
+{
+	uint32_t security_state;
+	el3_state_t *state;
+
+	memset(contexts, 0, sizeof(contexts));
+	for (security_state = SECURE; security_state <= NON_SECURE;
+							security_state++) {
+		state = get_el3state_ctx(&contexts[security_state]);
+		write_ctx_reg(state, CTX_CPTR_EL3, TFP_BIT);
+		fill(get_fpregs_ctx(&contexts[security_state]),
+		     0x100 + security_state);
+	}
+
+	memset(&fp_regs, 0xa5, sizeof(fp_regs));
+	cptr_el3 = 0;
+	traps = 0;
+}
+
+/* Number of contexts whose floating point context is in the registers */
+static unsigned int live_contexts(void)
+{
+	unsigned int n = 0;
+	uint32_t security_state;
+	el3_state_t *state;
+
+	for (security_state = SECURE; security_state <= NON_SECURE;
+							security_state++) {
+		state = get_el3state_ctx(&contexts[security_state]);
+		if ((read_ctx_reg(state, CTX_CPTR_EL3) & TFP_BIT) == 0)
+			n++;
+	}
+
+	return n;
+}
+
+/*
+ * The Secure world never sees the FP/SIMD registers of the Normal world, and
+ * the other way round, across SMCs to and from the Secure world.
+ */
+static void test_smc_round_trip(void)
+{
+	init_contexts();
+
+	/* The Normal world uses the FP registers, then issues an SMC */
+	el3_exit(NON_SECURE);
+	fill(fp_access(), 1);
+	CHECK(traps == 1, "%u traps on first Normal world access", traps);
+	el3_exit(SECURE);
+
+	CHECK(holds(fp_access(), 0x100),
+	      "Secure world read 0x%x, not its own FP context",
+	      seed_of(&fp_regs));
+	CHECK(holds(get_fpregs_ctx(&contexts[NON_SECURE]), 1),
+	      "Normal world FP context not saved");
+	fill(fp_access(), 2);
+	CHECK(traps == 2, "%u traps after first Secure world access", traps);
+
+	/* Result of the SMC */
+	el3_exit(NON_SECURE);
+	CHECK(holds(fp_access(), 1),
+	      "Normal world read 0x%x after the SMC", seed_of(&fp_regs));
+	CHECK(holds(get_fpregs_ctx(&contexts[SECURE]), 2),
+	      "Secure world FP context not saved");
+	CHECK(traps == 3, "%u traps after the SMC", traps);
+	CHECK(live_contexts() == 1, "%u live contexts", live_contexts());
+
+	/* SMC which does not use the FP registers in the Secure world */
+	el3_exit(SECURE);
+	el3_exit(NON_SECURE);
+	CHECK(holds(fp_access(), 1),
+	      "Normal world read 0x%x after the SMC", seed_of(&fp_regs));
+	CHECK(traps == 3, "%u traps without Secure world FP accesses", traps);
+
+	/* The Secure world gets back its registers on the next SMC */
+	fill(fp_access(), 3);
+	el3_exit(SECURE);
+	CHECK(holds(fp_access(), 2),
+	      "Secure world read 0x%x on the next SMC", seed_of(&fp_regs));
+	el3_exit(NON_SECURE);
+	CHECK(holds(fp_access(), 3),
+	      "Normal world read 0x%x after the next SMC", seed_of(&fp_regs));
+}
+
+/*
+ * The live floating point context is saved before a power down suspend, after
+ * which both security states find their registers again.
+ */
+static void test_pwrdown_suspend(void)
+{
+	uint32_t security_state;
+
+	for (security_state = SECURE; security_state <= NON_SECURE;
+							security_state++) {
+		init_contexts();
+		el3_exit(NON_SECURE);
+		fill(fp_access(), 1);
+		el3_exit(SECURE);
+		fill(fp_access(), 2);
+		el3_exit(security_state);
+
+		cm_fpregs_context_save_live();
+		CHECK(live_contexts() == 0,
+		      "%u live contexts after the save", live_contexts());
+
+		/* The registers are lost and CPTR_EL3 is reset */
+		memset(&fp_regs, 0x5a, sizeof(fp_regs));
+		cptr_el3 = 0;
+
+		el3_exit(NON_SECURE);
+		CHECK(holds(fp_access(), 1),
+		      "Normal world read 0x%x after the suspend",
+		      seed_of(&fp_regs));
+		el3_exit(SECURE);
+		CHECK(holds(fp_access(), 2),
+		      "Secure world read 0x%x after the suspend",
+		      seed_of(&fp_regs));
+	}
+}
+
+/* Random world switches, FP accesses and power down suspends */
+static void test_random_switches(void)
+{
+	unsigned int expected[2] = { 0x100, 0x101 };
+	uint32_t security_state;
+	unsigned int i, seed = 0x200, failed = failures;
+
+	init_contexts();
+	srand(1);
+
+	for (i = 0; (i < RANDOM_SWITCHES) && (failures == failed); i++) {
+		security_state = rand() & 1;
+		el3_exit(security_state);
+
+		switch (rand() % 4) {
+		case 0:
+			/* No FP access in this security state */
+			break;
+		case 1:
+			CHECK(holds(fp_access(), expected[security_state]),
+			      "%s world read 0x%x instead of 0x%x at step %u",
+			      state_names[security_state], seed_of(&fp_regs),
+			      expected[security_state], i);
+			break;
+		case 2:
+			fill(fp_access(), seed);
+			expected[security_state] = seed++;
+			break;
+		case 3:
+			cm_fpregs_context_save_live();
+			memset(&fp_regs, 0x5a, sizeof(fp_regs));
+			cptr_el3 = 0;
+			break;
+		}
+
+		CHECK(live_contexts() <= 1, "%u live contexts at step %u",
+		      live_contexts(), i);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	test_smc_round_trip();
+	test_pwrdown_suspend();
+	test_random_switches();
+
+	if (failures) {
+		printf("lazy_fpregs: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("lazy_fpregs: all tests passed\n");
+	return 0;
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the arena allocator of the mbed TLS heap
+ * (drivers/auth/mbedtls/mbedtls_common.c with MBEDTLS_HEAP_ARENA=1), through
+ * the mbed TLS calloc() and free() hooks that mbedtls_init() sets.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <mbedtls_common.h>
+
+/* mbed TLS headers */
+#include <mbedtls/platform.h>
+
+/* Allocations live at the same time in the random test */
+#define NUM_SLOTS		32
+#define NUM_OPS			200000
+
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+static size_t heap_top(void)
+{
+	mbedtls_heap_stats_t stats;
+
+	mbedtls_heap_get_stats(&stats);
+	return stats.heap_top;
+}
+
+static size_t in_use(void)
+{
+	mbedtls_heap_stats_t stats;
+
+	mbedtls_heap_get_stats(&stats);
+	return stats.in_use;
+}
+
+static int is_zero(const unsigned char *p, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		if (p[i] != 0)
+			return 0;
+	return 1;
+}
+
+/* Freed blocks are reused by requests of their size, and zeroed again */
+static void test_reuse(void)
+{
+	unsigned char *a, *b;
+	size_t top;
+
+	a = mbedtls_calloc(4, 25);
+	CHECK((a != NULL) && is_zero(a, 100), "first allocation");
+	if (a == NULL)
+		return;
+	memset(a, 0xff, 100);
+	top = heap_top();
+	mbedtls_free(a);
+	CHECK(in_use() == 0, "%zu bytes in use after free", in_use());
+
+	b = mbedtls_calloc(100, 1);
+	CHECK(b == a, "block not reused");
+	CHECK(is_zero(b, 100), "reused block not zeroed");
+	CHECK(heap_top() == top, "heap grew from %zu to %zu", top, heap_top());
+	mbedtls_free(b);
+}
+
+/*
+ * Requests are served by a free block of a larger size range when their own
+ * range has none, before the heap grows.
+ */
+static void test_fallback(void)
+{
+	unsigned char *big, *p, *q;
+	size_t top, used;
+
+	big = mbedtls_calloc(1, 2000);
+	CHECK(big != NULL, "large allocation");
+	if (big == NULL)
+		return;
+	memset(big, 0xff, 2000);
+	used = in_use();
+	top = heap_top();
+	mbedtls_free(big);
+
+	p = mbedtls_calloc(1, 200);
+	CHECK(p == big, "allocation at %p instead of %p", (void *)p,
+	      (void *)big);
+	CHECK((p != NULL) && is_zero(p, 200), "allocation not zeroed");
+	CHECK(heap_top() == top, "heap grew from %zu to %zu", top, heap_top());
+	CHECK(in_use() == used, "%zu bytes in use instead of %zu", in_use(),
+	      used);
+
+	/* The block is not split, the next request grows the heap */
+	q = mbedtls_calloc(1, 200);
+	CHECK(heap_top() > top, "heap did not grow");
+	mbedtls_free(p);
+	mbedtls_free(q);
+	CHECK(in_use() == 0, "%zu bytes in use after free", in_use());
+}
+
+/*
+ * Random allocations of sizes similar to the ones of the bignums and ASN.1
+ * buffers of a signature verification. Blocks must not overlap and must keep
+ * their contents until they are freed.
+ */
+static void test_random(void)
+{
+	unsigned char *ptr[NUM_SLOTS] = { NULL };
+	size_t len[NUM_SLOTS];
+	mbedtls_heap_stats_t stats;
+	unsigned int seed = 1, op, n, fails = 0;
+	size_t i;
+
+	for (op = 0; op < NUM_OPS; op++) {
+		seed = seed * 1103515245 + 12345;
+		n = (seed >> 16) % NUM_SLOTS;
+
+		if (ptr[n] != NULL) {
+			for (i = 0; i < len[n]; i++)
+				if (ptr[n][i] != (unsigned char)(n + i))
+					break;
+			CHECK(i == len[n], "slot %u corrupted at byte %zu", n,
+			      i);
+			mbedtls_free(ptr[n]);
+			ptr[n] = NULL;
+			continue;
+		}
+
+		seed = seed * 1103515245 + 12345;
+		len[n] = ((seed >> 16) % 4 == 0) ? 8 * ((seed >> 18) % 72 + 1) :
+			 (seed >> 18) % 200 + 1;
+		ptr[n] = mbedtls_calloc(1, len[n]);
+		if (ptr[n] == NULL) {
+			fails++;
+			continue;
+		}
+		CHECK(is_zero(ptr[n], len[n]), "slot %u not zeroed", n);
+		for (i = 0; i < len[n]; i++)
+			ptr[n][i] = (unsigned char)(n + i);
+	}
+
+	for (n = 0; n < NUM_SLOTS; n++)
+		mbedtls_free(ptr[n]);
+
+	mbedtls_heap_get_stats(&stats);
+	CHECK(stats.in_use == 0, "%zu bytes in use after free", stats.in_use);
+	CHECK(fails == 0, "%u allocations failed, heap top %zu of %zu", fails,
+	      stats.heap_top, stats.heap_size);
+}
+
+static void test_limits(void)
+{
+	mbedtls_heap_stats_t stats;
+	void *p;
+
+	mbedtls_heap_reset_stats();
+
+	p = mbedtls_calloc(SIZE_MAX / 2, 4);
+	CHECK(p == NULL, "overflowing allocation returned %p", p);
+	p = mbedtls_calloc(0, 16);
+	CHECK(p == NULL, "empty allocation returned %p", p);
+
+	/* Too large once the block header is added */
+	mbedtls_heap_get_stats(&stats);
+	p = mbedtls_calloc(1, stats.heap_size);
+	CHECK(p == NULL, "allocation of the heap size returned %p", p);
+
+	mbedtls_heap_get_stats(&stats);
+	CHECK(stats.failed == 1, "%u failed allocations", stats.failed);
+	CHECK(stats.allocs == 0, "%u allocations", stats.allocs);
+}
+
+int main(void)
+{
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	mbedtls_init();
+
+	test_reuse();
+	test_fallback();
+	test_random();
+	test_limits();
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("mbedtls_heap: all tests passed\n");
+	return 0;
+}
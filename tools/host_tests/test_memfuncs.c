@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Correctness and throughput tests of the assembly memory functions of the
+ * architecture of the host (lib/stdlib/aarch64/memfuncs.S or
+ * lib/stdlib/aarch32/memfuncs.S), which are built with their symbols renamed
+ * to tf_memcpy(), tf_memmove(), tf_memset() and tf_memcmp().
+ *
+ * Each function is tested with every length up to MAX_SMALL_LEN and every
+ * alignment of its arguments modulo MAX_ALIGN, and memmove() with the source
+ * and destination overlapping in both directions at every distance.
+ *
+ *   test_memfuncs [-b]
+ *
+ * With -b, the throughput of the functions is compared with the one of the
+ * host C library.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+void *tf_memcpy(void *dst, const void *src, size_t len);
+void *tf_memmove(void *dst, const void *src, size_t len);
+void *tf_memset(void *dst, int val, size_t len);
+int tf_memcmp(const void *s1, const void *s2, size_t len);
+
+/* Bytes around the destination which must not be written */
+#define GUARD		64
+#define MAX_ALIGN	16
+#define MAX_SMALL_LEN	300
+/* Longer than two blocks of the bulk copy loops */
+#define MAX_OVERLAP_LEN	160
+#define BUF_SIZE	(2 * GUARD + MAX_ALIGN + 65536)
+
+static const size_t large_lens[] = { 511, 512, 513, 1024, 4095, 4096, 4097,
+				     65535, 65536 };
+/* Alignments tested with the large lengths */
+static const size_t large_aligns[] = { 0, 1, 7, 8, 15 };
+
+static unsigned char src_buf[BUF_SIZE];
+static unsigned char dst_buf[BUF_SIZE];
+static unsigned char ref_buf[BUF_SIZE];
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: " __VA_ARGS__);			\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+static void fill_pattern(unsigned char *buf, size_t len, unsigned int seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = (unsigned char)((i * 7 + seed * 13 + (i >> 8)) ^ seed);
+}
+
+/* Byte by byte reference implementations */
+static void ref_move(unsigned char *dst, const unsigned char *src, size_t len)
+{
+	size_t i;
+
+	if (dst < src) {
+		for (i = 0; i < len; i++)
+			dst[i] = src[i];
+	} else {
+		for (i = len; i > 0; i--)
+			dst[i - 1] = src[i - 1];
+	}
+}
+
+static void ref_set(unsigned char *dst, int val, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		dst[i] = (unsigned char)val;
+}
+
+/* Size of the part of the buffers used by a test of length `len` */
+#define WINDOW(len)	(2 * GUARD + MAX_ALIGN + (len))
+
+/* Check a buffer against its reference, including the guard bytes */
+static int same(const unsigned char *buf, const unsigned char *ref,
+		size_t len)
+{
+	return memcmp(buf, ref, WINDOW(len)) == 0;
+}
+
+static void test_memcpy(size_t dalign, size_t salign, size_t len)
+{
+	unsigned char *dst = dst_buf + GUARD + dalign;
+	unsigned char *src = src_buf + GUARD + salign;
+	void *ret;
+
+	fill_pattern(src_buf, WINDOW(len), len);
+	memset(dst_buf, 0xa5, WINDOW(len));
+	memcpy(ref_buf, dst_buf, WINDOW(len));
+	ref_move(ref_buf + GUARD + dalign, src, len);
+
+	ret = tf_memcpy(dst, src, len);
+	CHECK(ret == dst, "memcpy returned %p instead of %p", ret, (void *)dst);
+	CHECK(same(dst_buf, ref_buf, len), "memcpy dst+%zu src+%zu len %zu",
+	      dalign, salign, len);
+}
+
+/*
+ * Source and destination are in the same buffer, at the given offsets from the
+ * end of the guard bytes, and may overlap
+ */
+static void test_memmove(size_t doff, size_t soff, size_t len)
+{
+	unsigned char *dst = dst_buf + GUARD + doff;
+	unsigned char *src = dst_buf + GUARD + soff;
+	size_t window = 2 * GUARD + ((doff > soff) ? doff : soff) + len;
+	void *ret;
+
+	fill_pattern(dst_buf, window, len + 1);
+	memcpy(ref_buf, dst_buf, window);
+	ref_move(ref_buf + GUARD + doff, ref_buf + GUARD + soff, len);
+
+	ret = tf_memmove(dst, src, len);
+	CHECK(ret == dst, "memmove returned %p instead of %p", ret,
+	      (void *)dst);
+	CHECK(memcmp(dst_buf, ref_buf, window) == 0,
+	      "memmove dst+%zu src+%zu len %zu", doff, soff, len);
+}
+
+/*
+ * memmove() with the destination below and above the source, at every distance
+ * up to the length, and from every alignment of the lower address modulo 8
+ */
+static void test_memmove_overlap(void)
+{
+	size_t len, base, dist;
+
+	for (len = 1; len <= MAX_OVERLAP_LEN; len++) {
+		for (base = 0; base < 8; base++) {
+			for (dist = 1; dist <= len; dist++) {
+				test_memmove(base, base + dist, len);
+				test_memmove(base + dist, base, len);
+			}
+		}
+	}
+}
+
+static void test_memset(size_t dalign, size_t len, int val)
+{
+	unsigned char *dst = dst_buf + GUARD + dalign;
+	void *ret;
+
+	fill_pattern(dst_buf, WINDOW(len), len);
+	memcpy(ref_buf, dst_buf, WINDOW(len));
+	ref_set(ref_buf + GUARD + dalign, val, len);
+
+	ret = tf_memset(dst, val, len);
+	CHECK(ret == dst, "memset returned %p instead of %p", ret, (void *)dst);
+	CHECK(same(dst_buf, ref_buf, len), "memset dst+%zu len %zu val 0x%x",
+	      dalign, len, val);
+}
+
+static int sign(int v)
+{
+	return (v > 0) - (v < 0);
+}
+
+static void test_memcmp(size_t align1, size_t align2, size_t len)
+{
+	unsigned char *s1 = src_buf + GUARD + align1;
+	unsigned char *s2 = dst_buf + GUARD + align2;
+	size_t pos[3], i;
+	int ret;
+
+	fill_pattern(s1, len, 3);
+	memcpy(s2, s1, len);
+	ret = tf_memcmp(s1, s2, len);
+	CHECK(ret == 0, "memcmp equal +%zu +%zu len %zu returned %d",
+	      align1, align2, len, ret);
+
+	if (len == 0)
+		return;
+
+	/* Differ at the first, a middle and the last byte, in both ways */
+	pos[0] = 0;
+	pos[1] = len / 2;
+	pos[2] = len - 1;
+	for (i = 0; i < 3; i++) {
+		memcpy(s2, s1, len);
+		s1[pos[i]] = 0x80;
+		s2[pos[i]] = 0x7f;
+		ret = tf_memcmp(s1, s2, len);
+		CHECK(sign(ret) == 1, "memcmp +%zu +%zu len %zu pos %zu "
+		      "returned %d", align1, align2, len, pos[i], ret);
+		ret = tf_memcmp(s2, s1, len);
+		CHECK(sign(ret) == -1, "memcmp +%zu +%zu len %zu pos %zu "
+		      "returned %d", align2, align1, len, pos[i], ret);
+		fill_pattern(s1, len, 3);
+	}
+}
+
+static void run_len(size_t len, const size_t *aligns, size_t nr_aligns)
+{
+	size_t a, b;
+
+	for (a = 0; a < nr_aligns; a++) {
+		test_memset(aligns[a], len, 0);
+		test_memset(aligns[a], len, 0x5a);
+		/* Only the low byte of the value is used */
+		test_memset(aligns[a], len, 0x3a4);
+		for (b = 0; b < nr_aligns; b++) {
+			test_memcpy(aligns[a], aligns[b], len);
+			test_memmove(aligns[a], aligns[b], len);
+			test_memcmp(aligns[a], aligns[b], len);
+		}
+	}
+}
+
+static void run_correctness(void)
+{
+	size_t aligns[MAX_ALIGN];
+	size_t len, i;
+
+	for (i = 0; i < MAX_ALIGN; i++)
+		aligns[i] = i;
+
+	for (len = 0; len <= MAX_SMALL_LEN; len++)
+		run_len(len, aligns, MAX_ALIGN);
+	for (i = 0; i < sizeof(large_lens) / sizeof(large_lens[0]); i++)
+		run_len(large_lens[i], large_aligns,
+			sizeof(large_aligns) / sizeof(large_aligns[0]));
+	test_memmove_overlap();
+}
+
+/*
+ * Throughput, in MB/s, of the firmware and C library functions. The results
+ * are only indicative as the host may not behave like the target.
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+#define BENCH_BYTES	(256UL * 1024 * 1024)
+
+typedef void (*bench_fn_t)(size_t len);
+
+static void bench_tf_memcpy(size_t len)
+{
+	tf_memcpy(dst_buf, src_buf + 1, len);
+}
+
+static void bench_memcpy(size_t len)
+{
+	memcpy(dst_buf, src_buf + 1, len);
+}
+
+static void bench_tf_memset(size_t len)
+{
+	tf_memset(dst_buf, 0, len);
+}
+
+static void bench_memset(size_t len)
+{
+	memset(dst_buf, 0, len);
+}
+
+static void bench_tf_memmove(size_t len)
+{
+	tf_memmove(dst_buf + 8, dst_buf, len);
+}
+
+static void bench_memmove(size_t len)
+{
+	memmove(dst_buf + 8, dst_buf, len);
+}
+
+static double bench(bench_fn_t fn, size_t len)
+{
+	unsigned long iter, n = BENCH_BYTES / len;
+	double start = now();
+
+	for (iter = 0; iter < n; iter++) {
+		fn(len);
+		/* Prevent the compiler from removing or merging the calls */
+		__asm__ volatile("" : : : "memory");
+	}
+	return (double)(n * len) / (now() - start) / 1e6;
+}
+
+static void run_throughput(void)
+{
+	static const size_t lens[] = { 16, 64, 256, 4096, 65536 };
+	size_t i;
+
+	printf("%8s %12s %12s %12s %12s %12s %12s\n", "len",
+	       "tf_memcpy", "memcpy", "tf_memset", "memset",
+	       "tf_memmove", "memmove");
+	for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++)
+		printf("%8zu %12.0f %12.0f %12.0f %12.0f %12.0f %12.0f\n",
+		       lens[i],
+		       bench(bench_tf_memcpy, lens[i]),
+		       bench(bench_memcpy, lens[i]),
+		       bench(bench_tf_memset, lens[i]),
+		       bench(bench_memset, lens[i]),
+		       bench(bench_tf_memmove, lens[i]),
+		       bench(bench_memmove, lens[i]));
+}
+
+int main(int argc, char *argv[])
+{
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	run_correctness();
+	if (failures != 0) {
+		printf("memfuncs: %u failures\n", failures);
+		return 1;
+	}
+	printf("memfuncs: all tests passed\n");
+
+	if ((argc > 1) && (strcmp(argv[1], "-b") == 0))
+		run_throughput();
+
+	return 0;
+}
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests and benchmark of the signature verification of the mbed TLS crypto
+ * module (drivers/auth/mbedtls/mbedtls_crypto.c) with the public key cache
+ * (MBEDTLS_PK_CACHE=1). The keys and the ECDSA signatures are created with
+ * OpenSSL.
+ *
+ *   test_pk_cache [-b]
+ *
+ * With -b, the time taken by a signature verification is reported with the key
+ * in the cache, and with the cache flushed before each verification as when
+ * every certificate is signed by a different key.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/evp.h>
+#include <openssl/objects.h>
+#include <openssl/x509.h>
+
+/* The module is included to check the contents of the cache */
+#include "../../drivers/auth/mbedtls/mbedtls_crypto.c"
+
+#define NUM_KEYS		(MBEDTLS_PK_CACHE_ENTRIES + 1)
+#define DATA_SIZE		1024
+#define SIG_MAX_SIZE		80
+
+typedef struct test_key {
+	EVP_PKEY *pkey;
+	unsigned char *der;
+	int der_len;
+} test_key_t;
+
+/* AlgorithmIdentifier of ecdsa-with-SHA256 */
+static unsigned char sig_alg[] = {
+	0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02
+};
+
+static test_key_t keys[NUM_KEYS];
+static unsigned char data[DATA_SIZE];
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+static int make_key(test_key_t *key, int id)
+{
+	EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(id, NULL);
+
+	key->pkey = NULL;
+	if ((ctx == NULL) || (EVP_PKEY_keygen_init(ctx) <= 0) ||
+	    ((id == EVP_PKEY_EC) && (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx,
+					NID_X9_62_prime256v1) <= 0)) ||
+	    (EVP_PKEY_keygen(ctx, &key->pkey) <= 0))
+		key->pkey = NULL;
+	EVP_PKEY_CTX_free(ctx);
+	if (key->pkey == NULL)
+		return -1;
+
+	/* DER encoded SubjectPublicKeyInfo, as found in the certificates */
+	key->der = NULL;
+	key->der_len = i2d_PUBKEY(key->pkey, &key->der);
+	return (key->der_len > 0) ? 0 : -1;
+}
+
+static void free_key(test_key_t *key)
+{
+	OPENSSL_free(key->der);
+	EVP_PKEY_free(key->pkey);
+}
+
+/* Sign the data, the signature being a BIT STRING as in the certificates */
+static unsigned int sign(test_key_t *key, unsigned char *sig)
+{
+	EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+	size_t len = SIG_MAX_SIZE - 3;
+
+	if ((ctx == NULL) ||
+	    (EVP_DigestSignInit(ctx, NULL, EVP_sha256(), NULL,
+				key->pkey) <= 0) ||
+	    (EVP_DigestSign(ctx, sig + 3, &len, data, DATA_SIZE) <= 0))
+		len = 0;
+	EVP_MD_CTX_free(ctx);
+	if (len == 0)
+		return 0;
+
+	sig[0] = MBEDTLS_ASN1_BIT_STRING;
+	sig[1] = len + 1;
+	sig[2] = 0;
+	return len + 3;
+}
+
+static int verify(test_key_t *key, unsigned char *sig, unsigned int sig_len)
+{
+	return crypto_lib_desc.verify_signature(data, DATA_SIZE, sig, sig_len,
+						sig_alg, sizeof(sig_alg),
+						key->der, key->der_len);
+}
+
+static int is_cached(test_key_t *key)
+{
+	unsigned int i;
+
+	for (i = 0; i < MBEDTLS_PK_CACHE_ENTRIES; i++)
+		if ((pk_cache[i].valid != 0) &&
+		    (pk_cache[i].der_len == (unsigned int)key->der_len) &&
+		    (memcmp(pk_cache[i].der, key->der, key->der_len) == 0))
+			return 1;
+	return 0;
+}
+
+static unsigned int num_cached(void)
+{
+	unsigned int i, n = 0;
+
+	for (i = 0; i < MBEDTLS_PK_CACHE_ENTRIES; i++)
+		n += (pk_cache[i].valid != 0);
+	return n;
+}
+
+/* Valid signatures verify, with the key parsed or found in the cache */
+static void test_verify(void)
+{
+	unsigned char sig[SIG_MAX_SIZE];
+	unsigned int i, sig_len;
+	int rc;
+
+	for (i = 0; i < NUM_KEYS; i++) {
+		sig_len = sign(&keys[i], sig);
+		CHECK(sig_len != 0, "cannot sign with key %u", i);
+
+		pk_cache_flush();
+		rc = verify(&keys[i], sig, sig_len);
+		CHECK(rc == CRYPTO_SUCCESS, "key %u returned %d", i, rc);
+		CHECK(is_cached(&keys[i]), "key %u not cached", i);
+
+		rc = verify(&keys[i], sig, sig_len);
+		CHECK(rc == CRYPTO_SUCCESS, "cached key %u returned %d", i,
+		      rc);
+	}
+}
+
+/* Invalid signatures are rejected, with the key in the cache or not */
+static void test_bad_signature(void)
+{
+	unsigned char sig[SIG_MAX_SIZE];
+	unsigned int sig_len, cached;
+	int rc;
+
+	sig_len = sign(&keys[0], sig);
+	for (cached = 0; cached < 2; cached++) {
+		if (!cached)
+			pk_cache_flush();
+
+		rc = verify(&keys[1], sig, sig_len);
+		CHECK(rc == CRYPTO_ERR_SIGNATURE, "wrong key returned %d", rc);
+		CHECK(is_cached(&keys[1]), "wrong key not cached");
+
+		data[DATA_SIZE / 2] ^= 1;
+		rc = verify(&keys[0], sig, sig_len);
+		CHECK(rc == CRYPTO_ERR_SIGNATURE, "modified data returned %d",
+		      rc);
+		data[DATA_SIZE / 2] ^= 1;
+
+		sig[sig_len - 1] ^= 1;
+		rc = verify(&keys[0], sig, sig_len);
+		CHECK(rc == CRYPTO_ERR_SIGNATURE,
+		      "modified signature returned %d", rc);
+		sig[sig_len - 1] ^= 1;
+
+		rc = verify(&keys[0], sig, sig_len - 1);
+		CHECK(rc == CRYPTO_ERR_SIGNATURE,
+		      "truncated signature returned %d", rc);
+
+		rc = verify(&keys[0], sig, sig_len);
+		CHECK(rc == CRYPTO_SUCCESS, "signature returned %d", rc);
+	}
+}
+
+/* The least recently used key is replaced when the cache is full */
+static void test_eviction(void)
+{
+	unsigned char sig[NUM_KEYS][SIG_MAX_SIZE];
+	unsigned int i, sig_len[NUM_KEYS];
+
+	for (i = 0; i < NUM_KEYS; i++)
+		sig_len[i] = sign(&keys[i], sig[i]);
+
+	pk_cache_flush();
+	for (i = 0; i < MBEDTLS_PK_CACHE_ENTRIES; i++)
+		(void)verify(&keys[i], sig[i], sig_len[i]);
+	CHECK(num_cached() == MBEDTLS_PK_CACHE_ENTRIES, "%u keys cached",
+	      num_cached());
+
+	/* Use the first key again, so the second one is the oldest */
+	(void)verify(&keys[0], sig[0], sig_len[0]);
+	(void)verify(&keys[NUM_KEYS - 1], sig[NUM_KEYS - 1],
+		     sig_len[NUM_KEYS - 1]);
+
+	CHECK(is_cached(&keys[0]), "recently used key evicted");
+	CHECK(!is_cached(&keys[1]), "least recently used key kept");
+	CHECK(is_cached(&keys[NUM_KEYS - 1]), "new key not cached");
+	CHECK(num_cached() == MBEDTLS_PK_CACHE_ENTRIES, "%u keys cached",
+	      num_cached());
+}
+
+/*
+ * Keys which can't be cached are parsed for every verification, and flush the
+ * cache in case the heap has run out.
+ */
+static void test_uncached_keys(void)
+{
+	unsigned char sig[SIG_MAX_SIZE], bad_der[8] = { 0x30, 0x06 };
+	unsigned int sig_len;
+	test_key_t rsa_key, bad_key = { NULL, bad_der, sizeof(bad_der) };
+	int rc;
+
+	sig_len = sign(&keys[0], sig);
+	(void)verify(&keys[0], sig, sig_len);
+
+	rc = verify(&bad_key, sig, sig_len);
+	CHECK(rc == CRYPTO_ERR_SIGNATURE, "invalid key returned %d", rc);
+	CHECK(num_cached() == 0, "%u keys cached after an invalid key",
+	      num_cached());
+
+	if (make_key(&rsa_key, EVP_PKEY_RSA) != 0) {
+		CHECK(0, "cannot create the RSA key");
+		return;
+	}
+	(void)verify(&keys[0], sig, sig_len);
+	rc = verify(&rsa_key, sig, sig_len);
+	CHECK(rc == CRYPTO_ERR_SIGNATURE, "RSA key returned %d", rc);
+	CHECK(num_cached() == 0, "%u keys cached after an RSA key",
+	      num_cached());
+	free_key(&rsa_key);
+
+	rc = verify(&keys[0], sig, sig_len);
+	CHECK(rc == CRYPTO_SUCCESS, "signature returned %d", rc);
+}
+
+#define BENCH_ITER	1000
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double bench(int flush)
+{
+	unsigned char sig[SIG_MAX_SIZE];
+	unsigned int sig_len, iter;
+	double start;
+
+	sig_len = sign(&keys[0], sig);
+	pk_cache_flush();
+
+	start = now();
+	for (iter = 0; iter < BENCH_ITER; iter++) {
+		if (flush)
+			pk_cache_flush();
+		if (verify(&keys[0], sig, sig_len) != CRYPTO_SUCCESS)
+			return 0;
+	}
+	return (now() - start) * 1e6 / BENCH_ITER;
+}
+
+static void run_bench(void)
+{
+	double cached, flushed;
+
+	cached = bench(0);
+	flushed = bench(1);
+	printf("%-24s %10s\n", "key", "us");
+	printf("%-24s %10.1f\n", "cached", cached);
+	printf("%-24s %10.1f\n", "flushed", flushed);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int i;
+	int do_bench = (argc > 1) && (strcmp(argv[1], "-b") == 0);
+
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (i = 0; i < NUM_KEYS; i++) {
+		if (make_key(&keys[i], EVP_PKEY_EC) != 0) {
+			printf("Cannot create the keys\n");
+			return 1;
+		}
+	}
+	for (i = 0; i < DATA_SIZE; i++)
+		data[i] = (unsigned char)(i * 13);
+	crypto_lib_desc.init();
+
+	test_verify();
+	test_bad_signature();
+	test_eviction();
+	test_uncached_keys();
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("pk_cache: all tests passed\n");
+
+	if (do_bench)
+		run_bench();
+
+	for (i = 0; i < NUM_KEYS; i++)
+		free_key(&keys[i]);
+	return 0;
+}
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests and benchmark of the PSCI state coordination of CPU_SUSPEND and CPU_OFF
+ * (lib/psci/psci_common.c with HW_ASSISTED_COHERENCY=1), with the locks of all
+ * the power domains up to the target level acquired beforehand, and with
+ * PSCI_INCREMENTAL_LOCKING. Each cpu of the topology of platform_def.h is a
+ * thread, which calls the coordination as psci_cpu_suspend_start() does and
+ * wakes up as psci_power_up_finish() does.
+ *
+ *   test_psci_locking [-b]
+ *
+ * With -b, the time taken by a suspend and wake up cycle of all the cpus
+ * running concurrently is reported for both locking schemes.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <cpu_data.h>
+#include <platform.h>
+#include <psci.h>
+
+#include "../../lib/psci/psci_private.h"
+
+#define NUM_LOCK_MODES		2
+#define STRESS_CYCLES		2000
+
+#define SYSTEM_NODE		0
+#define CLUSTER_NODE(cpu)	(1 + (cpu) / PLATFORM_CORES_PER_CLUSTER)
+
+static const char * const lock_mode_names[NUM_LOCK_MODES] = {
+	"all levels", "incremental"
+};
+
+static cpu_data_t cpu_data[PLATFORM_CORE_COUNT];
+static __thread unsigned int this_cpu;
+
+/* Whether each cpu runs, i.e. has woken up and not yet started to suspend */
+static int running[PLATFORM_CORE_COUNT];
+
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			__atomic_add_fetch(&failures, 1,		\
+					   __ATOMIC_RELAXED);		\
+		}							\
+	} while (0)
+
+/* Platform and firmware interfaces used by the coordination */
+unsigned int psci_caps;
+
+unsigned int plat_my_core_pos(void)
+{
+	return this_cpu;
+}
+
+int plat_core_pos_by_mpidr(u_register_t mpidr)
+{
+	return -1;
+}
+
+uint64_t read_tpidr_el3(void)
+{
+	return (uintptr_t)&cpu_data[this_cpu];
+}
+
+cpu_data_t *_cpu_data_by_index(uint32_t cpu_index)
+{
+	return &cpu_data[cpu_index];
+}
+
+/*
+ * The deepest state requested by all the cpus, as the default one does. The
+ * cpu yields half of the time, so that the other ones run while it coordinates
+ * even if the host has fewer cpus.
+ */
+plat_local_state_t plat_get_target_pwr_state(unsigned int lvl,
+					     const plat_local_state_t *states,
+					     unsigned int ncpu)
+{
+	plat_local_state_t target = PLAT_MAX_OFF_STATE;
+	static __thread unsigned int seed;
+
+	if (rand_r(&seed) % 2 == 0)
+		sched_yield();
+
+	while (ncpu-- != 0)
+		if (*states < target)
+			target = *states++;
+		else
+			states++;
+
+	return target;
+}
+
+uint64_t read_scr_el3(void)
+{
+	return 0;
+}
+
+uint64_t read_sctlr_el1(void)
+{
+	return 0;
+}
+
+uint64_t read_sctlr_el2(void)
+{
+	return 0;
+}
+
+void prepare_cpu_pwr_dwn(unsigned int power_level)
+{
+	abort();
+}
+
+void psci_cpu_on_finish(unsigned int cpu_idx, psci_power_state_t *state_info)
+{
+	abort();
+}
+
+void psci_cpu_suspend_finish(unsigned int cpu_idx,
+			     psci_power_state_t *state_info)
+{
+	abort();
+}
+
+/* One system containing the clusters, as populated by psci_setup() */
+static void init_topology(void)
+{
+	unsigned int i;
+
+	memset(psci_non_cpu_pd_nodes, 0, sizeof(psci_non_cpu_pd_nodes));
+	memset(psci_locks, 0, sizeof(psci_locks));
+
+	psci_non_cpu_pd_nodes[SYSTEM_NODE].cpu_start_idx = 0;
+	psci_non_cpu_pd_nodes[SYSTEM_NODE].ncpus = PLATFORM_CORE_COUNT;
+	psci_non_cpu_pd_nodes[SYSTEM_NODE].level = 2;
+
+	for (i = 0; i < PLATFORM_CLUSTER_COUNT; i++) {
+		psci_non_cpu_pd_nodes[1 + i].cpu_start_idx =
+			i * PLATFORM_CORES_PER_CLUSTER;
+		psci_non_cpu_pd_nodes[1 + i].ncpus = PLATFORM_CORES_PER_CLUSTER;
+		psci_non_cpu_pd_nodes[1 + i].parent_node = SYSTEM_NODE;
+		psci_non_cpu_pd_nodes[1 + i].level = 1;
+	}
+
+	for (i = 0; i < PSCI_NUM_NON_CPU_PWR_DOMAINS; i++) {
+		psci_non_cpu_pd_nodes[i].local_state = PLAT_MAX_OFF_STATE;
+		psci_lock_init(psci_non_cpu_pd_nodes, i);
+	}
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		psci_cpu_pd_nodes[i].parent_node = CLUSTER_NODE(i);
+		running[i] = 0;
+	}
+
+	psci_init_req_local_pwr_states();
+}
+
+static int locks_free(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PSCI_NUM_NON_CPU_PWR_DOMAINS; i++)
+		if (psci_locks[i].lock != 0)
+			return 0;
+	return 1;
+}
+
+/*
+ * Coordinate the power down of this cpu up to `end_lvl` and return the target
+ * states and the highest level whose lock has been held.
+ */
+static unsigned int suspend(unsigned int end_lvl, int mode,
+			    psci_power_state_t *state_info)
+{
+	unsigned int lvl, lock_lvl, node, cpu;
+
+	for (lvl = PSCI_CPU_PWR_LVL; lvl <= PLAT_MAX_PWR_LVL; lvl++)
+		state_info->pwr_domain_state[lvl] = (lvl <= end_lvl) ?
+			PLAT_MAX_OFF_STATE : PSCI_LOCAL_STATE_RUN;
+
+	__atomic_store_n(&running[this_cpu], 0, __ATOMIC_SEQ_CST);
+
+	if (mode != 0) {
+		lock_lvl = psci_do_state_coordination_locked(end_lvl,
+							     state_info);
+	} else {
+		psci_acquire_pwr_domain_locks(end_lvl, this_cpu);
+		psci_do_state_coordination(end_lvl, state_info);
+		lock_lvl = end_lvl;
+	}
+
+	/*
+	 * The locks still held protect the domains powered down by this cpu
+	 * from the cpus waking up: none of their cpus can be running.
+	 */
+	node = CLUSTER_NODE(this_cpu);
+	for (lvl = PSCI_CPU_PWR_LVL + 1; lvl <= lock_lvl; lvl++) {
+		CHECK(psci_locks[node].lock != 0, "level %u lock not held by "
+		      "cpu %u", lvl, this_cpu);
+		if (is_local_state_run(state_info->pwr_domain_state[lvl]))
+			break;
+		for (cpu = psci_non_cpu_pd_nodes[node].cpu_start_idx;
+		     cpu < psci_non_cpu_pd_nodes[node].cpu_start_idx +
+		     psci_non_cpu_pd_nodes[node].ncpus; cpu++)
+			CHECK(__atomic_load_n(&running[cpu],
+					      __ATOMIC_SEQ_CST) == 0,
+			      "level %u powered down by cpu %u with cpu %u "
+			      "running", lvl, this_cpu, cpu);
+		CHECK(psci_non_cpu_pd_nodes[node].local_state ==
+		      state_info->pwr_domain_state[lvl],
+		      "level %u node state %u instead of %u", lvl,
+		      psci_non_cpu_pd_nodes[node].local_state,
+		      state_info->pwr_domain_state[lvl]);
+		node = psci_non_cpu_pd_nodes[node].parent_node;
+	}
+
+	/* The levels above the lock level are left running */
+	for (lvl = lock_lvl + 1; lvl <= PLAT_MAX_PWR_LVL; lvl++)
+		CHECK(is_local_state_run(state_info->pwr_domain_state[lvl]),
+		      "level %u above lock level %u not running", lvl,
+		      lock_lvl);
+
+	psci_release_pwr_domain_locks(lock_lvl, this_cpu);
+
+	return lock_lvl;
+}
+
+/* Wake this cpu up, with the locks of all the levels held */
+static void wake_up(void)
+{
+	unsigned int lvl, node;
+
+	psci_acquire_pwr_domain_locks(PLAT_MAX_PWR_LVL, this_cpu);
+
+	__atomic_store_n(&running[this_cpu], 1, __ATOMIC_SEQ_CST);
+	psci_set_pwr_domains_to_run(PLAT_MAX_PWR_LVL);
+
+	node = CLUSTER_NODE(this_cpu);
+	for (lvl = PSCI_CPU_PWR_LVL + 1; lvl <= PLAT_MAX_PWR_LVL; lvl++) {
+		CHECK(is_local_state_run(psci_non_cpu_pd_nodes[node].local_state),
+		      "level %u not running after wake up", lvl);
+		node = psci_non_cpu_pd_nodes[node].parent_node;
+	}
+
+	psci_release_pwr_domain_locks(PLAT_MAX_PWR_LVL, this_cpu);
+}
+
+/*
+ * The cpus power down one after the other: only the last cpu of a cluster
+ * powers it down, and only the last cpu of the system powers the system down.
+ * With incremental locking, the other cpus only take their cluster lock.
+ */
+static void test_last_cpu(int mode)
+{
+	psci_power_state_t state_info;
+	unsigned int cpu, lock_lvl, last_in_cluster;
+
+	init_topology();
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		this_cpu = cpu;
+		wake_up();
+	}
+
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		this_cpu = cpu;
+		lock_lvl = suspend(PLAT_MAX_PWR_LVL, mode, &state_info);
+
+		last_in_cluster = ((cpu + 1) % PLATFORM_CORES_PER_CLUSTER) == 0;
+		CHECK(is_local_state_off(state_info.pwr_domain_state[1]) ==
+		      last_in_cluster, "%s: cpu %u cluster state %u",
+		      lock_mode_names[mode], cpu,
+		      state_info.pwr_domain_state[1]);
+		CHECK(is_local_state_off(state_info.pwr_domain_state[2]) ==
+		      (cpu == PLATFORM_CORE_COUNT - 1),
+		      "%s: cpu %u system state %u", lock_mode_names[mode], cpu,
+		      state_info.pwr_domain_state[2]);
+		CHECK(lock_lvl == ((mode == 0 || last_in_cluster) ? 2U : 1U),
+		      "%s: cpu %u held the locks up to level %u",
+		      lock_mode_names[mode], cpu, lock_lvl);
+		CHECK(locks_free(), "%s: lock held after cpu %u",
+		      lock_mode_names[mode], cpu);
+	}
+
+	/* A cpu waking up alone only powers up its own cluster */
+	this_cpu = 5;
+	wake_up();
+	CHECK(is_local_state_run(
+		psci_non_cpu_pd_nodes[CLUSTER_NODE(5)].local_state) &&
+	      is_local_state_run(psci_non_cpu_pd_nodes[SYSTEM_NODE].local_state),
+	      "%s: domains of the cpu not running", lock_mode_names[mode]);
+	CHECK(is_local_state_off(
+		psci_non_cpu_pd_nodes[CLUSTER_NODE(0)].local_state),
+	      "%s: other cluster running", lock_mode_names[mode]);
+
+	lock_lvl = suspend(1, mode, &state_info);
+	CHECK(is_local_state_off(state_info.pwr_domain_state[1]) &&
+	      (lock_lvl == 1), "%s: cluster state %u, lock level %u",
+	      lock_mode_names[mode], state_info.pwr_domain_state[1], lock_lvl);
+}
+
+struct stress_args {
+	unsigned int cpu;
+	int mode;
+	unsigned int cycles;
+};
+
+static void *stress_cpu(void *arg)
+{
+	struct stress_args *args = arg;
+	psci_power_state_t state_info;
+	unsigned int seed = args->cpu + 1, i;
+
+	this_cpu = args->cpu;
+	for (i = 0; i < args->cycles; i++) {
+		(void)suspend(1 + rand_r(&seed) % PLAT_MAX_PWR_LVL, args->mode,
+			      &state_info);
+		if (rand_r(&seed) % 4 == 0)
+			sched_yield();
+		wake_up();
+	}
+
+	return NULL;
+}
+
+/* Run the suspend and wake up cycles of all the cpus concurrently */
+static double run_cpus(int mode, unsigned int cycles)
+{
+	pthread_t threads[PLATFORM_CORE_COUNT];
+	struct stress_args args[PLATFORM_CORE_COUNT];
+	struct timespec start, end;
+	unsigned int cpu;
+
+	init_topology();
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		this_cpu = cpu;
+		wake_up();
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		args[cpu].cpu = cpu;
+		args[cpu].mode = mode;
+		args[cpu].cycles = cycles;
+		if (pthread_create(&threads[cpu], NULL, stress_cpu,
+				   &args[cpu]) != 0) {
+			CHECK(0, "cannot create thread %u", cpu);
+			return 0;
+		}
+	}
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++)
+		pthread_join(threads[cpu], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return ((end.tv_sec - start.tv_sec) * 1e9 +
+		(end.tv_nsec - start.tv_nsec)) / cycles;
+}
+
+/*
+ * Concurrent suspend and wake up storms. Once they are over, all the domains
+ * must be running and power down as expected again.
+ */
+static void test_stress(int mode)
+{
+	unsigned int node;
+
+	run_cpus(mode, STRESS_CYCLES);
+
+	CHECK(locks_free(), "%s: lock held after the stress",
+	      lock_mode_names[mode]);
+	for (node = 0; node < PSCI_NUM_NON_CPU_PWR_DOMAINS; node++)
+		CHECK(is_local_state_run(psci_non_cpu_pd_nodes[node].local_state),
+		      "%s: node %u not running after the stress",
+		      lock_mode_names[mode], node);
+}
+
+static void run_bench(void)
+{
+	int mode;
+
+	printf("%-24s %10s\n", "locking", "ns");
+	for (mode = 0; mode < NUM_LOCK_MODES; mode++)
+		printf("%-24s %10.0f\n", lock_mode_names[mode],
+		       run_cpus(mode, STRESS_CYCLES));
+}
+
+int main(int argc, char *argv[])
+{
+	int do_bench = (argc > 1) && (strcmp(argv[1], "-b") == 0);
+	int mode;
+
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (mode = 0; mode < NUM_LOCK_MODES; mode++) {
+		test_last_cpu(mode);
+		test_stress(mode);
+		test_last_cpu(mode);
+	}
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("psci_locking: all tests passed\n");
+
+	if (do_bench)
+		run_bench();
+
+	return 0;
+}
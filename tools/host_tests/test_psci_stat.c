@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the residency and latency histograms of the PSCI stats
+ * (lib/psci/psci_stat.c with ENABLE_PSCI_STAT_HIST=1), for the topology of
+ * platform_def.h. The tests go through the power down and wake up of the cpus
+ * as psci_cpu_suspend_start() and psci_power_up_finish() do, with an emulated
+ * system counter and platform residencies, and read the histograms with
+ * psci_stat_hist(). The histograms can't be cleared, so each test uses cpus of
+ * its own.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <platform.h>
+#include <psci.h>
+
+#include "../../lib/psci/psci_private.h"
+
+/* 50 ticks of the system counter per microsecond */
+#define CNTFRQ			50000000
+#define TICKS_PER_US		(CNTFRQ / 1000000)
+
+#define SYSTEM_NODE		0
+#define CLUSTER_NODE(cpu)	(1 + (cpu) / PLATFORM_CORES_PER_CLUSTER)
+
+#define MPIDR(cpu)		((((cpu) / PLATFORM_CORES_PER_CLUSTER) << 8) | \
+				 ((cpu) % PLATFORM_CORES_PER_CLUSTER))
+
+/*
+ * Power state parameter of the tests: the local state of power level n in
+ * bits[4n+3:4n]
+ */
+#define PSTATE(l0, l1, l2)	((l0) | ((l1) << 4) | ((l2) << 8))
+#define OFF			PLAT_MAX_OFF_STATE
+#define RET			PLAT_MAX_RET_STATE
+#define RUN			PSCI_LOCAL_STATE_RUN
+
+/* Bad power state parameter */
+#define PSTATE_INVALID		0xffff
+
+/* Emulated cpu and platform */
+static unsigned int cur_cpu;
+static uint64_t cntpct;
+static u_register_t plat_residency[PLAT_MAX_PWR_LVL + 1];
+static u_register_t residency_error;
+
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+/* Platform and firmware interfaces used by the stats */
+non_cpu_pd_node_t psci_non_cpu_pd_nodes[PSCI_NUM_NON_CPU_PWR_DOMAINS];
+cpu_pd_node_t psci_cpu_pd_nodes[PLATFORM_CORE_COUNT];
+
+static int translate_power_state(u_register_t mpidr, unsigned int power_state,
+				 psci_power_state_t *state_info)
+{
+	unsigned int lvl;
+
+	if (power_state == PSTATE_INVALID)
+		return PSCI_E_INVALID_PARAMS;
+
+	for (lvl = PSCI_CPU_PWR_LVL; lvl <= PLAT_MAX_PWR_LVL; lvl++)
+		state_info->pwr_domain_state[lvl] =
+			(power_state >> (lvl * 4)) & 0xf;
+
+	return PSCI_E_SUCCESS;
+}
+
+static const plat_psci_ops_t plat_psci_ops = {
+	.translate_power_state_by_mpidr = translate_power_state,
+};
+
+const plat_psci_ops_t *psci_plat_pm_ops = &plat_psci_ops;
+
+/* Not used, as the platform translates the power states */
+int psci_validate_power_state(unsigned int power_state,
+			      psci_power_state_t *state_info)
+{
+	abort();
+}
+
+/* As in psci_common.c */
+unsigned int psci_find_target_suspend_lvl(const psci_power_state_t *state_info)
+{
+	int i;
+
+	for (i = PLAT_MAX_PWR_LVL; i >= PSCI_CPU_PWR_LVL; i--) {
+		if (!is_local_state_run(state_info->pwr_domain_state[i]))
+			return i;
+	}
+
+	return PSCI_INVALID_PWR_LVL;
+}
+
+u_register_t plat_psci_stat_get_residency(unsigned int lvl,
+					  const psci_power_state_t *state_info,
+					  int last_cpu_index)
+{
+	return plat_residency[lvl];
+}
+
+unsigned int plat_my_core_pos(void)
+{
+	return cur_cpu;
+}
+
+int plat_core_pos_by_mpidr(u_register_t mpidr)
+{
+	unsigned int cluster = (mpidr >> 8) & 0xff;
+	unsigned int core = mpidr & 0xff;
+
+	if ((mpidr & ~0xffffULL) || (cluster >= PLATFORM_CLUSTER_COUNT) ||
+	    (core >= PLATFORM_CORES_PER_CLUSTER))
+		return -1;
+
+	return cluster * PLATFORM_CORES_PER_CLUSTER + core;
+}
+
+uint64_t read_cntpct_el0(void)
+{
+	return cntpct;
+}
+
+uint64_t read_cntfrq_el0(void)
+{
+	return CNTFRQ;
+}
+
+/* One system containing the clusters, as populated by psci_setup() */
+static void init_topology(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PLATFORM_CLUSTER_COUNT; i++)
+		psci_non_cpu_pd_nodes[1 + i].parent_node = SYSTEM_NODE;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		psci_cpu_pd_nodes[i].parent_node = CLUSTER_NODE(i);
+}
+
+/*
+ * Suspend the cpu `cpu` to the states of `power_state`. It starts to power
+ * down at `start`, wakes up after `entry` + `residency` microseconds and
+ * updates the stats `exit` microseconds later. The platform accounts for
+ * `residency` + `residency_error` microseconds at each level.
+ */
+static void suspend(unsigned int cpu, unsigned int power_state,
+		    unsigned long long start, u_register_t entry,
+		    u_register_t residency, u_register_t exit)
+{
+	psci_power_state_t state_info;
+	unsigned int lvl, end_lvl;
+
+	translate_power_state(MPIDR(cpu), power_state, &state_info);
+	end_lvl = psci_find_target_suspend_lvl(&state_info);
+	for (lvl = PSCI_CPU_PWR_LVL; lvl <= PLAT_MAX_PWR_LVL; lvl++)
+		plat_residency[lvl] = residency + residency_error;
+
+	cur_cpu = cpu;
+	cntpct = start;
+	psci_stats_update_pwr_down(end_lvl, &state_info);
+
+	cntpct += (entry + residency) * TICKS_PER_US;
+	psci_stats_mark_wakeup();
+
+	cntpct += exit * TICKS_PER_US;
+	psci_stats_update_pwr_up(end_lvl, &state_info);
+}
+
+static u_register_t hist(unsigned int cpu, unsigned int power_state,
+			 unsigned int hist, unsigned int bucket)
+{
+	return psci_stat_hist(MPIDR(cpu), power_state, hist, bucket);
+}
+
+/* Sum of the buckets of a histogram */
+static u_register_t hist_total(unsigned int cpu, unsigned int power_state,
+			       unsigned int hist_id)
+{
+	u_register_t total = 0;
+	unsigned int bucket;
+
+	for (bucket = 0; bucket < PSCI_STAT_HIST_BUCKETS; bucket++)
+		total += hist(cpu, power_state, hist_id, bucket);
+
+	return total;
+}
+
+/*
+ * Bucket 0 holds the values lower than 1us, bucket n those in [2^(n-1), 2^n)
+ * and the last one all above
+ */
+static void test_buckets(void)
+{
+	static const struct {
+		u_register_t us;
+		unsigned int bucket;
+	} cases[] = {
+		{ 0, 0 }, { 1, 1 }, { 2, 2 }, { 3, 2 }, { 4, 3 }, { 1000, 10 },
+		{ 1023, 10 }, { 1024, 11 },
+		{ (1UL << (PSCI_STAT_HIST_BUCKETS - 2)) - 1,
+		  PSCI_STAT_HIST_BUCKETS - 2 },
+		{ 1UL << (PSCI_STAT_HIST_BUCKETS - 2),
+		  PSCI_STAT_HIST_BUCKETS - 1 },
+		{ 1UL << 40, PSCI_STAT_HIST_BUCKETS - 1 },
+	};
+	unsigned int i, cpu;
+	unsigned int pstate = PSTATE(OFF, RUN, RUN);
+	u_register_t before;
+
+	for (i = 0; i < ARRAY_SIZE(cases); i++) {
+		cpu = i % PLATFORM_CORE_COUNT;
+		before = hist(cpu, pstate, PSCI_STAT_HIST_RESIDENCY,
+			      cases[i].bucket);
+		suspend(cpu, pstate, 1000, 0, cases[i].us, 0);
+		CHECK(hist(cpu, pstate, PSCI_STAT_HIST_RESIDENCY,
+			   cases[i].bucket) == before + 1,
+		      "residency of %lu us not in bucket %u",
+		      (unsigned long)cases[i].us, cases[i].bucket);
+	}
+}
+
+/*
+ * The residency of each power domain which was powered down is counted, and the
+ * latencies of the transition are counted against its highest level.
+ */
+static void test_cluster_suspend(void)
+{
+	unsigned int cpu = 13, other = 14;
+	unsigned int cpu_off = PSTATE(OFF, RUN, RUN);
+	unsigned int cluster_off = PSTATE(OFF, OFF, RUN);
+	unsigned int cpu_ret = PSTATE(RET, RUN, RUN);
+
+	/* 100us to power down, 3000us of residency, 20us to wake up */
+	suspend(cpu, cluster_off, 50000, 100, 3000, 20);
+
+	CHECK(hist(cpu, cpu_off, PSCI_STAT_HIST_RESIDENCY, 12) == 1,
+	      "cpu residency");
+	CHECK(hist(cpu, cluster_off, PSCI_STAT_HIST_RESIDENCY, 12) == 1,
+	      "cluster residency");
+	CHECK(hist(other, cluster_off, PSCI_STAT_HIST_RESIDENCY, 12) == 1,
+	      "cluster residency read through another cpu");
+	CHECK(hist_total(cpu, cpu_ret, PSCI_STAT_HIST_RESIDENCY) == 0,
+	      "cpu retention residency");
+
+	CHECK(hist(cpu, cluster_off, PSCI_STAT_HIST_ENTRY_LATENCY, 7) == 1,
+	      "cluster entry latency");
+	CHECK(hist(cpu, cluster_off, PSCI_STAT_HIST_EXIT_LATENCY, 5) == 1,
+	      "cluster exit latency");
+	CHECK(hist_total(cpu, cpu_off, PSCI_STAT_HIST_ENTRY_LATENCY) == 0,
+	      "cpu entry latency of a cluster suspend");
+	CHECK(hist_total(cpu, cpu_off, PSCI_STAT_HIST_EXIT_LATENCY) == 0,
+	      "cpu exit latency of a cluster suspend");
+	CHECK(hist_total(other, cluster_off, PSCI_STAT_HIST_ENTRY_LATENCY) == 0,
+	      "entry latency of the other cpu");
+
+	/* Retention of the cpu only, with a quick entry */
+	suspend(cpu, cpu_ret, 90000, 0, 10, 1);
+	CHECK(hist(cpu, cpu_ret, PSCI_STAT_HIST_RESIDENCY, 4) == 1,
+	      "cpu retention residency");
+	CHECK(hist(cpu, cpu_ret, PSCI_STAT_HIST_ENTRY_LATENCY, 0) == 1,
+	      "cpu retention entry latency");
+	CHECK(hist(cpu, cpu_ret, PSCI_STAT_HIST_EXIT_LATENCY, 1) == 1,
+	      "cpu retention exit latency");
+	CHECK(hist_total(cpu, cluster_off, PSCI_STAT_HIST_ENTRY_LATENCY) == 1,
+	      "cluster entry latency after a retention");
+
+	/* The PSCI_STAT_COUNT of the states agrees with the histograms */
+	CHECK(psci_stat_count(MPIDR(cpu), cluster_off) ==
+	      hist_total(cpu, cluster_off, PSCI_STAT_HIST_RESIDENCY),
+	      "cluster count %lu",
+	      (unsigned long)psci_stat_count(MPIDR(cpu), cluster_off));
+}
+
+/*
+ * A residency reported by the platform beyond the transition time, e.g. with
+ * a coarser timer, does not make the entry latency wrap
+ */
+static void test_residency_beyond_transition(void)
+{
+	unsigned int cpu = 11, pstate = PSTATE(OFF, RUN, RUN);
+
+	residency_error = 300;
+	suspend(cpu, pstate, 70000, 100, 500, 0);
+	residency_error = 0;
+
+	CHECK(hist(cpu, pstate, PSCI_STAT_HIST_ENTRY_LATENCY, 0) == 1,
+	      "entry latency not 0");
+}
+
+/* No latency is counted on a power on without a power down */
+static void test_power_on(void)
+{
+	psci_power_state_t state_info;
+	unsigned int cpu = 12, pstate = PSTATE(OFF, RUN, RUN);
+
+	translate_power_state(MPIDR(cpu), pstate, &state_info);
+	cur_cpu = cpu;
+	cntpct = 80000;
+	psci_stats_mark_wakeup();
+	cntpct += 100 * TICKS_PER_US;
+	psci_stats_update_pwr_up(PSCI_CPU_PWR_LVL, &state_info);
+
+	CHECK(hist_total(cpu, pstate, PSCI_STAT_HIST_RESIDENCY) == 1,
+	      "residency not counted");
+	CHECK(hist_total(cpu, pstate, PSCI_STAT_HIST_ENTRY_LATENCY) == 0,
+	      "entry latency counted");
+	CHECK(hist_total(cpu, pstate, PSCI_STAT_HIST_EXIT_LATENCY) == 0,
+	      "exit latency counted");
+
+	/* The next suspend counts them */
+	suspend(cpu, pstate, 90000, 2, 10, 2);
+	CHECK(hist_total(cpu, pstate, PSCI_STAT_HIST_ENTRY_LATENCY) == 1,
+	      "entry latency of the next suspend");
+	CHECK(hist_total(cpu, pstate, PSCI_STAT_HIST_EXIT_LATENCY) == 1,
+	      "exit latency of the next suspend");
+
+	/* But not the next power on */
+	psci_stats_mark_wakeup();
+	psci_stats_update_pwr_up(PSCI_CPU_PWR_LVL, &state_info);
+	CHECK(hist_total(cpu, pstate, PSCI_STAT_HIST_ENTRY_LATENCY) == 1,
+	      "entry latency of a power on after a suspend");
+}
+
+/* The arguments of the SiP call are checked */
+static void test_bad_args(void)
+{
+	unsigned int cpu = 15, pstate = PSTATE(OFF, RUN, RUN);
+	unsigned int ret_pstate = PSTATE(RET, RUN, RUN);
+
+	suspend(cpu, pstate, 1000, 0, 0, 0);
+	CHECK(hist(cpu, pstate, PSCI_STAT_HIST_RESIDENCY, 0) == 1,
+	      "residency not counted");
+
+	/* The first bucket of the off state follows the retention ones */
+	CHECK(hist(cpu, ret_pstate, PSCI_STAT_HIST_RESIDENCY,
+		   PSCI_STAT_HIST_BUCKETS) == 0, "bucket out of range");
+	CHECK(hist(cpu, pstate, PSCI_STAT_HIST_EXIT_LATENCY + 1, 0) == 0,
+	      "unknown histogram");
+	CHECK(hist(cpu, PSTATE_INVALID, PSCI_STAT_HIST_RESIDENCY, 0) == 0,
+	      "invalid power state");
+	CHECK(psci_stat_hist(0x10002, pstate, PSCI_STAT_HIST_RESIDENCY, 0) == 0,
+	      "MPIDR of no cpu");
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	init_topology();
+
+	test_buckets();
+	test_cluster_suspend();
+	test_residency_beyond_transition();
+	test_power_on();
+	test_bad_args();
+
+	if (failures) {
+		printf("psci_stat: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("psci_stat: all tests passed\n");
+	return 0;
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests and benchmark of the direct SMC function id table of the runtime
+ * service framework (common/runtime_svc.c with RT_SVC_FAST_DISPATCH=1). The
+ * services and leaf handlers are registered with the firmware macros, the
+ * linker sections being delimited by the symbols of the host linker.
+ *
+ *   test_runtime_svc [-b]
+ *
+ * With -b, the time taken by handle_runtime_svc() to dispatch an SMC to a leaf
+ * handler is reported with the function id in the table, and with the table
+ * empty so that the SMC goes through the top level handler of the service.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <runtime_svc.h>
+#include <smcc.h>
+#include <utils_def.h>
+
+/* Table of runtime_svc.c, only accessed by smc_handler64 in the firmware */
+extern rt_svc_fid_entry_t rt_svc_fid_table[RT_SVC_FID_TABLE_SIZE];
+
+#define STD_FID(n)		(0x84000000U | (n))
+#define SIP_FID(n)		(0x82000000U | (n))
+
+/* Leaf handlers */
+#define FID_VERSION		STD_FID(0x00)
+#define FID_FEATURES		STD_FID(0x0a)
+#define FID_SIP_QUERY		SIP_FID(0x10)
+
+/* Same entry of the table as FID_VERSION */
+#define FID_COLLIDING		STD_FID(0x40)
+
+/* Only handled by the top level handler */
+#define FID_OTHER		STD_FID(0x03)
+
+enum { NONE, LEAF_VERSION, LEAF_FEATURES, LEAF_COLLIDING, LEAF_SIP, STD_TOP,
+	SIP_TOP };
+
+static cpu_context_t ctx;
+static int called;
+static u_register_t args[4];
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+#define LEAF_HANDLER(_name, _id)					\
+static uintptr_t _name(uint32_t smc_fid, u_register_t x1,		\
+		       u_register_t x2, u_register_t x3, u_register_t x4, \
+		       void *cookie, void *handle, u_register_t flags)	\
+{									\
+	called = _id;							\
+	args[0] = x1;							\
+	args[1] = x2;							\
+	args[2] = x3;							\
+	args[3] = x4;							\
+	SMC_RET1(handle, smc_fid ^ x1);					\
+}
+
+LEAF_HANDLER(leaf_version, LEAF_VERSION)
+LEAF_HANDLER(leaf_features, LEAF_FEATURES)
+LEAF_HANDLER(leaf_colliding, LEAF_COLLIDING)
+LEAF_HANDLER(leaf_sip, LEAF_SIP)
+
+/* Top level handler dispatching on the function id, like the PSCI one */
+static uintptr_t std_handler(uint32_t smc_fid, u_register_t x1,
+			     u_register_t x2, u_register_t x3, u_register_t x4,
+			     void *cookie, void *handle, u_register_t flags)
+{
+	switch (smc_fid) {
+	case FID_VERSION:
+		return leaf_version(smc_fid, x1, x2, x3, x4, cookie, handle,
+				    flags);
+	case FID_FEATURES:
+		return leaf_features(smc_fid, x1, x2, x3, x4, cookie, handle,
+				     flags);
+	case FID_COLLIDING:
+		return leaf_colliding(smc_fid, x1, x2, x3, x4, cookie, handle,
+				      flags);
+	case STD_FID(0x01):
+	case STD_FID(0x02):
+	case STD_FID(0x04):
+	case STD_FID(0x05):
+	case STD_FID(0x06):
+	case STD_FID(0x07):
+	case STD_FID(0x08):
+	case STD_FID(0x09):
+	case STD_FID(0x0b):
+	case STD_FID(0x0c):
+	case STD_FID(0x0d):
+	case STD_FID(0x0e):
+	case STD_FID(0x0f):
+	case STD_FID(0x10):
+	case STD_FID(0x11):
+	case FID_OTHER:
+		called = STD_TOP;
+		SMC_RET1(handle, 0);
+	default:
+		break;
+	}
+
+	called = STD_TOP;
+	SMC_RET1(handle, SMC_UNK);
+}
+
+static int32_t sip_setup(void)
+{
+	/* The leaf handlers of a service which fails to initialise are unused */
+	return -1;
+}
+
+static uintptr_t sip_handler(uint32_t smc_fid, u_register_t x1,
+			     u_register_t x2, u_register_t x3, u_register_t x4,
+			     void *cookie, void *handle, u_register_t flags)
+{
+	called = SIP_TOP;
+	SMC_RET1(handle, 0);
+}
+
+DECLARE_RT_SVC(test_std, OEN_STD_START, OEN_STD_END, SMC_TYPE_FAST, NULL,
+	       std_handler);
+DECLARE_RT_SVC(test_sip, OEN_SIP_START, OEN_SIP_END, SMC_TYPE_FAST,
+	       sip_setup, sip_handler);
+
+DECLARE_RT_SVC_FID(version, FID_VERSION, leaf_version);
+DECLARE_RT_SVC_FID_LIGHT(features, FID_FEATURES, leaf_features);
+DECLARE_RT_SVC_FID(colliding, FID_COLLIDING, leaf_colliding);
+DECLARE_RT_SVC_FID(sip_query, FID_SIP_QUERY, leaf_sip);
+
+/* Issue an SMC with x1-x4 set, return the value left in x0 */
+static u_register_t smc(uint32_t fid)
+{
+	gp_regs_t *regs = get_gpregs_ctx(&ctx);
+	uintptr_t handle;
+
+	write_ctx_reg(regs, CTX_GPREG_X1, fid + 1);
+	write_ctx_reg(regs, CTX_GPREG_X2, fid + 2);
+	write_ctx_reg(regs, CTX_GPREG_X3, fid + 3);
+	write_ctx_reg(regs, CTX_GPREG_X4, fid + 4);
+	called = NONE;
+
+	handle = handle_runtime_svc(fid, NULL, &ctx, SMC_FROM_NON_SECURE);
+	CHECK(handle == (uintptr_t)&ctx, "SMC 0x%x returned handle 0x%lx", fid,
+	      (unsigned long)handle);
+
+	return read_ctx_reg(regs, CTX_GPREG_X0);
+}
+
+static const rt_svc_fid_entry_t *fid_entry(uint32_t fid)
+{
+	return &rt_svc_fid_table[RT_SVC_FID_HASH(fid)];
+}
+
+/* The hash of the function id used by smc_handler64 */
+static unsigned int asm_hash(uint32_t fid)
+{
+	return (fid ^ (fid >> FUNCID_OEN_SHIFT) ^
+		(fid >> (FUNCID_CC_SHIFT - 4))) & (RT_SVC_FID_TABLE_SIZE - 1);
+}
+
+/* Leaf handlers are installed with their flags, unless they can't be */
+static void test_table(void)
+{
+	const rt_svc_fid_entry_t *entry;
+	unsigned int i, n = 0;
+
+	CHECK(RT_SVC_FID_HASH(FID_VERSION) == RT_SVC_FID_HASH(FID_COLLIDING),
+	      "the colliding function ids don't collide");
+
+	/* Only one of the colliding function ids gets the entry */
+	entry = fid_entry(FID_VERSION);
+	CHECK(((entry->smc_fid == FID_VERSION) &&
+	       (entry->handle == leaf_version)) ||
+	      ((entry->smc_fid == FID_COLLIDING) &&
+	       (entry->handle == leaf_colliding)),
+	      "FID_VERSION entry 0x%x %p", entry->smc_fid,
+	      (void *)entry->handle);
+	CHECK(entry->flags == 0, "FID_VERSION entry flags 0x%x", entry->flags);
+
+	entry = fid_entry(FID_FEATURES);
+	CHECK((entry->smc_fid == FID_FEATURES) &&
+	      (entry->handle == leaf_features) &&
+	      (entry->flags == RT_SVC_FID_FLAG_LIGHT),
+	      "FID_FEATURES entry 0x%x %p 0x%x", entry->smc_fid,
+	      (void *)entry->handle, entry->flags);
+
+	/* The service of this one failed to initialise */
+	entry = fid_entry(FID_SIP_QUERY);
+	CHECK(entry->handle == NULL, "leaf handler of the SiP service added");
+
+	for (i = 0; i < RT_SVC_FID_TABLE_SIZE; i++) {
+		entry = &rt_svc_fid_table[i];
+		if (entry->handle == NULL)
+			continue;
+		n++;
+		CHECK(RT_SVC_FID_HASH(entry->smc_fid) == i,
+		      "SMC 0x%x in entry %u", entry->smc_fid, i);
+		CHECK(asm_hash(entry->smc_fid) == i,
+		      "SMC 0x%x hashed to %u by the SMC handler",
+		      entry->smc_fid, asm_hash(entry->smc_fid));
+	}
+	CHECK(n == 2, "%u leaf handlers installed", n);
+}
+
+/* SMCs reach the right handler with their arguments, whatever the path */
+static void test_dispatch(void)
+{
+	static const struct {
+		uint32_t fid;
+		int handler;
+	} smcs[] = {
+		{ FID_VERSION, LEAF_VERSION },
+		{ FID_FEATURES, LEAF_FEATURES },
+		{ FID_COLLIDING, LEAF_COLLIDING },
+		{ FID_OTHER, STD_TOP },
+		{ STD_FID(0x3f), STD_TOP },
+	};
+	unsigned int i;
+	u_register_t x0;
+
+	for (i = 0; i < ARRAY_SIZE(smcs); i++) {
+		x0 = smc(smcs[i].fid);
+		CHECK(called == smcs[i].handler, "SMC 0x%x called %d",
+		      smcs[i].fid, called);
+		if (smcs[i].handler == STD_TOP)
+			continue;
+		CHECK(x0 == (smcs[i].fid ^ (smcs[i].fid + 1)),
+		      "SMC 0x%x returned 0x%lx", smcs[i].fid,
+		      (unsigned long)x0);
+		CHECK((args[0] == smcs[i].fid + 1) &&
+		      (args[1] == smcs[i].fid + 2) &&
+		      (args[2] == smcs[i].fid + 3) &&
+		      (args[3] == smcs[i].fid + 4),
+		      "SMC 0x%x arguments 0x%lx 0x%lx 0x%lx 0x%lx",
+		      smcs[i].fid, (unsigned long)args[0],
+		      (unsigned long)args[1], (unsigned long)args[2],
+		      (unsigned long)args[3]);
+	}
+
+	/* SMCs of a service which failed to initialise are unknown */
+	x0 = smc(FID_SIP_QUERY);
+	CHECK((called == NONE) && (x0 == SMC_UNK),
+	      "SiP SMC called %d and returned 0x%lx", called,
+	      (unsigned long)x0);
+}
+
+#define BENCH_ITER	10000000
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double bench(uint32_t fid)
+{
+	unsigned long iter;
+	double start;
+
+	start = now();
+	for (iter = 0; iter < BENCH_ITER; iter++)
+		handle_runtime_svc(fid, NULL, &ctx, SMC_FROM_NON_SECURE);
+	return (now() - start) * 1e9 / BENCH_ITER;
+}
+
+static void run_bench(void)
+{
+	double direct, top;
+
+	direct = bench(FID_FEATURES);
+	memset(rt_svc_fid_table, 0, sizeof(rt_svc_fid_table));
+	top = bench(FID_FEATURES);
+
+	printf("%-24s %10s\n", "dispatch", "ns");
+	printf("%-24s %10.2f\n", "function id table", direct);
+	printf("%-24s %10.2f\n", "top level handler", top);
+}
+
+int main(int argc, char *argv[])
+{
+	int do_bench = (argc > 1) && (strcmp(argv[1], "-b") == 0);
+
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	runtime_svc_init();
+
+	test_table();
+	test_dispatch();
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("runtime_svc: all tests passed\n");
+
+	if (do_bench)
+		run_bench();
+
+	return 0;
+}
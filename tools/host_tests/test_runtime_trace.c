@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the runtime trace rings of BL31 (lib/runtime_trace/runtime_trace.c
+ * with ENABLE_RUNTIME_TRACE=1), read back by the trace decoder
+ * (tools/trace_decode). Both sources are included so that the rings are
+ * written by the firmware and parsed by the decoder as in a dump of the trace
+ * region. The trace region is mapped at PLAT_RUNTIME_TRACE_BASE. The system
+ * counter, SCTLR_EL3 and the cpu on which the events occur are emulated.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <interrupt_mgmt.h>
+
+#include "../../lib/runtime_trace/runtime_trace.c"
+
+#define main trace_decode_main
+#include "../trace_decode/trace_decode.c"
+#undef main
+
+#define CNTFRQ			50000000
+
+#define STD_FID(n)		(0x84000000U | (n))
+
+/* Emulated cpu */
+static unsigned int cur_cpu;
+static uint64_t cntpct = 1000;
+static uint64_t sctlr_el3 = SCTLR_C_BIT;
+
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+uint64_t read_cntpct_el0(void)
+{
+	return cntpct;
+}
+
+uint64_t read_cntfrq_el0(void)
+{
+	return CNTFRQ;
+}
+
+uint64_t read_sctlr_el3(void)
+{
+	return sctlr_el3;
+}
+
+unsigned int plat_my_core_pos(void)
+{
+	return cur_cpu;
+}
+
+/* Events of the whole region as printed by the decoder, in timestamp order */
+static event_t *events;
+static size_t nr_events;
+
+static size_t decode(void)
+{
+	const unsigned char *region = (void *)PLAT_RUNTIME_TRACE_BASE;
+	size_t off, ring_size;
+	uint64_t cntfrq = 0;
+	unsigned int rings = 0;
+
+	free(events);
+	events = NULL;
+	nr_events = 0;
+
+	for (off = 0; off < PLAT_RUNTIME_TRACE_SIZE; off += ring_size) {
+		ring_size = parse_ring(region + off,
+				       PLAT_RUNTIME_TRACE_SIZE - off, &events,
+				       &nr_events, &cntfrq);
+		if (ring_size == 0)
+			break;
+		rings++;
+	}
+
+	if (rings != 0) {
+		CHECK(rings == PLATFORM_CORE_COUNT, "%u rings", rings);
+		CHECK(cntfrq == CNTFRQ, "counter frequency %llu",
+		      (unsigned long long)cntfrq);
+	}
+
+	qsort(events, nr_events, sizeof(event_t), cmp_events);
+	return rings;
+}
+
+static int event_is(const event_t *ev, unsigned int cpu, uint64_t ts,
+		    unsigned int event, unsigned int info, uint32_t data)
+{
+	return (ev->cpu == cpu) && (ev->timestamp == ts) &&
+	       (ev->event == event) && (ev->info == info) &&
+	       (ev->data == data);
+}
+
+/* Nothing is written to the region before it is initialised */
+static void test_before_init(void)
+{
+	const unsigned char *region = (void *)PLAT_RUNTIME_TRACE_BASE;
+	size_t i;
+
+	runtime_trace_event(RUNTIME_TRACE_PWR_UP, 0, 0);
+	for (i = 0; i < PLAT_RUNTIME_TRACE_SIZE; i++)
+		if (region[i] != 0)
+			break;
+	CHECK(i == PLAT_RUNTIME_TRACE_SIZE,
+	      "region written at offset %zu before the initialisation", i);
+}
+
+/* The events of all cpus are merged in a single timeline */
+static void test_timeline(void)
+{
+	unsigned int i, cpu;
+
+	runtime_trace_init();
+	CHECK(decode() == PLATFORM_CORE_COUNT, "rings not initialised");
+	CHECK(nr_events == 0, "%zu events after the initialisation",
+	      nr_events);
+
+	/* Events of the cpus in turn, in reverse cpu order */
+	for (i = 0; i < 3 * PLATFORM_CORE_COUNT; i++) {
+		cur_cpu = PLATFORM_CORE_COUNT - 1 - (i % PLATFORM_CORE_COUNT);
+		cntpct = 2000 + i;
+		runtime_trace_event(RUNTIME_TRACE_WORLD_SWITCH, i & 1, 0);
+	}
+
+	decode();
+	CHECK(nr_events == 3 * PLATFORM_CORE_COUNT, "%zu events", nr_events);
+	for (i = 0; i < nr_events; i++) {
+		cpu = PLATFORM_CORE_COUNT - 1 - (i % PLATFORM_CORE_COUNT);
+		CHECK(event_is(&events[i], cpu, 2000 + i,
+			       RUNTIME_TRACE_WORLD_SWITCH, i & 1, 0),
+		      "event %u: cpu %u time %llu event %u info %u", i,
+		      events[i].cpu, (unsigned long long)events[i].timestamp,
+		      events[i].event, events[i].info);
+	}
+}
+
+/*
+ * The entry of an SMC is recorded when its handler returns, with the time of
+ * its dispatch, after the events which occurred while it was handled.
+ */
+static void test_smc(void)
+{
+	runtime_trace_init();
+	cur_cpu = 3;
+
+	cntpct = 5000;
+	runtime_trace_intr(INTR_TYPE_EL3);
+	cntpct = 5100;
+	runtime_trace_smc(STD_FID(0x0a), 4900, SMC_FROM_NON_SECURE);
+	cntpct = 5200;
+	runtime_trace_smc(STD_FID(0x0b), 5150, SMC_FROM_SECURE);
+
+	decode();
+	CHECK(nr_events == 5, "%zu events", nr_events);
+	if (nr_events != 5)
+		return;
+
+	CHECK(event_is(&events[0], 3, 4900, RUNTIME_TRACE_SMC_ENTRY,
+		       NON_SECURE, STD_FID(0x0a)), "first SMC entry");
+	CHECK(event_is(&events[1], 3, 5000, RUNTIME_TRACE_INTR_ENTRY, 0,
+		       INTR_TYPE_EL3), "interrupt");
+	CHECK(event_is(&events[2], 3, 5100, RUNTIME_TRACE_SMC_EXIT, 0,
+		       STD_FID(0x0a)), "first SMC exit");
+	CHECK(event_is(&events[3], 3, 5150, RUNTIME_TRACE_SMC_ENTRY, SECURE,
+		       STD_FID(0x0b)), "second SMC entry");
+	CHECK(event_is(&events[4], 3, 5200, RUNTIME_TRACE_SMC_EXIT, 0,
+		       STD_FID(0x0b)), "second SMC exit");
+}
+
+/* Nothing is written with the data cache disabled */
+static void test_cache_disabled(void)
+{
+	runtime_trace_init();
+	cur_cpu = 7;
+
+	runtime_trace_event(RUNTIME_TRACE_PWR_DOWN, 1, 0x202);
+	sctlr_el3 &= ~SCTLR_C_BIT;
+	runtime_trace_event(RUNTIME_TRACE_PWR_DOWN, 1, 0x202);
+	runtime_trace_smc(STD_FID(0), 0, 0);
+	sctlr_el3 |= SCTLR_C_BIT;
+	runtime_trace_event(RUNTIME_TRACE_PWR_UP, 1, 0x202);
+
+	decode();
+	CHECK(nr_events == 2, "%zu events", nr_events);
+}
+
+/*
+ * Once a ring has wrapped, the decoder gets all the records except the oldest
+ * one, which may have been in the process of being overwritten.
+ */
+static void test_wrap(void)
+{
+	unsigned int i, n, total = 3 * RT_TRACE_NUM_RECS + 5;
+
+	runtime_trace_init();
+	cur_cpu = 1;
+
+	for (i = 0; i < total; i++) {
+		cntpct = 10000 + i;
+		runtime_trace_event(RUNTIME_TRACE_INTR_ENTRY, 0, i);
+	}
+
+	CHECK(get_ring(1)->head == total, "head %llu",
+	      (unsigned long long)get_ring(1)->head);
+
+	/* The decoder warns about the overwritten records */
+	decode();
+	n = RT_TRACE_NUM_RECS - 1;
+	CHECK(nr_events == n, "%zu events instead of %u", nr_events, n);
+	for (i = 0; i < MIN(nr_events, (size_t)n); i++)
+		CHECK(event_is(&events[i], 1, 10000 + total - n + i,
+			       RUNTIME_TRACE_INTR_ENTRY, 0, total - n + i),
+		      "event %u: data %u", i, events[i].data);
+}
+
+int main(void)
+{
+	void *region;
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	region = mmap((void *)PLAT_RUNTIME_TRACE_BASE, PLAT_RUNTIME_TRACE_SIZE,
+		      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+		      0);
+	if (region != (void *)PLAT_RUNTIME_TRACE_BASE) {
+		printf("Can't map the trace region at 0x%lx\n",
+		       (unsigned long)PLAT_RUNTIME_TRACE_BASE);
+		return 1;
+	}
+
+	test_before_init();
+	test_timeline();
+	test_smc();
+	test_cache_disabled();
+	test_wrap();
+
+	free(events);
+
+	if (failures) {
+		printf("runtime_trace: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("runtime_trace: all tests passed\n");
+	return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests of the SMC latency histograms of BL31 (bl31/smc_latency.c with
+ * ENABLE_SMC_LATENCY_HIST=1). The source is included so that the histograms
+ * are read through its PMF handler. The system counter and the cpu on which the
+ * SMCs are handled are emulated.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../../bl31/smc_latency.c"
+
+#define FAST_FID(oen, n)	(0x80000000U | ((oen) << 24) | (n))
+#define STD_FID(n)		FAST_FID(OEN_STD_START, (n))
+#define SIP_FID(n)		FAST_FID(OEN_SIP_START, (n))
+#define TOS_FID(n)		FAST_FID(OEN_TOS_START, (n))
+#define TOS2_FID(n)		FAST_FID(OEN_TOS_START + 1, (n))
+#define OEM_FID(n)		FAST_FID(OEN_OEM_START, (n))
+
+/* Descriptor indices of the services which have a histogram */
+#define STD_IDX			0
+#define SIP_IDX			1
+#define TOS_IDX			(SMC_LAT_MAX_SVCS - 1)
+
+#define MPIDR(cpu)		((((cpu) / PLATFORM_CORES_PER_CLUSTER) << 8) | \
+				 ((cpu) % PLATFORM_CORES_PER_CLUSTER))
+#define TID(fid, bucket)	(get_unique_oen_from_smc_fid(fid) |	\
+				 ((bucket) << SMC_LAT_TID_BUCKET_SHIFT))
+
+uint8_t rt_svc_descs_indices[MAX_RT_SVCS];
+
+/* Emulated cpu */
+static unsigned int cur_cpu;
+static uint64_t cntpct;
+
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+uint64_t read_cntpct_el0(void)
+{
+	return cntpct;
+}
+
+unsigned int plat_my_core_pos(void)
+{
+	return cur_cpu;
+}
+
+int plat_core_pos_by_mpidr(u_register_t mpidr)
+{
+	unsigned int cluster = (mpidr >> 8) & 0xff;
+	unsigned int core = mpidr & 0xff;
+
+	if ((mpidr & ~0xffffULL) || (cluster >= PLATFORM_CLUSTER_COUNT) ||
+	    (core >= PLATFORM_CORES_PER_CLUSTER))
+		return -1;
+
+	return cluster * PLATFORM_CORES_PER_CLUSTER + core;
+}
+
+/*
+ * Services as indexed by runtime_svc_init(), the two Trusted OS OENs sharing a
+ * descriptor
+ */
+static void init_services(void)
+{
+	memset(rt_svc_descs_indices, -1, sizeof(rt_svc_descs_indices));
+	rt_svc_descs_indices[get_unique_oen_from_smc_fid(STD_FID(0))] = STD_IDX;
+	rt_svc_descs_indices[get_unique_oen_from_smc_fid(SIP_FID(0))] = SIP_IDX;
+	rt_svc_descs_indices[get_unique_oen_from_smc_fid(TOS_FID(0))] = TOS_IDX;
+	rt_svc_descs_indices[get_unique_oen_from_smc_fid(TOS2_FID(0))] = TOS_IDX;
+	rt_svc_descs_indices[get_unique_oen_from_smc_fid(OEM_FID(0))] =
+		SMC_LAT_MAX_SVCS;
+
+	memset(smc_lat_hist, 0, sizeof(smc_lat_hist));
+}
+
+/* Handle an SMC taking `ticks` on the cpu `cpu` */
+static void smc(unsigned int cpu, uint32_t fid, uint64_t ticks)
+{
+	uint64_t start = 0x123456789ULL * (cpu + 1);
+
+	cur_cpu = cpu;
+	cntpct = start + ticks;
+	smc_latency_record(fid, start);
+}
+
+static unsigned long long count(unsigned int cpu, uint32_t fid,
+				unsigned int bucket)
+{
+	return smc_latency_get(TID(fid, bucket), MPIDR(cpu), 0);
+}
+
+/* Bucket n holds the latencies in [2^n, 2^(n+1)), the last one all above */
+static void test_buckets(void)
+{
+	static const struct {
+		uint64_t ticks;
+		unsigned int bucket;
+	} cases[] = {
+		{ 0, 0 }, { 1, 0 }, { 2, 1 }, { 3, 1 }, { 4, 2 }, { 1000, 9 },
+		{ 1023, 9 }, { 1024, 10 },
+		{ (1ULL << (SMC_LAT_NUM_BUCKETS - 1)) - 1,
+		  SMC_LAT_NUM_BUCKETS - 2 },
+		{ 1ULL << (SMC_LAT_NUM_BUCKETS - 1), SMC_LAT_NUM_BUCKETS - 1 },
+		{ 1ULL << 40, SMC_LAT_NUM_BUCKETS - 1 },
+		{ ~0ULL, SMC_LAT_NUM_BUCKETS - 1 },
+	};
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(cases); i++) {
+		init_services();
+		smc(5, STD_FID(1), cases[i].ticks);
+		CHECK(count(5, STD_FID(1), cases[i].bucket) == 1,
+		      "%llu ticks not in bucket %u",
+		      (unsigned long long)cases[i].ticks, cases[i].bucket);
+	}
+}
+
+/*
+ * Each cpu counts the SMCs it handles, per service. The OENs of a service share
+ * its histogram and SMCs of services without one are not counted.
+ */
+static void test_record(void)
+{
+	unsigned int cpu, bucket;
+	unsigned long long total;
+
+	init_services();
+
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		smc(cpu, STD_FID(0), 100);
+		smc(cpu, STD_FID(3), 100 + cpu);
+		smc(cpu, SIP_FID(1), 1 << (cpu % SMC_LAT_NUM_BUCKETS));
+		smc(cpu, TOS_FID(2), 10);
+		smc(cpu, TOS2_FID(2), 10);
+		smc(cpu, OEM_FID(0), 10);
+	}
+
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		CHECK(count(cpu, STD_FID(0), 6) == 2,
+		      "cpu %u: %llu std SMCs in bucket 6", cpu,
+		      count(cpu, STD_FID(0), 6));
+		CHECK(count(cpu, SIP_FID(0), cpu % SMC_LAT_NUM_BUCKETS) == 1,
+		      "cpu %u: SiP SMC not in bucket %u", cpu,
+		      cpu % SMC_LAT_NUM_BUCKETS);
+		CHECK(count(cpu, TOS_FID(0), 3) == 2,
+		      "cpu %u: %llu Trusted OS SMCs", cpu,
+		      count(cpu, TOS_FID(0), 3));
+		CHECK(count(cpu, TOS2_FID(0), 3) == 2,
+		      "cpu %u: %llu Trusted OS SMCs through the second OEN",
+		      cpu, count(cpu, TOS2_FID(0), 3));
+
+		total = 0;
+		for (bucket = 0; bucket < SMC_LAT_NUM_BUCKETS; bucket++)
+			total += count(cpu, STD_FID(0), bucket);
+		CHECK(total == 2, "cpu %u: %llu std SMCs", cpu, total);
+
+		total = 0;
+		for (bucket = 0; bucket < SMC_LAT_NUM_BUCKETS; bucket++)
+			total += count(cpu, OEM_FID(0), bucket);
+		CHECK(total == 0, "cpu %u: %llu SMCs of a service without a "
+		      "histogram", cpu, total);
+	}
+}
+
+/* Timestamp ids and MPIDRs given by the caller are checked */
+static void test_bad_ids(void)
+{
+	init_services();
+	smc(2, STD_FID(0), 1);
+	CHECK(count(2, STD_FID(0), 0) == 1, "SMC not counted");
+	/* Counted right after the last bucket of the Standard service */
+	smc(2, SIP_FID(0), 1);
+
+	CHECK(smc_latency_get(TID(STD_FID(0), SMC_LAT_NUM_BUCKETS), MPIDR(2),
+			      0) == 0, "bucket out of range");
+	CHECK(smc_latency_get(TID(STD_FID(0), 0xff), MPIDR(2), 0) == 0,
+	      "bucket 0xff");
+	CHECK(smc_latency_get(MAX_RT_SVCS, MPIDR(2), 0) == 0,
+	      "unique OEN out of range");
+	CHECK(smc_latency_get(PMF_TID_MASK, MPIDR(2), 0) == 0,
+	      "unique OEN 0xff");
+	CHECK(smc_latency_get(TID(STD_FID(0), 0), 0x10002, 0) == 0,
+	      "MPIDR of no cpu");
+	CHECK(smc_latency_get(TID(STD_FID(0), 0), MPIDR(2) | (1ULL << 32),
+			      0) == 0, "MPIDR with Aff3 set");
+	CHECK(smc_latency_get(TID(STD_FID(0), 0), MPIDR(2), PMF_CACHE_MAINT)
+	      == 1, "PMF_CACHE_MAINT flag not ignored");
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	test_buckets();
+	test_record();
+	test_bad_ids();
+
+	if (failures) {
+		printf("smc_latency: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("smc_latency: all tests passed\n");
+	return 0;
+}
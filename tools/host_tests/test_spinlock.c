@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests and contention benchmark of the AArch64 spinlocks
+ * (lib/locks/exclusive/aarch64/spinlock.S), which are built twice with their
+ * symbols renamed: tas_spin_lock() and tas_spin_unlock() without
+ * USE_TICKET_SPINLOCKS, ticket_spin_lock() and ticket_spin_unlock() with it.
+ *
+ *   test_spinlock [-b]
+ *
+ * With -b, the number of threads contending for a lock is increased up to the
+ * number of host cpus. For each lock and number of threads, the acquisitions
+ * per second, the median and 99th percentile of the time taken to acquire the
+ * lock, and the fewest and most acquisitions made by a thread are reported.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <spinlock.h>
+
+void tas_spin_lock(spinlock_t *lock);
+void tas_spin_unlock(spinlock_t *lock);
+void ticket_spin_lock(spinlock_t *lock);
+void ticket_spin_unlock(spinlock_t *lock);
+
+#define MAX_THREADS	64
+#define TEST_THREADS	4
+#define TEST_ITER	200000
+
+/* Acquisition time histogram, in buckets of 2^n ns */
+#define LAT_BUCKETS	32
+#define BENCH_NS	500000000LL
+
+typedef struct lock_impl {
+	const char *name;
+	void (*lock)(spinlock_t *lock);
+	void (*unlock)(spinlock_t *lock);
+} lock_impl_t;
+
+static const lock_impl_t impls[] = {
+	{ "test and set", tas_spin_lock, tas_spin_unlock },
+	{ "ticket", ticket_spin_lock, ticket_spin_unlock },
+};
+
+typedef struct thread_args {
+	pthread_t thread;
+	const lock_impl_t *impl;
+	unsigned long acquired;
+	unsigned long lat[LAT_BUCKETS];
+} thread_args_t;
+
+static spinlock_t lock;
+static volatile unsigned long counter;
+static volatile int owners;
+static volatile int start, stop;
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			__atomic_add_fetch(&failures, 1,		\
+					   __ATOMIC_RELAXED);		\
+		}							\
+	} while (0)
+
+static long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* An uncontended lock is taken and released as the lock word says */
+static void test_lock_word(void)
+{
+	unsigned int i;
+
+	lock.lock = 0;
+	tas_spin_lock(&lock);
+	CHECK(lock.lock != 0, "test and set lock free when held");
+	tas_spin_unlock(&lock);
+	CHECK(lock.lock == 0, "test and set lock 0x%x when free", lock.lock);
+
+	/* The tickets wrap around without the lock being seen as held */
+	lock.lock = 0xfffefffe;
+	for (i = 0; i < 4; i++) {
+		ticket_spin_lock(&lock);
+		CHECK((lock.lock >> 16) == ((lock.lock + 1) & 0xffff),
+		      "ticket lock 0x%x when held", lock.lock);
+		ticket_spin_unlock(&lock);
+		CHECK((lock.lock >> 16) == (lock.lock & 0xffff),
+		      "ticket lock 0x%x when free", lock.lock);
+	}
+	CHECK(lock.lock == 0x00020002, "ticket lock 0x%x after 4 acquisitions",
+	      lock.lock);
+}
+
+static void *exclusion_thread(void *arg)
+{
+	thread_args_t *args = arg;
+	unsigned int i;
+
+	while (!start)
+		;
+
+	for (i = 0; i < TEST_ITER; i++) {
+		args->impl->lock(&lock);
+		CHECK(++owners == 1, "%s: %d owners", args->impl->name, owners);
+		counter++;
+		owners--;
+		args->impl->unlock(&lock);
+	}
+
+	return NULL;
+}
+
+/* Threads incrementing a counter under the lock don't lose any increment */
+static void test_exclusion(const lock_impl_t *impl)
+{
+	thread_args_t args[TEST_THREADS];
+	unsigned int i;
+
+	lock.lock = 0;
+	counter = 0;
+	start = 0;
+	for (i = 0; i < TEST_THREADS; i++) {
+		args[i].impl = impl;
+		if (pthread_create(&args[i].thread, NULL, exclusion_thread,
+				   &args[i]) != 0) {
+			CHECK(0, "cannot create thread %u", i);
+			return;
+		}
+	}
+	start = 1;
+	for (i = 0; i < TEST_THREADS; i++)
+		pthread_join(args[i].thread, NULL);
+
+	CHECK(counter == (unsigned long)TEST_THREADS * TEST_ITER,
+	      "%s: counter %lu instead of %lu", impl->name, counter,
+	      (unsigned long)TEST_THREADS * TEST_ITER);
+}
+
+static void *bench_thread(void *arg)
+{
+	thread_args_t *args = arg;
+	long long t0, t1;
+	unsigned int b;
+
+	while (!start)
+		;
+
+	while (!stop) {
+		t0 = now_ns();
+		args->impl->lock(&lock);
+		t1 = now_ns();
+		/* A short critical section, as most of the firmware ones */
+		counter++;
+		args->impl->unlock(&lock);
+
+		for (b = 0; (b < LAT_BUCKETS - 1) && ((t1 - t0) >> b) > 1; b++)
+			;
+		args->lat[b]++;
+		args->acquired++;
+	}
+
+	return NULL;
+}
+
+/* Upper bound, in ns, of the bucket which holds the given fraction */
+static unsigned long percentile(const unsigned long *lat, unsigned long total,
+				double fraction)
+{
+	unsigned long sum = 0;
+	unsigned int b;
+
+	for (b = 0; b < LAT_BUCKETS - 1; b++) {
+		sum += lat[b];
+		if (sum >= total * fraction)
+			break;
+	}
+	return 2UL << b;
+}
+
+static void bench(const lock_impl_t *impl, unsigned int nthreads)
+{
+	static thread_args_t args[MAX_THREADS];
+	unsigned long lat[LAT_BUCKETS] = { 0 }, total = 0, min = ~0UL, max = 0;
+	long long t0;
+	unsigned int i, b;
+
+	memset(args, 0, sizeof(args));
+	lock.lock = 0;
+	start = 0;
+	stop = 0;
+	for (i = 0; i < nthreads; i++) {
+		args[i].impl = impl;
+		if (pthread_create(&args[i].thread, NULL, bench_thread,
+				   &args[i]) != 0) {
+			printf("Cannot create thread %u\n", i);
+			nthreads = i;
+			break;
+		}
+	}
+
+	start = 1;
+	t0 = now_ns();
+	while (now_ns() - t0 < BENCH_NS)
+		usleep(10000);
+	stop = 1;
+
+	for (i = 0; i < nthreads; i++) {
+		pthread_join(args[i].thread, NULL);
+		total += args[i].acquired;
+		if (args[i].acquired < min)
+			min = args[i].acquired;
+		if (args[i].acquired > max)
+			max = args[i].acquired;
+		for (b = 0; b < LAT_BUCKETS; b++)
+			lat[b] += args[i].lat[b];
+	}
+	if (total == 0)
+		return;
+
+	printf("%-14s %7u %10.2f %10lu %10lu %10lu %10lu\n", impl->name,
+	       nthreads, total * 1e3 / (now_ns() - t0),
+	       percentile(lat, total, 0.5), percentile(lat, total, 0.99),
+	       min, max);
+}
+
+static void run_bench(void)
+{
+	long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int i, n;
+
+	if ((ncpus < 1) || (ncpus > MAX_THREADS))
+		ncpus = MAX_THREADS;
+
+	printf("%-14s %7s %10s %10s %10s %10s %10s\n", "lock", "threads",
+	       "Macq/s", "p50 ns", "p99 ns", "min acq", "max acq");
+	for (i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+		for (n = 1; n < ncpus; n *= 2)
+			bench(&impls[i], n);
+		bench(&impls[i], ncpus);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int do_bench = (argc > 1) && (strcmp(argv[1], "-b") == 0);
+	unsigned int i;
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	test_lock_word();
+	for (i = 0; i < sizeof(impls) / sizeof(impls[0]); i++)
+		test_exclusion(&impls[i]);
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("spinlock: all tests passed\n");
+
+	if (do_bench)
+		run_bench();
+
+	return 0;
+}
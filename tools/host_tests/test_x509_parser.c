@@ -0,0 +1,538 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Tests and benchmark of the X509v3 parser based on mbed TLS
+ * (drivers/auth/mbedtls/mbedtls_x509_parser.c). The certificates are created
+ * with OpenSSL in the shape of the ones of the certificate generation tool:
+ * an ECDSA signature and TBBR extensions holding hashes, keys or counters.
+ * Certificates with more than MAX_V3_EXTENSIONS extensions are also created,
+ * as well as more extension IDs than the parser keeps the encoding of.
+ * Certificates created by the tool can also be given on the command line:
+ *
+ *   test_x509_parser [-b] [cert.crt ...]
+ *
+ * With -b, the time taken by the integrity check and the lookup of all the
+ * extensions of each certificate is reported.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/evp.h>
+#include <openssl/objects.h>
+#include <openssl/x509.h>
+
+#include <cassert.h>
+#include <tbbr_oid.h>
+
+/* The parser is included so that its static functions can be tested */
+#include "../../drivers/auth/mbedtls/mbedtls_x509_parser.c"
+
+static const img_parser_lib_desc_t *parser = &__img_parser_lib_desc_IMG_CERT;
+
+/* Extensions of the created certificates */
+static const char *const ext_oids[] = {
+	TRUSTED_FW_NVCOUNTER_OID,
+	TRUSTED_BOOT_FW_HASH_OID,
+	TRUSTED_WORLD_PK_OID,
+	NON_TRUSTED_WORLD_PK_OID,
+	SOC_FW_CONTENT_CERT_PK_OID,
+	SOC_AP_FW_HASH_OID,
+	TRUSTED_OS_FW_HASH_OID,
+	TRUSTED_OS_FW_EXTRA1_HASH_OID,
+	TRUSTED_OS_FW_EXTRA2_HASH_OID,
+	NON_TRUSTED_WORLD_BOOTLOADER_HASH_OID,
+	SCP_FW_HASH_OID,
+	SCP_FW_CONTENT_CERT_PK_OID,
+	TRUSTED_OS_FW_CONTENT_CERT_PK_OID,
+	NON_TRUSTED_FW_CONTENT_CERT_PK_OID,
+	AP_FWU_CFG_HASH_OID,
+	SCP_FWU_CFG_HASH_OID,
+	FWU_HASH_OID,
+	PRIMARY_DEBUG_PK_OID,
+	SECONDARY_DEBUG_PK_OID,
+	APROM_PATCH_HASH_OID,
+	SOC_CONFIG_HASH_OID,
+};
+
+/* Extension IDs of the certificates given on the command line */
+#define MAX_FILE_OIDS		64
+static char file_oids[MAX_FILE_OIDS][128];
+static unsigned int num_file_oids;
+
+/* Extension which is never in the created certificates */
+#define MISSING_OID		NON_TRUSTED_FW_NVCOUNTER_OID
+
+#define NUM_EXT_OIDS		(sizeof(ext_oids) / sizeof(ext_oids[0]))
+
+CASSERT(NUM_EXT_OIDS > MAX_V3_EXTENSIONS + 1, assert_enough_ext_oids);
+
+typedef struct cert {
+	unsigned char *der;
+	unsigned int len;
+	X509 *x509;
+} cert_t;
+
+static EVP_PKEY *key;
+static unsigned int failures;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAIL: %s:%d: ", __func__, __LINE__);	\
+			printf(__VA_ARGS__);				\
+			putchar('\n');					\
+			failures++;					\
+		}							\
+	} while (0)
+
+static EVP_PKEY *make_key(void)
+{
+	EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+	EVP_PKEY *pkey = NULL;
+
+	if ((ctx == NULL) || (EVP_PKEY_keygen_init(ctx) <= 0) ||
+	    (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx,
+					NID_X9_62_prime256v1) <= 0) ||
+	    (EVP_PKEY_keygen(ctx, &pkey) <= 0))
+		pkey = NULL;
+
+	EVP_PKEY_CTX_free(ctx);
+	return pkey;
+}
+
+/*
+ * Add an extension with `len` bytes of contents. Odd extensions are critical,
+ * like the ones of the certificate generation tool.
+ */
+static int add_ext(X509 *x509, const char *oid, unsigned int n,
+		   unsigned int len)
+{
+	unsigned char data[128];
+	ASN1_OBJECT *obj = OBJ_txt2obj(oid, 1);
+	ASN1_OCTET_STRING *str = ASN1_OCTET_STRING_new();
+	X509_EXTENSION *ext = NULL;
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < len; i++)
+		data[i] = (unsigned char)(n * 31 + i);
+
+	if ((obj != NULL) && (str != NULL) &&
+	    ASN1_OCTET_STRING_set(str, data, len))
+		ext = X509_EXTENSION_create_by_OBJ(NULL, obj, n & 1, str);
+	if (ext != NULL)
+		ret = X509_add_ext(x509, ext, -1);
+
+	X509_EXTENSION_free(ext);
+	ASN1_OCTET_STRING_free(str);
+	ASN1_OBJECT_free(obj);
+	return ret;
+}
+
+/* Create a self-signed certificate with the first `num_ext` extensions */
+static int make_cert(cert_t *cert, unsigned int num_ext)
+{
+	X509 *x509 = X509_new();
+	X509_NAME *name;
+	unsigned int i;
+	int len;
+
+	if ((x509 == NULL) || !X509_set_version(x509, 2) ||
+	    !ASN1_INTEGER_set(X509_get_serialNumber(x509), 1) ||
+	    !X509_gmtime_adj(X509_getm_notBefore(x509), 0) ||
+	    !X509_gmtime_adj(X509_getm_notAfter(x509), 3600) ||
+	    !X509_set_pubkey(x509, key))
+		goto err;
+
+	name = X509_get_subject_name(x509);
+	if (!X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+					(const unsigned char *)"Test", -1,
+					-1, 0) ||
+	    !X509_set_issuer_name(x509, name))
+		goto err;
+
+	/* Hashes are 32 bytes, keys and counters are of other sizes */
+	for (i = 0; i < num_ext; i++)
+		if (!add_ext(x509, ext_oids[i], i, (i % 3) ? 32 : 91 - i))
+			goto err;
+
+	if (!X509_sign(x509, key, EVP_sha256()))
+		goto err;
+
+	cert->der = NULL;
+	len = i2d_X509(x509, &cert->der);
+	if (len <= 0)
+		goto err;
+	cert->len = (unsigned int)len;
+	cert->x509 = x509;
+	return 0;
+
+err:
+	X509_free(x509);
+	return -1;
+}
+
+static int load_cert(cert_t *cert, const char *path)
+{
+	const unsigned char *p;
+	FILE *f = fopen(path, "rb");
+	long len;
+
+	if (f == NULL)
+		return -1;
+
+	if ((fseek(f, 0, SEEK_END) != 0) || ((len = ftell(f)) <= 0) ||
+	    (fseek(f, 0, SEEK_SET) != 0) ||
+	    ((cert->der = malloc(len)) == NULL) ||
+	    (fread(cert->der, 1, len, f) != (size_t)len)) {
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+
+	cert->len = (unsigned int)len;
+	p = cert->der;
+	cert->x509 = d2i_X509(NULL, &p, len);
+	return (cert->x509 != NULL) ? 0 : -1;
+}
+
+static void free_cert(cert_t *cert)
+{
+	X509_free(cert->x509);
+	OPENSSL_free(cert->der);
+}
+
+/*
+ * The parser identifies the extension IDs by their address, as they are
+ * constant strings in the CoT. Return the constant string of an extension ID.
+ */
+static const char *get_oid(const ASN1_OBJECT *obj)
+{
+	char oid[128];
+	unsigned int i;
+
+	OBJ_obj2txt(oid, sizeof(oid), obj, 1);
+	for (i = 0; i < NUM_EXT_OIDS; i++)
+		if (strcmp(oid, ext_oids[i]) == 0)
+			return ext_oids[i];
+	for (i = 0; i < num_file_oids; i++)
+		if (strcmp(oid, file_oids[i]) == 0)
+			return file_oids[i];
+	if (num_file_oids == MAX_FILE_OIDS)
+		return NULL;
+	strcpy(file_oids[num_file_oids], oid);
+	return file_oids[num_file_oids++];
+}
+
+static int get_param(auth_param_type_t type, const char *oid, cert_t *cert,
+		     void **param, unsigned int *param_len)
+{
+	auth_param_type_desc_t desc = AUTH_PARAM_TYPE_DESC(type, oid);
+
+	return parser->get_auth_param(&desc, cert->der, cert->len, param,
+				      param_len);
+}
+
+/*
+ * Check the parameters found by the parser against the ones decoded by
+ * OpenSSL. Extensions are looked up in the reverse order of the certificate.
+ */
+static void check_params(cert_t *cert, const char *name)
+{
+	const char *oid;
+	const ASN1_OCTET_STRING *data;
+	X509_EXTENSION *ext;
+	unsigned char *der = NULL;
+	unsigned int param_len;
+	void *param;
+	int i, rc, len;
+
+	rc = get_param(AUTH_PARAM_RAW_DATA, NULL, cert, &param, &param_len);
+	len = i2d_re_X509_tbs(cert->x509, &der);
+	CHECK((rc == IMG_PARSER_OK) && (len == (int)param_len) &&
+	      (memcmp(param, der, len) == 0), "%s: wrong TBS", name);
+	OPENSSL_free(der);
+
+	der = NULL;
+	rc = get_param(AUTH_PARAM_PUB_KEY, NULL, cert, &param, &param_len);
+	len = i2d_PUBKEY(X509_get0_pubkey(cert->x509), &der);
+	CHECK((rc == IMG_PARSER_OK) && (len == (int)param_len) &&
+	      (memcmp(param, der, len) == 0), "%s: wrong subject key", name);
+	OPENSSL_free(der);
+
+	/* The signature bit string ends the certificate */
+	rc = get_param(AUTH_PARAM_SIG, NULL, cert, &param, &param_len);
+	CHECK((rc == IMG_PARSER_OK) &&
+	      ((unsigned char *)param + param_len == cert->der + cert->len),
+	      "%s: wrong signature", name);
+
+	for (i = X509_get_ext_count(cert->x509) - 1; i >= 0; i--) {
+		ext = X509_get_ext(cert->x509, i);
+		data = X509_EXTENSION_get_data(ext);
+		oid = get_oid(X509_EXTENSION_get_object(ext));
+		if (oid == NULL) {
+			CHECK(0, "%s: too many extension IDs", name);
+			return;
+		}
+
+		rc = get_param(AUTH_PARAM_HASH, oid, cert, &param, &param_len);
+		CHECK((rc == IMG_PARSER_OK) &&
+		      ((int)param_len == ASN1_STRING_length(data)) &&
+		      (memcmp(param, ASN1_STRING_get0_data(data),
+			      param_len) == 0),
+		      "%s: wrong extension %s", name, oid);
+	}
+}
+
+/*
+ * Certificates with 1 to NUM_EXT_OIDS - 1 extensions. The ones beyond
+ * MAX_V3_EXTENSIONS are not indexed, but are found as well.
+ */
+static void test_ext_lookup(void)
+{
+	unsigned int num_ext, param_len;
+	cert_t cert;
+	char name[32];
+	void *param;
+	int rc;
+
+	for (num_ext = 1; num_ext < NUM_EXT_OIDS; num_ext++) {
+		if (make_cert(&cert, num_ext) != 0) {
+			CHECK(0, "cannot create a certificate");
+			return;
+		}
+		snprintf(name, sizeof(name), "%u extensions", num_ext);
+
+		rc = parser->check_integrity(cert.der, cert.len);
+		CHECK(rc == IMG_PARSER_OK, "%s: integrity check returned %d",
+		      name, rc);
+		CHECK(v3_ext_num ==
+		      MIN(num_ext, (unsigned int)MAX_V3_EXTENSIONS),
+		      "%s: %u extensions indexed", name, v3_ext_num);
+		CHECK((v3_ext_more != NULL) == (num_ext > MAX_V3_EXTENSIONS),
+		      "%s: wrong start of the extensions not indexed", name);
+		check_params(&cert, name);
+
+		rc = get_param(AUTH_PARAM_HASH, MISSING_OID, &cert, &param,
+			       &param_len);
+		CHECK(rc == IMG_PARSER_ERR_NOT_FOUND,
+		      "%s: missing extension returned %d", name, rc);
+		rc = get_param(AUTH_PARAM_HASH, ext_oids[num_ext], &cert,
+			       &param, &param_len);
+		CHECK(rc == IMG_PARSER_ERR_NOT_FOUND,
+		      "%s: next extension returned %d", name, rc);
+
+		free_cert(&cert);
+	}
+}
+
+/*
+ * Truncated certificates are rejected, and nothing is found in them afterwards,
+ * neither in the extension index nor after it.
+ */
+static void test_bad_certs(void)
+{
+	unsigned int len, param_len;
+	cert_t cert;
+	void *param;
+	int rc;
+
+	if (make_cert(&cert, MAX_V3_EXTENSIONS + 1) != 0) {
+		CHECK(0, "cannot create a certificate");
+		return;
+	}
+
+	for (len = 0; len < cert.len; len++) {
+		rc = parser->check_integrity(cert.der, len);
+		CHECK(rc != IMG_PARSER_OK, "truncated to %u bytes: accepted",
+		      len);
+		rc = get_param(AUTH_PARAM_HASH, ext_oids[0], &cert, &param,
+			       &param_len);
+		CHECK(rc == IMG_PARSER_ERR_NOT_FOUND,
+		      "truncated to %u bytes: lookup returned %d", len, rc);
+		rc = get_param(AUTH_PARAM_HASH, ext_oids[MAX_V3_EXTENSIONS],
+			       &cert, &param, &param_len);
+		CHECK(rc == IMG_PARSER_ERR_NOT_FOUND,
+		      "truncated to %u bytes: lookup after the index "
+		      "returned %d", len, rc);
+	}
+
+	/* The index is built again for the next good certificate */
+	rc = parser->check_integrity(cert.der, cert.len);
+	CHECK(rc == IMG_PARSER_OK, "integrity check returned %d", rc);
+	check_params(&cert, "after bad certificates");
+
+	free_cert(&cert);
+}
+
+/* The OID encoding matches the one of OpenSSL and rejects invalid strings */
+static void test_oid_der(void)
+{
+	static const char *const good[] = {
+		TRUSTED_FW_NVCOUNTER_OID,
+		TRUSTED_OS_FW_EXTRA2_HASH_OID,
+		"0.0", "0.39", "1.39.1", "2.5.29.19", "2.999.3", "2.47",
+		"2.48", "1.2.840.113549.1.1.11", "1.2.127.128.16383.16384",
+		"1.3.6.1.4.1.4294967295", "2.4294967215",
+	};
+	static const char *const bad[] = {
+		"", "1", "1.", ".1", "1..2", "1.2.", "3.1", "1.40", "0.40",
+		"1.2.a", "1.2 ", "-1.2", "1.2.4294967296", "1.2.42949672950",
+		"2.4294967216",
+		/* More than MAX_OID_DER_LEN bytes */
+		"1.2.3.4.5.6.7.8.9.10.11.12.13.14.15.16.17.18.19.20.21.22."
+		"23.24.25.26.27.28.29.30.31.32.33.34.35.36.37.38.39.40",
+	};
+	unsigned char der[MAX_OID_DER_LEN];
+	ASN1_OBJECT *obj;
+	size_t der_len;
+	unsigned int i;
+	int rc;
+
+	for (i = 0; i < sizeof(good) / sizeof(good[0]); i++) {
+		rc = oid_str_to_der(good[i], der, &der_len);
+		obj = OBJ_txt2obj(good[i], 1);
+		CHECK((obj != NULL) && (rc == IMG_PARSER_OK) &&
+		      (der_len == OBJ_length(obj)) &&
+		      (memcmp(der, OBJ_get0_data(obj), der_len) == 0),
+		      "wrong encoding of %s", good[i]);
+		ASN1_OBJECT_free(obj);
+	}
+
+	for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+		rc = oid_str_to_der(bad[i], der, &der_len);
+		CHECK(rc == IMG_PARSER_ERR, "\"%s\" accepted", bad[i]);
+	}
+}
+
+static void test_cert_files(cert_t *certs, int num)
+{
+	int i, rc;
+
+	for (i = 0; i < num; i++) {
+		rc = parser->check_integrity(certs[i].der, certs[i].len);
+		CHECK(rc == IMG_PARSER_OK, "certificate %d: integrity check "
+		      "returned %d", i, rc);
+		if (rc == IMG_PARSER_OK)
+			check_params(&certs[i], "certificate file");
+	}
+}
+
+/*
+ * Time taken, in ns, by the integrity check and the lookup of all the
+ * extensions of a certificate, as done when a certificate is authenticated.
+ */
+#define BENCH_ITER	200000
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double bench(cert_t *cert)
+{
+	const char *oids[MAX_FILE_OIDS];
+	unsigned int i, num_ext, param_len;
+	unsigned long iter;
+	void *param;
+	double start;
+
+	num_ext = X509_get_ext_count(cert->x509);
+	if (num_ext > MAX_FILE_OIDS)
+		return 0;
+	for (i = 0; i < num_ext; i++) {
+		oids[i] = get_oid(X509_EXTENSION_get_object(
+					X509_get_ext(cert->x509, i)));
+		if (oids[i] == NULL)
+			return 0;
+	}
+
+	start = now();
+	for (iter = 0; iter < BENCH_ITER; iter++) {
+		parser->check_integrity(cert->der, cert->len);
+		for (i = 0; i < num_ext; i++)
+			get_param(AUTH_PARAM_HASH, oids[i], cert, &param,
+				  &param_len);
+	}
+	return (now() - start) * 1e9 / BENCH_ITER;
+}
+
+static void run_bench(cert_t *files, int num_files)
+{
+	unsigned int num_ext;
+	cert_t cert;
+	int i;
+
+	printf("%-24s %6s %10s\n", "certificate", "exts", "ns");
+	for (num_ext = 1; num_ext <= NUM_EXT_OIDS; num_ext++) {
+		if (make_cert(&cert, num_ext) != 0)
+			return;
+		printf("%-24s %6u %10.0f\n", "generated", num_ext,
+		       bench(&cert));
+		free_cert(&cert);
+	}
+	for (i = 0; i < num_files; i++)
+		printf("%-24d %6d %10.0f\n", i,
+		       X509_get_ext_count(files[i].x509), bench(&files[i]));
+}
+
+int main(int argc, char *argv[])
+{
+	cert_t *files;
+	int i, num_files = 0, do_bench = 0;
+
+	/* Keep the output of the tests if a firmware assertion fails */
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+		do_bench = 1;
+		argc--;
+		argv++;
+	}
+
+	files = calloc(argc, sizeof(*files));
+	for (i = 1; i < argc; i++) {
+		if (load_cert(&files[num_files], argv[i]) != 0) {
+			printf("Cannot read the certificate %s\n", argv[i]);
+			return 1;
+		}
+		num_files++;
+	}
+
+	key = make_key();
+	if (key == NULL) {
+		printf("Cannot create the key\n");
+		return 1;
+	}
+	parser->init();
+
+	test_ext_lookup();
+	test_bad_certs();
+	test_oid_der();
+	test_cert_files(files, num_files);
+
+	if (failures != 0) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("x509_parser: all tests passed\n");
+
+	if (do_bench)
+		run_bench(files, num_files);
+
+	for (i = 0; i < num_files; i++)
+		free_cert(&files[i]);
+	free(files);
+	EVP_PKEY_free(key);
+	return 0;
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Decoder for dumps of the BL31 runtime trace region (ENABLE_RUNTIME_TRACE).
+ * It extracts the valid records of every per-cpu ring and prints them as a
+ * single timeline sorted by timestamp.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <runtime_trace_format.h>
+
+#define MAX_CPUS	256
+
+typedef struct event {
+	uint64_t timestamp;
+	uint64_t seq;
+	uint32_t cpu;
+	uint32_t data;
+	uint16_t event;
+	uint16_t info;
+} event_t;
+
+static void log_errx(const char *msg, ...)
+{
+	va_list ap;
+
+	va_start(ap, msg);
+	fprintf(stderr, "ERROR: ");
+	vfprintf(stderr, msg, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+	exit(1);
+}
+
+static void log_warnx(const char *msg, ...)
+{
+	va_list ap;
+
+	va_start(ap, msg);
+	fprintf(stderr, "WARN: ");
+	vfprintf(stderr, msg, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+}
+
+/* The trace region is little endian regardless of the host */
+static uint64_t get_le(const unsigned char *p, unsigned int size)
+{
+	uint64_t val = 0;
+
+	while (size-- > 0)
+		val = (val << 8) | p[size];
+	return val;
+}
+
+#define HDR_FIELD(p, f)	get_le((p) + offsetof(runtime_trace_hdr_t, f), \
+			       sizeof(((runtime_trace_hdr_t *)0)->f))
+#define REC_FIELD(p, f)	get_le((p) + offsetof(runtime_trace_rec_t, f), \
+			       sizeof(((runtime_trace_rec_t *)0)->f))
+
+static unsigned char *read_file(const char *filename, size_t *size)
+{
+	unsigned char *buf;
+	FILE *fp;
+	long len;
+
+	fp = fopen(filename, "rb");
+	if (fp == NULL)
+		log_errx("fopen %s: %s", filename, strerror(errno));
+
+	if ((fseek(fp, 0, SEEK_END) != 0) || ((len = ftell(fp)) < 0) ||
+	    (fseek(fp, 0, SEEK_SET) != 0))
+		log_errx("Failed to get the size of %s", filename);
+
+	buf = malloc(len ? len : 1);
+	if (buf == NULL)
+		log_errx("malloc: %s", filename);
+
+	if (fread(buf, 1, len, fp) != (size_t)len)
+		log_errx("Failed to read %s", filename);
+
+	fclose(fp);
+	*size = len;
+	return buf;
+}
+
+static int cmp_events(const void *a, const void *b)
+{
+	const event_t *ea = a, *eb = b;
+
+	if (ea->timestamp != eb->timestamp)
+		return (ea->timestamp < eb->timestamp) ? -1 : 1;
+	if (ea->cpu != eb->cpu)
+		return (ea->cpu < eb->cpu) ? -1 : 1;
+	if (ea->seq != eb->seq)
+		return (ea->seq < eb->seq) ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Append the valid records of the ring at `ring` to `*events`. Return the size
+ * of the ring or 0 if there is no valid ring at this address.
+ */
+static size_t parse_ring(const unsigned char *ring, size_t avail,
+			 event_t **events, size_t *nr_events, uint64_t *cntfrq)
+{
+	uint64_t ring_size, num_recs, head, seq, first;
+	const unsigned char *rec;
+	event_t *ev;
+
+	if (avail < RUNTIME_TRACE_RECS_OFFSET)
+		return 0;
+	if (HDR_FIELD(ring, magic) != RUNTIME_TRACE_MAGIC)
+		return 0;
+
+	if (HDR_FIELD(ring, version) != RUNTIME_TRACE_VERSION)
+		log_errx("Unsupported trace version %u",
+			 (unsigned int)HDR_FIELD(ring, version));
+	if (HDR_FIELD(ring, rec_size) != sizeof(runtime_trace_rec_t))
+		log_errx("Unexpected record size %u",
+			 (unsigned int)HDR_FIELD(ring, rec_size));
+
+	ring_size = HDR_FIELD(ring, ring_size);
+	num_recs = HDR_FIELD(ring, num_recs);
+	if ((ring_size > avail) || (num_recs == 0) ||
+	    (num_recs > (ring_size - RUNTIME_TRACE_RECS_OFFSET) /
+			sizeof(runtime_trace_rec_t)))
+		log_errx("Ring of cpu %u is truncated or corrupted",
+			 (unsigned int)HDR_FIELD(ring, cpu));
+
+	*cntfrq = HDR_FIELD(ring, cntfrq);
+	head = HDR_FIELD(ring, head);
+
+	/*
+	 * The slot of the oldest record may have been in the process of being
+	 * overwritten when the region was dumped, so skip it once the ring has
+	 * wrapped.
+	 */
+	first = (head >= num_recs) ? head + 1 - num_recs : 0;
+	if (head - first > 0) {
+		*events = realloc(*events,
+				  (*nr_events + (head - first)) * sizeof(event_t));
+		if (*events == NULL)
+			log_errx("realloc: events");
+	}
+
+	for (seq = first; seq < head; seq++) {
+		rec = ring + RUNTIME_TRACE_RECS_OFFSET +
+			(seq % num_recs) * sizeof(runtime_trace_rec_t);
+		ev = &(*events)[(*nr_events)++];
+		ev->timestamp = REC_FIELD(rec, timestamp);
+		ev->seq = seq;
+		ev->cpu = HDR_FIELD(ring, cpu);
+		ev->data = REC_FIELD(rec, data);
+		ev->event = REC_FIELD(rec, event);
+		ev->info = REC_FIELD(rec, info);
+	}
+
+	if (head > num_recs)
+		log_warnx("cpu %u: %" PRIu64 " older records were overwritten",
+			  (unsigned int)HDR_FIELD(ring, cpu), first);
+
+	return ring_size;
+}
+
+static const char *world_name(unsigned int security_state)
+{
+	return security_state ? "non-secure" : "secure";
+}
+
+static void print_pwr_states(uint32_t states, unsigned int end_pwrlvl)
+{
+	unsigned int lvl;
+
+	for (lvl = 0; (lvl <= end_pwrlvl) && (lvl < 4); lvl++)
+		printf(" L%u=%u", lvl, (states >> (lvl * 8)) & 0xff);
+}
+
+static double to_us(uint64_t ticks, uint64_t cntfrq)
+{
+	return (double)ticks * 1000000.0 / (double)cntfrq;
+}
+
+static void print_timeline(const event_t *events, size_t nr_events,
+			   uint64_t cntfrq)
+{
+	uint64_t smc_start[MAX_CPUS] = { 0 };
+	const event_t *ev;
+	size_t i;
+
+	if (nr_events == 0) {
+		printf("No events recorded\n");
+		return;
+	}
+
+	if (cntfrq != 0)
+		printf("%14s  %4s  %s\n", "time (us)", "cpu", "event");
+	else
+		printf("%14s  %4s  %s\n", "time (ticks)", "cpu", "event");
+
+	for (i = 0; i < nr_events; i++) {
+		ev = &events[i];
+
+		if (cntfrq != 0)
+			printf("%14.3f  %4u  ",
+			       to_us(ev->timestamp - events[0].timestamp,
+				     cntfrq), ev->cpu);
+		else
+			printf("%14" PRIu64 "  %4u  ",
+			       ev->timestamp - events[0].timestamp, ev->cpu);
+
+		switch (ev->event) {
+		case RUNTIME_TRACE_SMC_ENTRY:
+			printf("SMC entry     fid 0x%08x from %s",
+			       ev->data, world_name(ev->info));
+			if (ev->cpu < MAX_CPUS)
+				smc_start[ev->cpu] = ev->timestamp;
+			break;
+		case RUNTIME_TRACE_SMC_EXIT:
+			printf("SMC exit      fid 0x%08x", ev->data);
+			if ((ev->cpu < MAX_CPUS) && (smc_start[ev->cpu] != 0) &&
+			    (cntfrq != 0))
+				printf(" (%.3f us)",
+				       to_us(ev->timestamp - smc_start[ev->cpu],
+					     cntfrq));
+			break;
+		case RUNTIME_TRACE_INTR_ENTRY:
+			printf("interrupt     type %u", ev->data);
+			break;
+		case RUNTIME_TRACE_PWR_DOWN:
+			printf("power down    level %u", ev->info);
+			print_pwr_states(ev->data, ev->info);
+			break;
+		case RUNTIME_TRACE_PWR_UP:
+			printf("power up      level %u", ev->info);
+			print_pwr_states(ev->data, ev->info);
+			break;
+		case RUNTIME_TRACE_WORLD_SWITCH:
+			printf("world switch  to %s", world_name(ev->info));
+			break;
+		default:
+			printf("unknown event %u info 0x%x data 0x%08x",
+			       ev->event, ev->info, ev->data);
+			break;
+		}
+		putchar('\n');
+	}
+}
+
+static void usage(void)
+{
+	printf("trace_decode <dump>\n\n");
+	printf("Print the events recorded in a dump of the BL31 runtime trace "
+	       "region.\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char *buf;
+	size_t size, off, ring_size;
+	event_t *events = NULL;
+	size_t nr_events = 0;
+	uint64_t cntfrq = 0;
+
+	if (argc != 2)
+		usage();
+
+	buf = read_file(argv[1], &size);
+
+	for (off = 0; off < size; off += ring_size) {
+		ring_size = parse_ring(buf + off, size - off, &events,
+				       &nr_events, &cntfrq);
+		if (ring_size == 0)
+			break;
+	}
+
+	if (off == 0)
+		log_errx("%s is not a runtime trace dump", argv[1]);
+
+	qsort(events, nr_events, sizeof(event_t), cmp_events);
+	print_timeline(events, nr_events, cntfrq);
+
+	free(events);
+	free(buf);
+	return 0;
+}